@@ -0,0 +1,41 @@
+// Patterns measured by `strex_bench`.
+// Bump `corpus_version` whenever a pattern is added, removed or changed, results of different
+// versions are not comparable.
+
+#ifndef NEROLL_STREX_BENCH_CORPUS_HPP
+#define NEROLL_STREX_BENCH_CORPUS_HPP
+
+#include <string_view>
+
+namespace strex::bench {
+
+constexpr int corpus_version = 2;
+
+struct CorpusEntry {
+    std::string_view name;
+    std::string_view regex;
+};
+
+constexpr CorpusEntry corpus[] = {
+    {"ipv4", R"(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.){3}((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)))"},
+    {"uuid", R"([0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12})"},
+    {"email", R"([a-z0-9._%+-]{1,20}@[a-z0-9-]{1,15}(\.[a-z]{2,6}){1,2})"},
+    {"url",
+     R"(https?://(www\.)?[a-z0-9-]{2,20}\.(com|org|net|io)(/[a-z0-9_-]{1,12}){0,4})"
+     R"((\?[a-z]{1,8}=[a-z0-9]{1,8}(&[a-z]{1,8}=[a-z0-9]{1,8}){0,3})?)"},
+    {"log line",
+     R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}Z (INFO|WARN|ERROR|DEBUG) )"
+     R"(\[[a-z]{3,10}(-[0-9]{1,3})?\] [A-Za-z ]{10,60}( id=[0-9a-f]{16})?)"},
+    {"structured log",
+     R"((?:(\w{3,8})=("[a-z ]{0,12}"|\d{1,6}) ){4,8}caller=\1 value=\2)"},
+    {"nested alternation",
+     R"(((a|b)|(c|(d|e)))((f|g)|(h|(i|(j|k))))(((l|m)|n)|((o|p)|(q|(r|(s|t))))))"},
+    {"large repeat", R"([a-z]{500,1000})"},
+    {"large group repeat", R"((ab|cd|[0-9]{2}){100,200})"},
+    {"password", R"((?=.*\d)(?=.*[A-Z])[A-Za-z0-9]{8,16})"},
+    {"no double dash", R"(^(?!.*--)[a-z-]{5,20}$)"},
+};
+
+} // namespace strex::bench
+
+#endif
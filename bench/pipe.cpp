@@ -0,0 +1,103 @@
+// Measures output through a pipe: throughput of `OutputWriter` with `write(2)` against
+// `vmsplice(2)`, while a child process reads the other end, like `strex | consumer`.
+// Usage: strex_bench_pipe [MB per run]
+// Results are printed as JSON.
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <strex/OutputWriter.hpp>
+#include <strex/strex.hpp>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t default_megabytes = 4096;
+
+/// Strings written over and over, generated once so that only output is measured.
+constexpr auto sample_regex = "[a-z0-9]{16,48}";
+constexpr std::size_t sample_count = 4096;
+
+#if defined(__linux__)
+/// Reads the pipe until it is closed, in a child process, and exits.
+[[noreturn]] void drain(int fd) {
+    std::vector<char> buffer(strex::OutputWriter::default_buffer_size);
+    while (read(fd, buffer.data(), buffer.size()) > 0) {
+    }
+    _exit(0);
+}
+
+/// Returns bytes per second of writing `megabytes` MB of `lines` to a pipe in `mode`.
+double pipe_throughput(const std::string &lines, std::size_t megabytes,
+                       strex::OutputWriter::Mode mode) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        throw std::runtime_error("failed to create a pipe");
+    pid_t reader = fork();
+    if (reader < 0)
+        throw std::runtime_error("failed to start the reader");
+    if (reader == 0) {
+        close(fds[1]);
+        drain(fds[0]);
+    }
+    close(fds[0]);
+
+    std::size_t bytes = 0;
+    auto start = Clock::now();
+    {
+        strex::OutputWriter output(fds[1], mode);
+        while (bytes < megabytes << 20) {
+            output.write(lines);
+            bytes += lines.size();
+        }
+        output.flush();
+    }
+    close(fds[1]);
+    waitpid(reader, nullptr, 0);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(bytes) / seconds;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+#if defined(__linux__)
+    std::size_t megabytes = argc > 1 ? std::stoul(argv[1]) : default_megabytes;
+
+    try {
+        strex::ParsedRegex regex(sample_regex);
+        std::string lines;
+        for (const auto &generated : strex::from_regex(regex, sample_count))
+            lines.append(generated).push_back('\n');
+
+        double write_rate = pipe_throughput(lines, megabytes, strex::OutputWriter::Mode::Write);
+        double vmsplice_rate =
+            pipe_throughput(lines, megabytes, strex::OutputWriter::Mode::Vmsplice);
+        std::println("{{\"megabytes\": {}, \"write_bytes_per_sec\": {:.0f}, "
+                     "\"vmsplice_bytes_per_sec\": {:.0f}, \"speedup\": {:.2f}}}",
+                     megabytes, write_rate, vmsplice_rate, vmsplice_rate / write_rate);
+    }
+    catch (std::exception &e) {
+        std::println(stderr, "{}", e.what());
+        return 1;
+    }
+    return 0;
+#else
+    (void)argc;
+    (void)argv;
+    std::println(stderr, "vmsplice is only supported on Linux");
+    return 1;
+#endif
+}
\ No newline at end of file
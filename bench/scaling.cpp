@@ -0,0 +1,188 @@
+// Measures how `Lexer` and `Parser` scale with the size of synthetic patterns.
+// Usage: strex_bench_scaling [min size in bytes] [max size in bytes]
+// Default sizes are 64 KB to 10 MB, doubled each step, and the max size is always measured.
+//
+// Each pattern grows along one axis. The scaling exponent of time and memory is fitted on a
+// log-log scale, a pattern whose exponent exceeds `super_linear_exponent` is flagged, and the
+// program exits with 2 if any pattern is flagged.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <strex/Lexer.hpp>
+#include <strex/Parser.hpp>
+
+// Bytes in use and the peak since the last reset, the benchmark is single-threaded.
+static std::size_t live_bytes = 0;
+static std::size_t peak_bytes = 0;
+
+// Every block starts with its size, so `operator delete` knows how many bytes are released.
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+void *operator new(std::size_t size) {
+    auto *block = static_cast<char *>(std::malloc(size + header_size));
+    if (block == nullptr)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t *>(block) = size;
+    live_bytes += size;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return block + header_size;
+}
+
+void operator delete(void *p) noexcept {
+    if (p == nullptr)
+        return;
+    auto *block = static_cast<char *>(p) - header_size;
+    live_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Patterns whose time or memory grows faster than `size ^ super_linear_exponent` are flagged.
+constexpr double super_linear_exponent = 1.3;
+
+/// Each size is measured several times and the fastest run is kept, to reduce noise.
+constexpr int rounds = 3;
+
+/// A kind of synthetic pattern, grown to a given size in bytes.
+struct Shape {
+    std::string_view name;
+    std::string (*make)(std::size_t size);
+};
+
+/// Repeats `unit` until the pattern reaches `size` bytes.
+std::string repeat(std::string_view unit, std::size_t size, std::string_view separator = "") {
+    std::string regex;
+    regex.reserve(size + unit.size());
+    regex.append(unit);
+    while (regex.size() + separator.size() + unit.size() <= size) {
+        regex.append(separator);
+        regex.append(unit);
+    }
+    return regex;
+}
+
+const Shape shapes[] = {
+    {"literal", [](std::size_t size) { return repeat("a", size); }},
+    {"alternation", [](std::size_t size) { return repeat("a", size, "|"); }},
+    {"nested groups",
+     [](std::size_t size) {
+         std::size_t depth = (size - 1) / 2;
+         return std::string(depth, '(') + "a" + std::string(depth, ')');
+     }},
+    {"groups", [](std::size_t size) { return repeat("(a)\\1", size); }},
+    {"charsets", [](std::size_t size) { return repeat("[a-z0-9_]", size); }},
+    {"charset items", [](std::size_t size) { return "[" + repeat("a-z\\w\\W0-9_", size) + "]"; }},
+    {"repeats", [](std::size_t size) { return repeat("a{2,5}", size); }},
+    {"repeat bounds", [](std::size_t size) { return repeat("(ab){1000,99999}", size); }},
+};
+
+/// Cost of compiling a pattern of a given size.
+struct Sample {
+    double size;
+    double lex_ms;
+    double parse_ms;
+    double memory; ///< peak bytes allocated while lexing and parsing
+};
+
+double milliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Sample measure(const Shape &shape, std::size_t size) {
+    std::string regex = shape.make(size);
+    Sample sample{static_cast<double>(regex.size()), INFINITY, INFINITY, 0};
+
+    for (int i = 0; i < rounds; i++) {
+        std::size_t base_bytes = live_bytes;
+        peak_bytes = live_bytes;
+
+        auto start = Clock::now();
+        strex::Lexer lexer(regex);
+        auto tokens = lexer.tokenize();
+        auto lexed = Clock::now();
+        strex::Parser parser(tokens);
+        auto ast = parser.parse();
+        auto parsed = Clock::now();
+
+        sample.lex_ms = std::min(sample.lex_ms, milliseconds(lexed - start));
+        sample.parse_ms = std::min(sample.parse_ms, milliseconds(parsed - lexed));
+        sample.memory = static_cast<double>(peak_bytes - base_bytes);
+    }
+    return sample;
+}
+
+/// Returns the slope of the least squares line of `log(y)` against `log(x)`.
+double scaling_exponent(const std::vector<Sample> &samples, double Sample::*y) {
+    double n = static_cast<double>(samples.size());
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    for (const Sample &sample : samples) {
+        double log_x = std::log(sample.size);
+        double log_y = std::log(std::max(sample.*y, 1e-6));
+        sum_x += log_x;
+        sum_y += log_y;
+        sum_xx += log_x * log_x;
+        sum_xy += log_x * log_y;
+    }
+    return (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+}
+
+/// Prints samples of a shape and returns whether the growth is super-linear.
+bool report(const Shape &shape, const std::vector<Sample> &samples) {
+    for (const Sample &sample : samples) {
+        std::println("{:<14} {:>10.0f} {:>10.2f} {:>10.2f} {:>10.1f}", shape.name, sample.size,
+                     sample.lex_ms, sample.parse_ms, sample.memory / sample.size);
+    }
+
+    double lex = scaling_exponent(samples, &Sample::lex_ms);
+    double parse = scaling_exponent(samples, &Sample::parse_ms);
+    double memory = scaling_exponent(samples, &Sample::memory);
+    bool is_super_linear = std::max({lex, parse, memory}) > super_linear_exponent;
+    std::println("{:<14} exponent: lex {:.2f}, parse {:.2f}, memory {:.2f}{}", shape.name, lex,
+                 parse, memory, is_super_linear ? "  SUPER-LINEAR" : "");
+    return is_super_linear;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::size_t min_size = argc > 1 ? std::stoull(argv[1]) : 64 * 1024;
+    std::size_t max_size = argc > 2 ? std::stoull(argv[2]) : 10 * 1024 * 1024;
+
+    std::println("{:<14} {:>10} {:>10} {:>10} {:>10}", "shape", "bytes", "lex ms", "parse ms",
+                 "memory/B");
+    bool has_super_linear = false;
+    try {
+        for (const Shape &shape : shapes) {
+            std::vector<Sample> samples;
+            std::size_t size = min_size;
+            for (; size <= max_size; size *= 2)
+                samples.push_back(measure(shape, size));
+            // Doubling passes 1 MB but not 10 MB, so the max size is a point of its own.
+            if (size / 2 != max_size)
+                samples.push_back(measure(shape, max_size));
+            has_super_linear |= report(shape, samples);
+        }
+    }
+    catch (std::exception &e) {
+        std::println("{}", e.what());
+        return 1;
+    }
+    return has_super_linear ? 2 : 0;
+}
@@ -0,0 +1,128 @@
+// Measures the cost of `--secure`: throughput of `ChaCha20` against `BlockEngine` and
+// `std::mt19937`, and of `Generator` with the fast and the secure engine on the patterns in
+// `corpus.hpp`.
+// Usage: strex_bench_secure [number of strings per pattern]
+// Results are printed as JSON. The program exits with 2 if secure generation of any pattern is
+// more than `max_slowdown` times slower than fast generation.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <strex/ChaCha20.hpp>
+#include <strex/Generator.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Optimizer.hpp>
+#include <strex/Parser.hpp>
+#include <strex/Random.hpp>
+
+#include "corpus.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Secure generation may be this many times slower than fast generation.
+constexpr double max_slowdown = 2.0;
+
+constexpr int default_string_count = 200000;
+
+/// Number of 32-bit words drawn to measure an engine.
+constexpr std::size_t engine_words = 1 << 26;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string json_string(std::string_view text) {
+    std::string escaped = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\')
+            escaped.push_back('\\');
+        escaped.push_back(ch);
+    }
+    escaped.push_back('"');
+    return escaped;
+}
+
+/// Returns bytes per second of an engine.
+template <typename Engine>
+double engine_throughput(Engine &engine) {
+    std::uint32_t sum = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < engine_words; i++)
+        sum += static_cast<std::uint32_t>(engine());
+    double seconds = seconds_since(start);
+    // Keeps the loop from being removed.
+    if (sum == 1)
+        std::println(stderr, "");
+    return static_cast<double>(engine_words * sizeof(std::uint32_t)) / seconds;
+}
+
+/// Returns strings per second of a generator.
+double generator_throughput(strex::Generator &generator, int string_count) {
+    std::size_t bytes = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < string_count; i++)
+        bytes += generator.generate().size();
+    double seconds = seconds_since(start);
+    if (bytes == 1)
+        std::println(stderr, "");
+    return string_count / seconds;
+}
+
+/// Prints the throughput of a pattern and returns whether secure generation is too slow.
+bool run(const strex::bench::CorpusEntry &entry, int string_count, bool is_last) {
+    strex::Lexer lexer(std::string{entry.regex});
+    auto tokens = lexer.tokenize();
+    strex::Parser parser(tokens);
+    auto ast = parser.parse();
+    strex::PassManager::default_pipeline().run(ast);
+
+    strex::Generator fast(ast.get());
+    strex::Generator secure(ast.get(), true);
+    double fast_rate = generator_throughput(fast, string_count);
+    double secure_rate = generator_throughput(secure, string_count);
+    double slowdown = fast_rate / secure_rate;
+
+    std::println("    {{\"name\": {}, \"fast_strings_per_sec\": {:.0f}, "
+                 "\"secure_strings_per_sec\": {:.0f}, \"slowdown\": {:.2f}}}{}",
+                 json_string(entry.name), fast_rate, secure_rate, slowdown, is_last ? "" : ",");
+    return slowdown > max_slowdown;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int string_count = argc > 1 ? std::stoi(argv[1]) : default_string_count;
+
+    bool is_too_slow = false;
+    try {
+        std::mt19937 mt19937{std::random_device{}()};
+        strex::BlockEngine block;
+        strex::ChaCha20 chacha20;
+        std::println("{{\"corpus_version\": {}, \"strings_per_pattern\": {}, "
+                     "\"max_slowdown\": {:.1f},",
+                     strex::bench::corpus_version, string_count, max_slowdown);
+        std::println(" \"engines\": {{\"mt19937_bytes_per_sec\": {:.0f}, "
+                     "\"block_bytes_per_sec\": {:.0f}, \"chacha20_bytes_per_sec\": {:.0f}}},",
+                     engine_throughput(mt19937), engine_throughput(block),
+                     engine_throughput(chacha20));
+        std::println(" \"patterns\": [");
+        for (std::size_t i = 0; i < std::size(strex::bench::corpus); i++) {
+            is_too_slow |= run(strex::bench::corpus[i], string_count,
+                               i + 1 == std::size(strex::bench::corpus));
+        }
+        std::println("]}}");
+    }
+    catch (std::exception &e) {
+        std::println(stderr, "{}", e.what());
+        return 1;
+    }
+    return is_too_slow ? 2 : 0;
+}
\ No newline at end of file
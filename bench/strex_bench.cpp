@@ -0,0 +1,193 @@
+// Measures compile time and generation throughput of the patterns in `corpus.hpp`: bulk
+// generation through the backend that `from_regex` picks, and `Generator` one by one.
+// Usage: strex_bench [number of strings per pattern]
+// Results are printed as JSON, so runs can be compared by scripts.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <new>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Generator.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Optimizer.hpp>
+#include <strex/Parser.hpp>
+#include <strex/strex.hpp>
+
+#include "corpus.hpp"
+
+// The benchmark is single-threaded, a plain counter is enough.
+static std::size_t allocation_count = 0;
+
+void *operator new(std::size_t size) {
+    allocation_count++;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Number of times each compile phase runs, the average is reported.
+constexpr int compile_rounds = 100;
+
+constexpr int default_string_count = 20000;
+
+/// Time and allocations of a phase, averaged over its runs.
+struct Measurement {
+    double nanoseconds;
+    double allocations;
+};
+
+template <typename Phase>
+Measurement measure(int rounds, Phase phase) {
+    std::size_t allocations = allocation_count;
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; i++)
+        phase();
+    auto duration = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    return {duration.count() / rounds,
+            static_cast<double>(allocation_count - allocations) / rounds};
+}
+
+std::string_view backend_name(strex::ParsedRegex::Backend backend) {
+    using Backend = strex::ParsedRegex::Backend;
+    switch (backend) {
+        case Backend::Skeleton:
+            return "skeleton";
+        case Backend::Batch:
+            return "batch";
+        case Backend::Generator:
+            return "generator";
+        case Backend::Automaton:
+            return "automaton";
+    }
+    return "unknown";
+}
+
+std::string json_string(std::string_view text) {
+    std::string escaped = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\')
+            escaped.push_back('\\');
+        escaped.push_back(ch);
+    }
+    escaped.push_back('"');
+    return escaped;
+}
+
+void run(const strex::bench::CorpusEntry &entry, int string_count, bool is_last) {
+    std::string regex{entry.regex};
+
+    auto lex = measure(compile_rounds, [&] {
+        strex::Lexer lexer(regex);
+        lexer.tokenize();
+    });
+
+    strex::Lexer lexer(regex);
+    auto tokens = lexer.tokenize();
+    auto parse = measure(compile_rounds, [&] {
+        strex::Parser parser(tokens);
+        parser.parse();
+    });
+
+    auto optimize = measure(compile_rounds, [&] {
+        strex::Parser parser(tokens);
+        auto ast = parser.parse();
+        strex::PassManager::default_pipeline().run(ast);
+    });
+    // Optimization is measured together with parsing, since it needs a fresh AST every round.
+    optimize.nanoseconds -= parse.nanoseconds;
+    optimize.allocations -= parse.allocations;
+
+    // The backend is built by a first call, which is not measured.
+    strex::ParsedRegex parsed(regex);
+    strex::from_regex(parsed, 1);
+    std::vector<std::string> strings;
+    std::size_t bytes = 0;
+    auto bulk = measure(1, [&] {
+        strings = strex::from_regex(parsed, static_cast<std::size_t>(string_count));
+    });
+    for (const std::string &generated : strings)
+        bytes += generated.size();
+    double bulk_seconds = bulk.nanoseconds / 1e9;
+
+    // `Generator` skips lookarounds and inner anchors, only the automaton generates them.
+    std::string one_by_one = "null";
+    if (parsed.backend() != strex::ParsedRegex::Backend::Automaton) {
+        strex::Parser parser(tokens);
+        auto ast = parser.parse();
+        strex::PassManager::default_pipeline().run(ast);
+        strex::Generator generator(ast.get());
+        std::size_t generated_bytes = 0;
+        auto generate = measure(string_count, [&] {
+            generated_bytes += generator.generate().size();
+        });
+        double seconds = generate.nanoseconds * string_count / 1e9;
+        one_by_one = std::format("{{\"strings_per_sec\": {:.0f}, \"bytes_per_sec\": {:.0f}, "
+                                 "\"allocations_per_string\": {:.2f}}}",
+                                 string_count / seconds,
+                                 static_cast<double>(generated_bytes) / seconds,
+                                 generate.allocations);
+    }
+
+    strex::Matcher matcher(parsed);
+    std::size_t matched = 0;
+    std::size_t next = 0;
+    auto match = measure(string_count, [&] { matched += matcher.matches(strings[next++]); });
+    double match_seconds = match.nanoseconds * string_count / 1e9;
+
+    std::println("    {{\"name\": {}, \"regex\": {},", json_string(entry.name),
+                 json_string(entry.regex));
+    std::println("     \"lexer\": {{\"ns\": {:.0f}, \"allocations\": {:.1f}}},", lex.nanoseconds,
+                 lex.allocations);
+    std::println("     \"parser\": {{\"ns\": {:.0f}, \"allocations\": {:.1f}}},", parse.nanoseconds,
+                 parse.allocations);
+    std::println("     \"optimizer\": {{\"ns\": {:.0f}, \"allocations\": {:.1f}}},",
+                 optimize.nanoseconds, optimize.allocations);
+    std::println("     \"bulk\": {{\"backend\": {}, \"strings_per_sec\": {:.0f}, "
+                 "\"bytes_per_sec\": {:.0f}, \"allocations_per_string\": {:.2f}}},",
+                 json_string(backend_name(parsed.backend())), string_count / bulk_seconds,
+                 static_cast<double>(bytes) / bulk_seconds, bulk.allocations / string_count);
+    std::println("     \"generator\": {},", one_by_one);
+    std::println("     \"matcher\": {{\"strings_per_sec\": {:.0f}, \"bytes_per_sec\": {:.0f}, "
+                 "\"matched\": {}}}}}{}",
+                 string_count / match_seconds, static_cast<double>(bytes) / match_seconds,
+                 matched, is_last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int string_count = argc > 1 ? std::stoi(argv[1]) : default_string_count;
+
+    try {
+        std::println("{{\"corpus_version\": {}, \"strings_per_pattern\": {}, \"patterns\": [",
+                     strex::bench::corpus_version, string_count);
+        for (std::size_t i = 0; i < std::size(strex::bench::corpus); i++)
+            run(strex::bench::corpus[i], string_count, i + 1 == std::size(strex::bench::corpus));
+        std::println("]}}");
+    }
+    catch (std::exception &e) {
+        std::println(stderr, "{}", e.what());
+        return 1;
+    }
+}
@@ -12,11 +12,17 @@
 
 namespace strex {
 
+/// Base class of AST nodes.
+/// Composite nodes release their children without recursion when destroyed, so an AST of any
+/// depth can be destroyed safely.
 class ASTNode {
  public:
     virtual ~ASTNode() {}
 
     virtual void accept(ASTVisitor *visitor) const = 0;
+
+    /// Returns the part of the regular expression that the node is built from.
+    virtual const TextRange &text_range() const = 0;
 };
 
 /// Represents a plain character.
@@ -28,9 +34,9 @@ class TextNode : public ASTNode {
 
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
-    std::string text() const { return text_; }
+    const std::string &text() const { return text_; }
 
-    const TextRange &text_range() const { return range_; }
+    const TextRange &text_range() const override { return range_; }
 
  private:
     TextRange range_;
@@ -45,7 +51,7 @@ class CharsetNode : public ASTNode {
 
     const Charset *charset() const { return charset_; }
 
-    const TextRange &text_range() const { return range_; }
+    const TextRange &text_range() const override { return range_; }
 
  private:
     const Charset *charset_;
@@ -56,11 +62,16 @@ class SequenceNode : public ASTNode {
  public:
     SequenceNode(std::vector<std::unique_ptr<ASTNode>> nodes, const TextRange &range);
 
+    ~SequenceNode() override;
+
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
     const std::vector<std::unique_ptr<ASTNode>> &sequence() const { return nodes_; }
 
-    const TextRange &text_range() const { return range_; }
+    /// Returns elements of sequence for AST passes to rewrite.
+    std::vector<std::unique_ptr<ASTNode>> &mutable_sequence() { return nodes_; }
+
+    const TextRange &text_range() const override { return range_; }
 
  private:
     TextRange range_;
@@ -69,55 +80,83 @@ class SequenceNode : public ASTNode {
 
 class RepeatNode : public ASTNode {
  public:
-    RepeatNode(std::unique_ptr<ASTNode> node, int lower, int upper, const TextRange &range);
+    /// @param upper the most repetitions to generate
+    /// @param is_open_ended if the quantifier has no upper bound, like `*`, `+` and `{n,}`
+    RepeatNode(std::unique_ptr<ASTNode> node, int lower, int upper, const TextRange &range,
+               bool is_open_ended = false);
+
+    ~RepeatNode() override;
 
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
     const ASTNode *content() const { return node_.get(); }
 
-    const TextRange &text_range() const { return range_; }
+    /// Returns content of repetition for AST passes to rewrite.
+    std::unique_ptr<ASTNode> &mutable_content() { return node_; }
+
+    const TextRange &text_range() const override { return range_; }
 
     int repeat_lower() const { return lower_; }
 
     int repeat_upper() const { return upper_; }
 
+    /// Checks if the quantifier has no upper bound.
+    /// `repeat_upper` is still a limit for generation, but a match may repeat any times.
+    bool is_open_ended() const { return is_open_ended_; }
+
  private:
     std::unique_ptr<ASTNode> node_;
     TextRange range_;
     int lower_;
     int upper_;
+    bool is_open_ended_;
 };
 
 class GroupNode : public ASTNode {
  public:
     GroupNode(std::unique_ptr<ASTNode> node, int index, const TextRange &range);
 
+    ~GroupNode() override;
+
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
     const ASTNode *content() const { return node_.get(); }
 
-    const TextRange &text_range() const { return range_; }
+    /// Returns content of group for AST passes to rewrite.
+    std::unique_ptr<ASTNode> &mutable_content() { return node_; }
+
+    const TextRange &text_range() const override { return range_; }
 
     int index() const { return index_; }
 
- private:
-    constexpr static int max_group_number = 255;
+    /// Checks if any backreference uses the text of group.
+    /// Text of unreferenced groups is not recorded by `Generator`.
+    bool is_referenced() const { return is_referenced_; }
+
+    void mark_referenced() { is_referenced_ = true; }
 
+ private:
     std::unique_ptr<ASTNode> node_;
     TextRange range_;
     int index_;
+    bool is_referenced_{false};
 };
 
 class AlternationNode : public ASTNode {
  public:
     AlternationNode(std::vector<std::unique_ptr<ASTNode>> elements, const TextRange &range);
 
+    ~AlternationNode() override;
+
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
-    const TextRange &text_range() const { return range_; }
+    const TextRange &text_range() const override { return range_; }
 
     const std::vector<std::unique_ptr<ASTNode>> &elements() const { return elements_; }
 
+    /// Returns alternatives for AST passes to rewrite.
+    std::vector<std::unique_ptr<ASTNode>> &mutable_elements() { return elements_; }
+
  private:
     std::vector<std::unique_ptr<ASTNode>> elements_;
     TextRange range_;
@@ -129,7 +168,7 @@ class BackrefNode : public ASTNode {
 
     void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
 
-    const TextRange &text_range() const { return range_; }
+    const TextRange &text_range() const override { return range_; }
 
     const GroupNode *group() const { return group_; }
 
@@ -138,6 +177,58 @@ class BackrefNode : public ASTNode {
     TextRange range_;
 };
 
+/// Represents `^` or `$`, which matches a position instead of characters.
+class AnchorNode : public ASTNode {
+ public:
+    enum class Type {
+        Begin, ///< `^`, the beginning of the string
+        End    ///< `$`, the end of the string
+    };
+
+    AnchorNode(Type type, const TextRange &range);
+
+    void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
+
+    const TextRange &text_range() const override { return range_; }
+
+    Type type() const { return type_; }
+
+ private:
+    Type type_;
+    TextRange range_;
+};
+
+/// Represents `(?=...)`, `(?!...)`, `(?<=...)` or `(?<!...)`.
+/// A lookaround checks the text after or before a position without consuming it.
+class LookaroundNode : public ASTNode {
+ public:
+    LookaroundNode(std::unique_ptr<ASTNode> node, bool is_lookbehind, bool is_negative,
+                   const TextRange &range);
+
+    ~LookaroundNode() override;
+
+    void accept(ASTVisitor *visitor) const override { return visitor->visit(this); }
+
+    const ASTNode *content() const { return node_.get(); }
+
+    /// Returns content of lookaround for AST passes to rewrite.
+    std::unique_ptr<ASTNode> &mutable_content() { return node_; }
+
+    const TextRange &text_range() const override { return range_; }
+
+    /// Checks if the content must match the text before the position.
+    bool is_lookbehind() const { return is_lookbehind_; }
+
+    /// Checks if the content must not match.
+    bool is_negative() const { return is_negative_; }
+
+ private:
+    std::unique_ptr<ASTNode> node_;
+    TextRange range_;
+    bool is_lookbehind_;
+    bool is_negative_;
+};
+
 } // namespace strex
 
 #endif
\ No newline at end of file
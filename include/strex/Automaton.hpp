@@ -0,0 +1,91 @@
+/// @file
+
+#ifndef NEROLL_STREX_AUTOMATON_HPP
+#define NEROLL_STREX_AUTOMATON_HPP
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <strex/Random.hpp>
+
+namespace strex {
+
+class ASTNode;
+
+/// Generates strings of patterns with lookarounds from a DFA.
+/// The pattern is compiled to a `Program`, and lookarounds are folded into DFA states by product
+/// construction. Lookbehinds run as a tracker from the beginning of the string, a lookahead
+/// becomes an obligation carried by the threads that passed it until its body matches or fails.
+/// The number of accepted strings of each length from each state is counted once, and a string
+/// is sampled by walking the DFA with transitions weighted by those counts. So each string costs
+/// O(length) and strict patterns never need rejection sampling.
+class Automaton {
+ public:
+    /// DFA states beyond this are rejected.
+    constexpr static std::size_t max_states = 1 << 16;
+
+    /// Entries of the table of counts beyond this are rejected.
+    constexpr static std::size_t max_counts = 1 << 26;
+
+    /// @throw SyntaxNotSupport if the pattern has backreferences or lookarounds inside
+    /// lookbehinds, or the DFA is too large
+    explicit Automaton(const ASTNode *ast);
+
+    /// Generates a string whose length is chosen uniformly from the possible lengths, then the
+    /// string is chosen uniformly from the strings of that length.
+    /// Lengths are bounded like `Generator` does, open-ended repetitions count as
+    /// `RepeatNode::repeat_upper` repetitions. Only printable characters are generated.
+    /// @param random_draws incremented by the number of values drawn from `engine`
+    /// @param max_bytes lengths above it are not considered, for a byte budget
+    /// @throw GenerateError if no string of a possible length matches, the message says when the
+    /// repeat ceiling bounded the lengths, which lookarounds may need longer
+    std::string generate(BlockEngine &engine, std::uint64_t &random_draws,
+                         std::size_t max_bytes = std::numeric_limits<std::size_t>::max()) const;
+
+    /// Checks if the whole `text` matches the pattern.
+    bool matches(std::string_view text) const;
+
+    std::size_t state_count() const { return accepting_.size(); }
+
+    /// Returns the longest length that `generate` considers.
+    std::size_t max_length() const { return max_length_; }
+
+ private:
+    /// Builds the DFA by product construction.
+    class Builder;
+
+    constexpr static std::uint32_t dead_state = 0;
+
+    /// Returns the number of accepted strings of `length` from `state`, scaled per length.
+    double count(std::size_t length, std::uint32_t state) const {
+        return counts_[length * accepting_.size() + state];
+    }
+
+    std::uint32_t next(std::uint32_t state, std::size_t byte_class) const {
+        return transitions_[state * class_bytes_.size() + byte_class];
+    }
+
+    /// Counts accepted strings of each length, and finds the lengths that can be generated.
+    void count_paths();
+
+    std::array<std::uint16_t, UCHAR_MAX + 1> classes_{}; ///< class of each byte
+    std::vector<std::string> class_bytes_; ///< printable bytes of each class
+    std::vector<std::uint32_t> transitions_; ///< `class_bytes_.size()` entries per state
+    std::vector<bool> accepting_;
+    std::uint32_t start_state_{dead_state};
+
+    std::size_t max_length_{0};
+    bool is_capped_{false}; ///< if `max_length_` is bounded by the repeat ceiling of the parser
+    std::vector<double> counts_; ///< `accepting_.size()` entries per length
+    std::vector<std::size_t> lengths_; ///< lengths that have accepted strings from the start
+};
+
+} // namespace strex
+
+#endif
@@ -0,0 +1,132 @@
+/// @file
+
+#ifndef NEROLL_STREX_BATCH_GENERATOR_HPP
+#define NEROLL_STREX_BATCH_GENERATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <strex/Random.hpp>
+
+namespace strex {
+
+class ASTNode;
+class Charset;
+
+/// Generates `lanes` strings at once, for bulk generation.
+/// The AST is flattened into a plan of steps, and all lanes go through the plan in lockstep:
+/// each step takes the random values of all lanes from the block of a `BlockEngine` at once.
+/// If every lane has the same shape, no alternation, no variable repetition and ASCII charsets
+/// only, bytes are written column by column, one column holds a byte of all lanes, and columns
+/// are transposed into strings at the end. Otherwise lanes that take a path are kept in a mask,
+/// and steps append to the strings of the lanes in their mask.
+/// Strings follow the same distribution as `Generator`, lookarounds are not supported.
+class BatchGenerator {
+ public:
+    constexpr static std::size_t lanes = 64;
+
+    explicit BatchGenerator(const ASTNode *ast);
+
+    /// Generates `lanes` strings, they are valid until the next call.
+    const std::array<std::string, lanes> &generate();
+
+    /// Returns true if all lanes have the same shape, and strings are written as columns.
+    bool is_fixed_shape() const { return is_fixed_shape_; }
+
+    /// Returns the number of random values used since construction, one for each decision of
+    /// each lane, like `Generator::random_draws`.
+    std::uint64_t random_draws() const { return random_draws_; }
+
+ private:
+    /// Bits of lanes, lane `i` is bit `i`.
+    using Mask = std::uint64_t;
+
+    /// Values of all lanes.
+    using LaneValues = std::array<std::uint32_t, lanes>;
+
+    enum class StepType {
+        Text,        ///< appends `texts_[value]`
+        Charset,     ///< appends a character of `charsets_[value]`
+        Repeat,      ///< repeats the steps up to `end` between `lower` and `upper` times
+        Alternation, ///< runs one of the alternatives that start at `alternatives_[value]`
+        Group,       ///< runs the steps up to `end`, and captures their text as group `value`
+        Backref      ///< appends the text captured by group `value`
+    };
+
+    /// A step of the plan, the steps inside a step follow it.
+    struct Step {
+        StepType type;
+        std::uint32_t end{0};   ///< index after the step and the steps inside it
+        std::uint32_t value{0}; ///< index of text, charset, first alternative or group
+        std::uint32_t lower{0}; ///< repetitions, or number of alternatives
+        std::uint32_t upper{0};
+    };
+
+    /// A charset, with its characters as bytes if they are all ASCII.
+    struct CharsetStep {
+        const Charset *charset;
+        std::string ascii; ///< generated characters, empty if one is not ASCII
+    };
+
+    enum class TaskType {
+        Run,         ///< runs the steps from `begin` to `end`
+        Repeat,      ///< runs an iteration for lanes that have repetitions left
+        Close_Group  ///< records captures of group `step`
+    };
+
+    /// A pending step of generation, for the lanes in `mask`.
+    struct Task {
+        TaskType type;
+        std::uint32_t begin;
+        std::uint32_t end;
+        Mask mask;
+    };
+
+    /// Text captured by a group in each lane.
+    struct Capture {
+        LaneValues offsets{};
+        LaneValues lengths{};
+        Mask captured{0}; ///< lanes where the group has generated in current strings
+    };
+
+    /// Appends the steps of the AST to the plan.
+    void compile(const ASTNode *ast);
+
+    /// Runs a step for the lanes in `mask`.
+    void run(std::uint32_t index, Mask mask);
+
+    /// Draws a value in [0, `bound`) for each lane in `mask`.
+    void draw(std::uint32_t bound, Mask mask);
+
+    /// Returns the length of the string of a lane.
+    std::uint32_t position(std::size_t lane) const;
+
+    void append_text(const std::string &text, Mask mask);
+
+    void append_charset(const CharsetStep &charset, Mask mask);
+
+    void append_backref(const Capture &capture, Mask mask);
+
+    std::vector<Step> steps_;
+    std::vector<std::uint32_t> alternatives_; ///< first step of each alternative
+    std::vector<std::string> texts_;
+    std::vector<CharsetStep> charsets_;
+    bool is_fixed_shape_{true};
+
+    std::vector<Task> tasks_;
+    std::vector<LaneValues> lane_values_; ///< repetitions left or group starts of open steps
+    std::vector<Capture> captures_;       ///< captures indexed by group number
+    BlockEngine engine_;
+    LaneValues draws_{}; ///< values drawn by the current step
+
+    std::vector<char> columns_; ///< byte `i` of lane `j` at `i * lanes + j`, if fixed shape
+    std::array<std::string, lanes> strings_;
+    std::uint64_t random_draws_{0};
+};
+
+} // namespace strex
+
+#endif
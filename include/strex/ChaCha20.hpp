@@ -0,0 +1,77 @@
+/// @file
+
+#ifndef NEROLL_STREX_CHACHA20_HPP
+#define NEROLL_STREX_CHACHA20_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace strex {
+
+/// Cryptographically secure engine, the ChaCha20 stream cipher as a random bit generator.
+/// Blocks are generated `lanes` at a time with the lanes in the innermost loops, so the rounds
+/// are vectorized by the compiler, in the kernel of `cpu::active()`. An engine seeded by the OS
+/// is rekeyed from `getrandom(2)` every `rekey_interval` bytes, and keys are read from the OS in
+/// batches.
+class ChaCha20 {
+ public:
+    using result_type = std::uint32_t;
+    using Key = std::array<std::uint32_t, 8>;
+
+    /// Number of blocks generated at once.
+    constexpr static std::size_t lanes = 8;
+
+    /// Bytes of output between keys of an engine seeded by the OS.
+    constexpr static std::uint64_t rekey_interval = 1 << 20;
+
+    /// Number of keys read from the OS at once, 256 bytes is the most `getrandom(2)` returns
+    /// without being interrupted.
+    constexpr static std::size_t keys_per_batch = 8;
+
+    /// Seeds the engine from the OS.
+    /// @throw GenerateError if the OS has no entropy to give
+    ChaCha20();
+
+    /// Returns the keystream of `key` and `nonce` from block `counter`, it is never rekeyed.
+    /// Word 12 and 13 of the state are the counter, word 14 and 15 are the nonce.
+    ChaCha20(const Key &key, std::uint64_t nonce, std::uint64_t counter = 0);
+
+    // Copies would give the same output.
+    ChaCha20(const ChaCha20 &) = delete;
+    ChaCha20 &operator=(const ChaCha20 &) = delete;
+
+    constexpr static result_type min() { return 0; }
+
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (position_ == buffer_.size())
+            refill();
+        return buffer_[position_++];
+    }
+
+ private:
+    constexpr static std::size_t block_words = 16;
+
+    /// Generates the next `lanes` blocks into `buffer_`.
+    void refill();
+
+    /// Replaces the key with the next one read from the OS, and restarts the counter.
+    void rekey();
+
+    Key key_{};
+    std::uint64_t nonce_{0};
+    std::uint64_t counter_{0};
+    std::array<std::uint32_t, block_words * lanes> buffer_{};
+    std::size_t position_{buffer_.size()};
+    bool is_rekeyed_{false};                        ///< if the engine is seeded by the OS
+    std::uint64_t generated_{0};                    ///< bytes generated with the current key
+    std::array<Key, keys_per_batch> keys_{};        ///< keys read from the OS and not used yet
+    std::size_t next_key_{keys_per_batch};          ///< index of the next key in `keys_`
+};
+
+} // namespace strex
+
+#endif
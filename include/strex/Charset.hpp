@@ -1,16 +1,36 @@
 #ifndef NEROLL_STREX_CHARSET_HPP
 #define NEROLL_STREX_CHARSET_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <string_view>
+#include <vector>
+
+#include <strex/Unicode.hpp>
 
 namespace strex {
 
+/// A set of code points, stored as sorted intervals.
+/// Generated code points have prefix sums of their interval sizes, so the code point at a random
+/// index is found in O(log intervals).
 class Charset {
  public:
+    using Ranges = unicode::Ranges;
+
+    /// Returns the charset of the characters in an ASCII `alphabet`, or of all other code points.
+    /// An inclusive charset generates its printable characters, an exclusive one generates
+    /// printable ASCII characters that it has.
     // TODO Maybe can use enum instead of bool parameter.
     static const Charset *get(std::string alphabet, bool is_inclusive = true);
 
+    /// Returns the inclusive charset of `ranges`, which generates its printable code points that
+    /// are also in `generated`.
+    static const Charset *get(Ranges ranges, Ranges generated);
+
+    /// Returns the charset of general categories in the mask `categories`, `\p{...}`, or of all
+    /// other code points, `\P{...}`.
+    static const Charset *from_property(std::uint32_t categories, bool is_inclusive);
+
     static const Charset *from_char_class(char char_class);
 
     /// \d, [0-9]
@@ -31,19 +51,40 @@ class Charset {
     /// \S, [^ \t\r\n]
     static const Charset *non_space();
 
+    /// ., all code points but `\n`
     static const Charset *any();
 
     bool is_inclusive() const { return is_inclusive_; }
 
-    std::string_view alphabet() const;
+    /// Returns the ranges listed by the charset, it has these code points if it is inclusive, or
+    /// all other code points if not.
+    const Ranges &ranges() const { return ranges_; }
+
+    /// Returns the code points in the charset.
+    Ranges members() const;
+
+    /// Returns printable code points in the charset that are generated from it.
+    const Ranges &generated() const { return generated_; }
+
+    /// Returns the number of generated code points.
+    std::size_t size() const { return size_; }
+
+    /// Returns the generated code point at `index`, which is less than `size()`.
+    char32_t at(std::size_t index) const;
 
     bool operator<(const Charset &other) const;
 
  private:
-    Charset(std::string alphabet, bool is_inclusive);
+    Charset(Ranges ranges, Ranges generated, bool is_inclusive);
+
+    /// Returns the unique charset equal to `charset`.
+    static const Charset *intern(Charset charset);
 
-    std::string alphabet_; ///< characters in charset
-    bool is_inclusive_;    ///< if the charset is inclusive
+    Ranges ranges_;                     ///< sorted and disjoint ranges
+    Ranges generated_;                  ///< generated code points, sorted and disjoint
+    std::vector<std::uint32_t> starts_; ///< index of the first code point of each generated range
+    std::size_t size_{0};               ///< number of generated code points
+    bool is_inclusive_;                 ///< if the charset is inclusive
 };
 
 } // namespace strex
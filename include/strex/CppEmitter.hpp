@@ -0,0 +1,87 @@
+/// @file
+
+#ifndef NEROLL_STREX_CPP_EMITTER_HPP
+#define NEROLL_STREX_CPP_EMITTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace strex {
+
+class ASTNode;
+class Charset;
+
+/// Emits a standalone C++ header with a generator function specialized for one regex, for
+/// patterns that are only known when a build runs, like ones from config files.
+/// The function is straight-line code: short fixed repetitions are unrolled, alternations are
+/// `switch` statements and charsets are static tables. The header only needs the standard library.
+/// Helpers that the functions share are in namespace `strex_generated::detail`.
+class CppEmitter {
+ public:
+    /// Repetitions of a charset up to this count are unrolled, others become loops.
+    constexpr static int max_unrolled = 16;
+
+    /// @param name name of the function in namespace `strex_generated`, a C++ identifier
+    /// @throw std::invalid_argument if `name` is not an identifier, or is a keyword, a reserved
+    /// identifier or a name that the header uses, like `Engine`, `out` or `table_0`
+    CppEmitter(const ASTNode *ast, std::string_view name);
+
+    /// Returns the header, `regex` is written into a comment of the function.
+    /// The header defines `void name(std::string &out, strex_generated::Engine &engine)` which
+    /// appends a string to `out`, and `std::string name(strex_generated::Engine &engine)`.
+    /// Headers of different functions can be included in one translation unit.
+    /// @throw SyntaxNotSupport if the AST has lookarounds
+    std::string emit(std::string_view regex);
+
+    /// Returns `text` as a C++ string literal, or a character literal if `mark` is `'`.
+    static std::string quote(std::string_view text, char mark = '"');
+
+ private:
+    /// Kinds of pending work, lines are written as code of children is emitted.
+    enum class TaskType {
+        Visit, ///< emits the code of the node
+        Line,  ///< writes the line
+        Text,  ///< writes the code that appends the text in `line`
+        Open,  ///< writes the line and indents the lines after it
+        Close  ///< unindents and writes the line
+    };
+
+    struct Task {
+        TaskType type;
+        const ASTNode *node{nullptr};
+        std::string line{};
+    };
+
+    /// Writes a line of the function body at the current indentation.
+    void write(std::string_view line);
+
+    /// Writes the code that appends `text`.
+    void write_text(std::string_view text);
+
+    /// Returns the name of the static table of `charset`, and emits the table if it is new.
+    std::string table(const Charset *charset);
+
+    /// Emits the code that appends a random character of `charset`.
+    void emit_charset(const Charset *charset);
+
+    void visit(const ASTNode *node);
+
+    const ASTNode *ast_;
+    std::string name_;
+    std::vector<Task> tasks_;
+    std::string tables_; ///< definitions of tables, written before the body
+    std::string body_;
+    int indent_{1};
+    int loops_{0}; ///< number of loop variables so far, which makes their names unique
+    std::map<const Charset *, std::string> table_names_;
+    std::set<int> groups_; ///< indices of referenced groups, each has a capture variable
+};
+
+} // namespace strex
+
+#endif
@@ -0,0 +1,63 @@
+/// @file
+/// Runtime dispatch of SIMD kernels.
+/// Hot loops are compiled for several instruction sets in one binary, and the set of the running
+/// CPU is picked once when a kernel is first used, so the libraries are built for the baseline
+/// and still use AVX2 or AVX-512 where the CPU has them.
+
+#ifndef NEROLL_STREX_CPU_HPP
+#define NEROLL_STREX_CPU_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace strex::cpu {
+
+/// Instruction sets that kernels are compiled for, each one includes the ones before it.
+enum class Level {
+    Scalar, ///< portable code, on targets other than x86-64
+    SSE2,   ///< the x86-64 baseline
+    AVX2,
+    AVX512  ///< AVX-512 F, BW, DQ and VL
+};
+
+/// Returns the lowercase name of `level`, like `avx2`.
+std::string_view name(Level level);
+
+/// Returns the level named `name`, or nothing if there is none.
+std::optional<Level> parse_level(std::string_view name);
+
+/// Returns the highest level the running CPU supports.
+Level detect();
+
+/// One variant of every kernel, compiled for `level`. Every kernel has a variant for every
+/// compiled level, so `level` is the variant each of them runs.
+struct Kernels {
+    Level level;
+
+    /// Steps the `BlockEngine::lanes` xoshiro256** streams of `state` until `block` holds
+    /// `BlockEngine::block_words` words. Word `i` of lane `j` of the state is at `i * lanes + j`.
+    void (*xoshiro_block)(std::uint64_t *state, std::uint32_t *block);
+
+    /// Computes `ChaCha20::lanes` blocks from their input states. Word `i` of the input of lane
+    /// `j` is at `input[i * lanes + j]`, and block `j` is written to `output + j * 16`.
+    void (*chacha20_blocks)(const std::uint32_t *input, std::uint32_t *output);
+
+    /// Writes `table[reduce(words[i], size)]` to `out[i]` for `i` in [0, `count`).
+    /// Returns false if a product was biased, then the caller has to draw those bytes again.
+    bool (*charset_run)(char *out, const std::uint32_t *words, std::size_t count,
+                        const char *table, std::uint32_t size);
+};
+
+/// Returns the kernels of `level`, or of the nearest compiled level. x86-64 has no kernels below
+/// the SSE2 baseline, and other targets have scalar kernels only.
+const Kernels &kernels(Level level);
+
+/// Returns the kernels of the running CPU. The level is `detect()`, lowered to the value of the
+/// `STREX_CPU` environment variable if it names a lower one, and is picked on the first call.
+const Kernels &active();
+
+} // namespace strex::cpu
+
+#endif
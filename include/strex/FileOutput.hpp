@@ -0,0 +1,38 @@
+/// @file
+/// Parallel generation of strings into a file.
+
+#ifndef NEROLL_STREX_FILE_OUTPUT_HPP
+#define NEROLL_STREX_FILE_OUTPUT_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <strex/GenerationOptions.hpp>
+
+namespace strex {
+
+/// Bytes a thread writes into the mapped file between two `msync(2)` calls.
+constexpr std::size_t file_sync_bytes = 64 << 20;
+
+/// Writes `count` strings of `regex`, one per line, into the file at `path` with `jobs` threads.
+/// Each thread has its own copy of the regex and writes its share of the strings in order, and
+/// nothing is shared between threads while they run.
+///
+/// If the regex has a `Skeleton`, every line has the same length and the size of the file is
+/// known. On Linux the file is then allocated with `fallocate(2)` and mapped, and each thread
+/// fills its own region of the mapping, calling `msync(2)` every `file_sync_bytes`. Any failure to
+/// allocate, like a full disk, throws, except on file systems without `fallocate(2)`. Those get a
+/// sparse file sized with `ftruncate(2)`, where running out of space while the mapping is written
+/// raises `SIGBUS`.
+///
+/// Otherwise each thread writes a new chunk file next to `path`, like `path.part0`, skipping
+/// names of files that exist. The chunks are appended to the file in order with
+/// `copy_file_range(2)`, which copies inside the kernel, then removed.
+/// @throw GenerateError if the file cannot be written
+void generate_to_file(std::string_view regex, const GenerationOptions &options,
+                      const std::string &path, std::size_t count, unsigned jobs);
+
+} // namespace strex
+
+#endif
@@ -3,6 +3,7 @@
 #ifndef NEROLL_STREX_FORMAT_HPP
 #define NEROLL_STREX_FORMAT_HPP
 
+#include <cstdint>
 #include <format>
 #include <string>
 
@@ -24,8 +25,11 @@ struct std::formatter<strex::Token> {
     auto format(const strex::Token &token, Context &context) const {
         std::string fmt = std::format("<{}", strex::enum_name(token.type()));
         if (token.is(strex::TokenType::Character)) {
-            char ch = token.character();
-            fmt += std::format(": '{}' ({})", ch, static_cast<int>(ch));
+            char32_t code_point = token.code_point();
+            if (code_point < 0x80)
+                fmt += std::format(": '{}' ({})", token.character(), static_cast<int>(code_point));
+            else
+                fmt += std::format(": U+{:04X}", static_cast<std::uint32_t>(code_point));
         }
         if (token.is(strex::TokenType::Repeat)) {
             int lower = token.repeat_lower();
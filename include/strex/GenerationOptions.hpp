@@ -0,0 +1,60 @@
+/// @file
+
+#ifndef NEROLL_STREX_GENERATION_OPTIONS_HPP
+#define NEROLL_STREX_GENERATION_OPTIONS_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace strex {
+
+/// How the number of repetitions of a quantifier is chosen between its bounds.
+enum class RepeatDistribution {
+    Uniform,  ///< every count from the lower to the upper bound is equally likely
+    Geometric ///< counts above the lower bound are geometric with mean `repeat_mean`, and capped
+              ///< at the upper bound
+};
+
+/// What happens to a string that would be longer than `GenerationOptions::max_bytes`.
+enum class BudgetPolicy {
+    Truncate, ///< the string is cut at the last UTF-8 character that fits, and may not match
+    Shortest, ///< the string is generated again with the fewest repetitions and the shortest
+              ///< alternatives, which matches, and throws `GenerateError` if that does not fit
+    Error     ///< throws `GenerateError`
+};
+
+/// Options that bound the length of generated strings, and so the time to generate one.
+/// Generation stops as soon as a string is over the budget, instead of generating all of it.
+struct GenerationOptions {
+    /// Open-ended repetitions are bounded: `*` and `+` repeat at most `max_repeat` times, and
+    /// `{n,}` at most `n + max_repeat` times.
+    constexpr static int default_max_repeat = 3;
+
+    int max_repeat{default_max_repeat};
+    RepeatDistribution repeat_distribution{RepeatDistribution::Uniform};
+    double repeat_mean{1.0};  ///< mean repetitions above the lower bound of geometric counts
+    std::size_t max_bytes{0}; ///< most bytes of a string, 0 is no budget
+    BudgetPolicy budget_policy{BudgetPolicy::Truncate};
+
+    /// Returns true if strings follow the default distribution and have no budget, which bulk
+    /// generation with `BatchGenerator` supports.
+    bool is_default_distribution() const {
+        return repeat_distribution == RepeatDistribution::Uniform && max_bytes == 0;
+    }
+
+    /// Checks the options.
+    /// @throw std::invalid_argument if `max_repeat` is negative or `repeat_mean` is not positive
+    void validate() const;
+};
+
+/// Returns the distribution named `name`, `uniform` or `geometric`.
+/// @throw std::invalid_argument if there is none
+RepeatDistribution parse_repeat_distribution(std::string_view name);
+
+/// Returns the policy named `name`, `truncate`, `shortest` or `error`.
+/// @throw std::invalid_argument if there is none
+BudgetPolicy parse_budget_policy(std::string_view name);
+
+} // namespace strex
+
+#endif
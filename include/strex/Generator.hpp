@@ -1,23 +1,149 @@
 #ifndef NEROLL_STREX_GENERATOR_HPP
 #define NEROLL_STREX_GENERATOR_HPP
 
-#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
+#include <strex/ChaCha20.hpp>
+#include <strex/GenerationOptions.hpp>
+#include <strex/Profile.hpp>
+#include <strex/Random.hpp>
+#include <strex/Sink.hpp>
 #include <strex/Visitor.hpp>
 
 namespace strex {
 
+/// Engine of `Generator`, fast `BlockEngine` or `ChaCha20` in secure mode.
+/// The bit reservoir of `Generator` calls it about once every 10 choices, so the branch costs
+/// little.
+struct GeneratorEngine {
+    using result_type = std::uint32_t;
+
+    constexpr static result_type min() { return 0; }
+
+    constexpr static result_type max() { return ChaCha20::max(); }
+
+    result_type operator()() {
+        return secure != nullptr ? (*secure)() : fast();
+    }
+
+    BlockEngine fast;
+    std::unique_ptr<ChaCha20> secure;
+};
+
+/// Generates strings from an AST.
+/// Nodes are visited from an explicit stack of tasks instead of recursion, so deeply nested
+/// patterns do not overflow the call stack.
 class Generator : public ASTVisitor {
  public:
-    explicit Generator(const ASTNode *ast);
+    /// @param is_secure if choices are drawn from `ChaCha20` instead of `BlockEngine`, for keys
+    /// and passwords that must not be predictable from other output
+    explicit Generator(const ASTNode *ast, bool is_secure = false);
+
+    /// Generates with the repeat distribution and byte budget of `options`. The repeat ceiling
+    /// is applied by the parser, so it is already in the AST.
+    /// @throw std::invalid_argument if `options` are not valid
+    Generator(const ASTNode *ast, const GenerationOptions &options, bool is_secure = false);
 
+    /// Streamed strings are written in chunks of about this many bytes.
+    constexpr static std::size_t chunk_size = 64 * 1024;
+
+    /// @throw GenerateError if the string is over the byte budget and the policy does not allow
+    /// a shorter one
     std::string generate();
 
+    /// Generates a string like `generate()` and appends it to `out`, so nothing is allocated once
+    /// `out` and the generator have grown to the size of the strings.
+    /// @throw GenerateError like `generate()`
+    void generate_into(std::string &out);
+
+    /// Writes a string to `sink` in chunks as it is generated, so memory stays flat however long
+    /// the string is. Only the text of referenced groups is kept, for their backreferences.
+    /// @throw GenerateError like `generate()`, the chunks written before stay written. A string
+    /// over a budget of `chunk_size` or more cannot fall back to the shortest string
+    void generate(Sink &sink);
+
+    /// Returns the number of bytes that the last `generate(Sink &)` wrote.
+    std::uint64_t streamed_bytes() const { return streamed_; }
+
+    /// Records cost of each node in `profile` while generating, `nullptr` to stop profiling.
+    /// `profile` must be built from the same AST.
+    void set_profile(Profile *profile) { profile_ = profile; }
+
+    /// Returns the number of random choices since construction.
+    std::uint64_t random_draws() const { return random_draws_; }
+
+    /// Returns the number of engine outputs consumed since construction, choices share them.
+    std::uint64_t engine_calls() const { return random_.engine_calls(); }
+
  private:
+    /// Kinds of pending work.
+    enum class TaskType {
+        Visit,      ///< visits the node
+        Repeat,     ///< generates the content of a `RepeatNode` for remaining times
+        Close_Group, ///< records the text generated by a `GroupNode`
+        Profile_End  ///< records the bytes generated by a node
+    };
+
+    /// A referenced group that is open while streaming, with its text that has been written.
+    struct OpenGroup {
+        std::size_t offset;
+        std::string text;
+    };
+
+    /// A pending step of generation.
+    struct Task {
+        TaskType type;
+        const ASTNode *node;
+        std::size_t value{0}; ///< remaining repetitions, or where the text of a node begins
+    };
+
+    /// Text generated by a group, as a span of the generated string, counting streamed bytes.
+    struct Capture {
+        std::size_t offset{0};
+        std::size_t length{0};
+        bool captured{false}; ///< if the group has generated in current string
+    };
+
+    /// Pushes a task that visits the node.
     void generate(const ASTNode *node);
 
+    /// Starts a string.
+    void start();
+
+    /// Runs the tasks until the stack is empty, or the string is over the byte budget.
+    void run();
+
+    /// Returns the length of the string so far, counting streamed bytes.
+    std::size_t position() const { return streamed_ + generated_string_.size(); }
+
+    /// Appends `text` to the string, and writes full chunks to the sink while streaming.
+    void append(std::string_view text);
+
+    /// Writes the buffered part of the string to the sink.
+    void flush();
+
+    /// Keeps the text of a referenced group that closes while streaming.
+    void close_streamed_group(std::size_t index);
+
+    /// Applies the budget policy to a string that is over the byte budget.
+    void apply_budget();
+
+    /// Returns the number of repetitions above the lower bound from the geometric distribution,
+    /// at most `cap`.
+    int geometric_count(int cap);
+
+    /// Computes `shortest_`, the longest string of each node when it generates the fewest bytes.
+    void measure_shortest();
+
+    /// Visits the node and records its cost in the profile.
+    void visit_profiled(const ASTNode *node);
+
     void visit(const TextNode *node) override;
 
     void visit(const CharsetNode *node) override;
@@ -32,10 +158,28 @@ class Generator : public ASTVisitor {
 
     void visit(const BackrefNode *node) override;
 
+    void visit(const AnchorNode *node) override;
+
+    void visit(const LookaroundNode *node) override;
+
     const ASTNode *ast_;
+    GenerationOptions options_;
+    std::size_t budget_; ///< most bytes of a string, the largest size if there is no budget
+    double repeat_log_;  ///< logarithm of the ratio of consecutive geometric probabilities
+    bool is_shortest_{false}; ///< if repetitions and alternatives generate the fewest bytes
+    /// Longest string of each node with the fewest repetitions and the shortest alternatives,
+    /// measured the first time a string falls back to them.
+    std::unordered_map<const ASTNode *, std::size_t> shortest_;
+    std::vector<Task> tasks_;
     std::string generated_string_;
-    std::mt19937 engine_{std::random_device{}()};
-    std::unordered_map<const GroupNode *, std::string> group_generated_;
+    BitReservoir<GeneratorEngine> random_;
+    std::uint64_t random_draws_{0};
+    Profile *profile_{nullptr};
+    std::vector<Capture> captures_; ///< captures indexed by group number
+    Sink *sink_{nullptr};           ///< where the string is streamed, `nullptr` if it is returned
+    std::size_t streamed_{0};       ///< bytes of the string written to the sink
+    std::vector<OpenGroup> open_groups_;     ///< referenced groups that are open while streaming
+    std::vector<std::string> capture_texts_; ///< texts of captures while streaming
 };
 
 } // namespace strex
@@ -13,7 +13,7 @@
 namespace strex {
 
 /// Split the raw regular expression into tokens.
-/// Use ECMAScript flavor.
+/// Use ECMAScript flavor. The regular expression is UTF-8, a character token is a code point.
 class Lexer {
  public:
     explicit Lexer(std::string regex);
@@ -22,9 +22,9 @@ class Lexer {
     std::vector<Token> tokenize();
 
  private:
-    /// Check group count in regular expression.
-    /// Throws exception if there are unmatched parentheses.
-    void scan_groups();
+    /// Counts capture groups in the regular expression without tokenizing it.
+    /// The count is needed to tell a backreference from an octal escape.
+    int count_groups() const;
 
     /// Returns the next token.
     Token next_token();
@@ -89,6 +89,9 @@ class Lexer {
     /// Checks if the character is valid, returns a token with type `Character`.
     Token character(char ch);
 
+    /// Decodes the UTF-8 sequence whose first byte has just been consumed.
+    char32_t utf8_character();
+
     /// Processes a word boundary (`\b`, `\B`).
     /// If `\b` is in a charset, it will be treated as a character with ASCII 8,
     Token word_boundary(char ch);
@@ -101,6 +104,18 @@ class Lexer {
     /// Returns a token with type `Character`.
     Token hex_number(char prev, int digit);
 
+    /// Consumes `digit` hex digits and returns their value, or returns -1 without consuming
+    /// anything if there are fewer digits.
+    int hex_digits(int digit);
+
+    /// Processes the code point of `\u{...}`.
+    /// Returns a token with type `Character`.
+    Token braced_code_point();
+
+    /// Processes a unicode property after `\p` or `\P`, e.g., `\p{L}`.
+    /// Returns a token with type `Char_Class` or `Character`.
+    Token property(char ch);
+
     /// Returns a token with type `Character` or `Repeat`.
     Token repeat();
 
@@ -119,8 +134,8 @@ class Lexer {
     /// Processes a character class, e.g., `\d`, `\w`, `\s`.
     Token make_char_class(char ch) const;
 
-    /// Returns a token with type `Character` and given character.
-    Token make_character(char ch) const;
+    /// Returns a token with type `Character` and given code point.
+    Token make_character(char32_t code_point) const;
 
     /// Returns a token with type `Backreference`.
     Token make_backreference(int group_number) const;
@@ -134,9 +149,6 @@ class Lexer {
     /// Returns text range of the token being processed.
     TextRange make_token_range() const;
 
-    /// Returns the previous token that has been processed.
-    const Token &prev_token() const;
-
     /// Returns the character in current position, not move forward.
     char peek() const;
 
@@ -150,10 +162,9 @@ class Lexer {
     std::string regex_;                         ///< regular expression to be tokenized
     std::size_t current_position_{0};           ///< current processing position
     std::size_t token_begin_position_{0};       ///< begin position of the token being processed
-    const std::vector<Token> *tokens_{nullptr}; ///< tokens that has been processed
-    int group_count_{0};                        ///< the count of group that has been processed
+    TokenType previous_type_{TokenType::Error}; ///< type of previous token, `Error` if none
+    int group_count_{0};                        ///< the count of groups in regular expression
     bool in_charset_{false};                    ///< if current token is in a charset
-    bool has_preprocessed_{false};              ///< if the regular expression has been preprocessed
 };
 
 } // namespace strex
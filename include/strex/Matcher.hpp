@@ -0,0 +1,90 @@
+/// @file
+
+#ifndef NEROLL_STREX_MATCHER_HPP
+#define NEROLL_STREX_MATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <strex/Program.hpp>
+
+namespace strex {
+
+class ASTNode;
+class ParsedRegex;
+
+/// Checks if whole strings match a regular expression, used to verify generated strings.
+/// The AST is compiled to a `Program` of NFA instructions.
+/// Patterns without backreferences run as a lazy DFA: a DFA state is a set of NFA instructions,
+/// built the first time a string reaches it and cached, so matching costs one table lookup per
+/// byte once the cache is warm. Patterns with backreferences, anchors or lookarounds are matched
+/// by backtracking.
+/// A matcher caches DFA states, so each thread needs its own matcher.
+class Matcher {
+ public:
+    /// Matches every string of `regex`, with the branches that generation prunes because they
+    /// have no printable character.
+    explicit Matcher(const ParsedRegex &regex);
+
+    explicit Matcher(const ASTNode *ast);
+
+    /// Checks if the whole `text` matches the regular expression.
+    bool matches(std::string_view text);
+
+ private:
+    /// A set of `Byte` and `Match` instructions, sorted.
+    struct DFAState {
+        std::vector<std::uint32_t> instructions;
+        bool is_accepting; ///< if the set has `Match`
+    };
+
+    struct InstructionsHash {
+        std::size_t operator()(const std::vector<std::uint32_t> &instructions) const;
+    };
+
+    constexpr static std::int32_t unknown_state = -1;
+    constexpr static std::int32_t dead_state = 0;
+
+    /// DFA states are dropped when the cache grows beyond this, and rebuilt on demand.
+    constexpr static std::size_t max_dfa_states = 4096;
+
+    bool dfa_matches(std::string_view text);
+
+    /// Returns the DFA state reached from `state` by `byte`, builds it if it is not cached.
+    std::int32_t transition(std::int32_t state, unsigned char byte);
+
+    /// Returns the id of a DFA state, adds it to the cache if it is new.
+    std::int32_t dfa_state(std::vector<std::uint32_t> instructions);
+
+    /// Adds the `Byte` and `Match` instructions reachable from `start` without consuming a byte
+    /// to `closure`, instructions visited in the same generation are skipped.
+    void add_closure(std::uint32_t start, std::vector<std::uint32_t> &closure);
+
+    /// Drops all cached DFA states except the dead state and the start state.
+    void reset_dfa();
+
+    /// Runs a thread from `pc` at `position` by backtracking.
+    /// The thread succeeds at `Match` if the whole string is consumed, or at `Look_End` if
+    /// `end` is `std::string_view::npos` or the position is `end`.
+    bool backtrack(std::string_view text, std::uint32_t pc, std::size_t position,
+                   std::size_t end, std::vector<std::size_t> registers) const;
+
+    Program program_;
+    bool is_backtracking_; ///< if the program needs backtracking
+
+    std::vector<DFAState> dfa_states_;
+    std::vector<std::int32_t> dfa_transitions_; ///< `UCHAR_MAX + 1` entries per DFA state
+    std::unordered_map<std::vector<std::uint32_t>, std::int32_t, InstructionsHash> dfa_ids_;
+    std::int32_t start_state_{dead_state};
+
+    std::vector<std::uint32_t> visited_;  ///< generation when an instruction was last visited
+    std::uint32_t visit_generation_{0};
+    std::vector<std::uint32_t> pending_; ///< work list of `add_closure`
+};
+
+} // namespace strex
+
+#endif
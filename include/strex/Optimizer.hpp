@@ -0,0 +1,97 @@
+#ifndef NEROLL_STREX_OPTIMIZER_HPP
+#define NEROLL_STREX_OPTIMIZER_HPP
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <strex/AST.hpp>
+
+namespace strex {
+
+/// A rewrite of the AST that keeps the set of generated strings.
+/// Passes run after parsing and before generation, so `Generator` visits fewer nodes.
+class Pass {
+ public:
+    virtual ~Pass() {}
+
+    virtual std::string_view name() const = 0;
+
+    /// Rewrites the AST in place, `ast` may be replaced by another node.
+    virtual void run(std::unique_ptr<ASTNode> &ast) = 0;
+};
+
+/// Splices nested `SequenceNode`s into their parent, `(ab)c` without groups becomes `abc`.
+/// A sequence with only one element is replaced by the element.
+class FlattenSequencesPass : public Pass {
+ public:
+    std::string_view name() const override { return "flatten-sequences"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Replaces an alternation of distinct printable characters, like `a|b|c`, with a `CharsetNode`.
+class MergeCharAlternationsPass : public Pass {
+ public:
+    std::string_view name() const override { return "merge-char-alternations"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Removes `TextNode("")` from sequences, and repetitions of empty text.
+class RemoveEmptyTextPass : public Pass {
+ public:
+    std::string_view name() const override { return "remove-empty-text"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Replaces `RepeatNode{1,1}` with its content.
+class CollapseUnitRepeatsPass : public Pass {
+ public:
+    std::string_view name() const override { return "collapse-unit-repeats"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Replaces groups that no backreference uses with their content.
+class StripUnusedGroupsPass : public Pass {
+ public:
+    std::string_view name() const override { return "strip-unused-groups"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Removes alternatives that can not generate a matching string, because they require a
+/// charset that has no printable character, like `[^\x20-\x7e]`.
+/// Backreferences to groups in removed alternatives become empty text.
+class PruneDeadBranchesPass : public Pass {
+ public:
+    std::string_view name() const override { return "prune-dead-branches"; }
+
+    void run(std::unique_ptr<ASTNode> &ast) override;
+};
+
+/// Runs passes in the order they are added.
+class PassManager {
+ public:
+    /// Returns a manager with all passes in the recommended order.
+    static PassManager default_pipeline();
+
+    /// Returns a manager with the passes that keep the strings the regex matches, for `Matcher`.
+    /// It is the default pipeline without `PruneDeadBranchesPass`.
+    static PassManager matching_pipeline();
+
+    PassManager &add(std::unique_ptr<Pass> pass);
+
+    void run(std::unique_ptr<ASTNode> &ast) const;
+
+    const std::vector<std::unique_ptr<Pass>> &passes() const { return passes_; }
+
+ private:
+    std::vector<std::unique_ptr<Pass>> passes_;
+};
+
+} // namespace strex
+
+#endif
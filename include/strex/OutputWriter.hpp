@@ -0,0 +1,76 @@
+/// @file
+
+#ifndef NEROLL_STREX_OUTPUT_WRITER_HPP
+#define NEROLL_STREX_OUTPUT_WRITER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include <strex/Sink.hpp>
+
+namespace strex {
+
+/// Buffered writer to a file descriptor, for output of several GB/s.
+/// Output is gathered in a page-aligned buffer and written with `write(2)`, which copies it, so
+/// the buffer is reused.
+///
+/// With `Mode::Vmsplice`, a full buffer is mapped into a pipe with `vmsplice(2)` instead, and its
+/// pages are gifted. The pipe then refers to those pages until the reader is done with them,
+/// which may be long after it read them if it moves them on with `splice(2)` or `tee(2)`. A
+/// spliced buffer is therefore never written again: it is unmapped and the next one gets fresh
+/// pages. Fresh pages cost more than the copy saved for most readers, so it is opt-in.
+class OutputWriter : public Sink {
+ public:
+    enum class Mode {
+        Write,   ///< `write(2)`, for files, terminals and systems without `vmsplice(2)`
+        Vmsplice ///< `vmsplice(2)` into a pipe
+    };
+
+    /// Buffer size with `Mode::Write`, and the pipe size that `Mode::Vmsplice` asks for.
+    constexpr static std::size_t default_buffer_size = 1 << 20;
+
+    /// Writes with `Mode::Write`.
+    explicit OutputWriter(int fd);
+
+    /// @throw GenerateError if `mode` is `Mode::Vmsplice` and `fd` is not a pipe
+    OutputWriter(int fd, Mode mode);
+
+    /// Writes what is buffered, errors are ignored, call `flush` to see them.
+    ~OutputWriter() override;
+
+    OutputWriter(const OutputWriter &) = delete;
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    /// Buffers `text`, and writes buffers that are full.
+    /// @throw GenerateError if the descriptor cannot be written
+    void write(std::string_view text) override;
+
+    /// Writes what is buffered.
+    /// @throw GenerateError if the descriptor cannot be written
+    void flush();
+
+    Mode mode() const { return mode_; }
+
+    std::size_t buffer_size() const { return buffer_size_; }
+
+ private:
+    /// Frees pages allocated for a buffer of `size` bytes.
+    struct PageDelete {
+        std::size_t size;
+        void operator()(char *pages) const;
+    };
+
+    /// Writes the current buffer, which is full.
+    void write_full_buffer();
+
+    int fd_;
+    Mode mode_;
+    std::size_t buffer_size_;
+    std::unique_ptr<char, PageDelete> buffer_;
+    std::size_t used_{0}; ///< bytes in `buffer_`
+};
+
+} // namespace strex
+
+#endif
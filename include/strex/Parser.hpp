@@ -4,10 +4,15 @@
 #include <memory>
 #include <span>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <strex/AST.hpp>
+#include <strex/Charset.hpp>
+#include <strex/GenerationOptions.hpp>
+#include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
+#include <strex/Unicode.hpp>
 
 namespace strex {
 
@@ -16,48 +21,78 @@ namespace strex {
 /// @see https://en.cppreference.com/w/cpp/regex/ecmascript
 class Parser {
  public:
-    explicit Parser(std::span<const Token> tokens);
+    /// @param max_repeat upper bound of `*` and `+`, and repetitions above the lower bound of
+    /// `{n,}`
+    explicit Parser(std::span<const Token> tokens,
+                    int max_repeat = GenerationOptions::default_max_repeat);
 
     /// Build an AST.
     std::unique_ptr<ASTNode> parse();
 
  private:
-    /// Returns a TextNode`, `CharsetNode`, `GroupNode`, `RepeatNode` or `AlternationNode`.
-    std::unique_ptr<ASTNode> alternative();
+    /// A disjunction being parsed, either the whole pattern or the content of a group.
+    /// Frames are kept on an explicit stack instead of the call stack, so the nesting depth of
+    /// a pattern is only limited by memory.
+    struct Frame {
+        std::vector<std::unique_ptr<ASTNode>> alternatives; ///< alternatives that are complete
+        std::vector<std::unique_ptr<ASTNode>> terms;        ///< terms of current alternative
+        TextRange disjunction_range; ///< range of the first token and all `|` in disjunction
+        TextRange sequence_start;    ///< range of the first token of current alternative
+        TextRange sequence_end;      ///< range of the last token of current alternative
+        TextRange group_start;       ///< range of `(` and its extension, not used by the whole
+                                     ///< pattern
+        TokenType group_type;        ///< extension after `(`, such as `Non_Capturing_Group`,
+                                     ///< `Left_Paren` for capture groups and the whole pattern
+        int group_index;             ///< index of capture group, 0 for others
+    };
+
+    /// Pushes a frame for a disjunction that starts from current token.
+    void open_frame(const TextRange &group_start, TokenType group_type, int group_index = 0);
+
+    /// Pops the frame of current group and returns a `GroupNode` or a `LookaroundNode`.
+    /// Returns the content directly if the group is non-capturing.
+    std::unique_ptr<ASTNode> close_group();
+
+    /// Appends a term to current alternative, wraps it with the quantifier after it if any.
+    void append_term(std::unique_ptr<ASTNode> atom);
 
     /// Returns a `SequenceNode` if there is a sequence with more than one element.
     /// Returns a `TextNode`, `CharsetNode`, `GroupNode` or `RepeatNode` if there is only one element.
-    std::unique_ptr<ASTNode> sequence();
+    std::unique_ptr<ASTNode> finish_sequence(Frame &frame);
 
-    /// Return a `TextNode`, `CharsetNode`, `GroupNode` or `RepeatNode`.
-    std::unique_ptr<ASTNode> term();
+    /// Returns a `AlternationNode` if there is more than one alternative.
+    /// Returns the result of `finish_sequence` if there is only one alternative.
+    std::unique_ptr<ASTNode> finish_disjunction(Frame &frame);
 
-    /// Return a `TextNode`, `CharsetNode` or `GroupNode`.
+    /// Return a `TextNode`, `CharsetNode` or `BackrefNode`.
+    /// Groups are handled by `parse` directly.
     std::unique_ptr<ASTNode> atom();
 
     /// Returns a `RepeatNode`.
     std::unique_ptr<ASTNode> quantifier(std::unique_ptr<ASTNode> content);
 
-    /// Returns a `GroupNode`.
-    std::unique_ptr<ASTNode> group();
-
     /// Returns a `CharsetNode`.
     std::unique_ptr<ASTNode> charset();
 
     /// Returns a `BackrefNode`.
     std::unique_ptr<ASTNode> backreference();
 
-    /// Returns all characters in character set.
-    std::string charset_item_list();
+    /// Returns code points in character set, and the ones generated from it.
+    std::pair<Charset::Ranges, Charset::Ranges> charset_item_list();
 
     /// Checks if meets character range.
-    bool is_char_range();
+    bool is_char_range() const;
+
+    /// Returns the code points in a character range.
+    CodePointRange char_range();
 
-    /// Returns all characters in a character range.
-    std::string char_range();
+    /// Returns the charset of a `Char_Class` token.
+    static const Charset *char_class_charset(const Token &token);
 
     bool is_atom(TokenType type) const;
 
+    bool is_lookaround(TokenType type) const;
+
     bool is_quantifier(TokenType type) const;
 
     const Token &consume(TokenType expect, std::string_view message);
@@ -72,6 +107,9 @@ class Parser {
     /// Returns the token in current position, not move forward.
     const Token &peek() const;
 
+    /// Returns the token `offset` tokens after current position, not move forward.
+    const Token &peek(std::size_t offset) const;
+
     /// Returns the token that in previous position.
     const Token &previous() const;
 
@@ -82,16 +120,12 @@ class Parser {
     /// @return Whether Parser reaches the end or not.
     bool is_end() const;
 
-    // TODO Maybe can be given in command line arguments.
-    constexpr static int default_max_repeat_count = 3;
-
-    /// Max count of groups.
-    // TODO Maybe can be given in command line arguments.
-    constexpr static int max_group_number = 255;
-
     std::span<const Token> tokens_;            ///< tokens to be processed
-    std::size_t current_position_{0};          ///< a
-    std::vector<GroupNode *> groups_{nullptr}; ///< groups that has been processed
+    int max_repeat_;                           ///< bound of open-ended quantifiers
+    std::size_t current_position_{0};          ///< current processing position
+    std::vector<Frame> frames_;                ///< disjunctions that are being parsed
+    std::vector<GroupNode *> groups_{nullptr}; ///< groups indexed by group number,
+                                               ///< `nullptr` until the group is closed
 };
 
 } // namespace strex
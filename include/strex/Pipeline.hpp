@@ -0,0 +1,148 @@
+/// @file
+/// Output stage that moves blocks from generator threads to a single writer.
+
+#ifndef NEROLL_STREX_PIPELINE_HPP
+#define NEROLL_STREX_PIPELINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace strex {
+
+class Sink;
+
+/// Bounded lock-free queue between one producer thread and one consumer thread.
+/// Each side caches the index of the other, so the shared indices are only read when the queue
+/// looks full or empty.
+template <typename T>
+class SpscRing {
+ public:
+    /// Holds up to `capacity` items, rounded up to a power of two.
+    explicit SpscRing(std::size_t capacity)
+        : slots_(std::bit_ceil(std::max<std::size_t>(capacity, 1))) {}
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /// Adds `item` at the back, called by the producer. Returns false if the ring is full.
+    bool push(T item) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == slots_.size())
+                return false;
+        }
+        slots_[tail & (slots_.size() - 1)] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Moves the front item into `item`, called by the consumer. Returns false if the ring is
+    /// empty.
+    bool pop(T &item) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+                return false;
+        }
+        item = std::move(slots_[head & (slots_.size() - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return slots_.size(); }
+
+ private:
+    constexpr static std::size_t cache_line = 64;
+
+    std::vector<T> slots_;
+    alignas(cache_line) std::atomic<std::size_t> head_{0}; ///< next item to pop
+    std::size_t tail_cache_{0};                            ///< `tail_` last seen by the consumer
+    alignas(cache_line) std::atomic<std::size_t> tail_{0}; ///< next slot to push
+    std::size_t head_cache_{0};                            ///< `head_` last seen by the producer
+};
+
+/// Generator threads fill blocks of output and a single writer writes them to a `Sink`, so
+/// threads never take a lock to write. Each worker owns a fixed set of blocks, which go to the
+/// writer through a `SpscRing` and come back through another once written. Memory is bounded by
+/// `workers * blocks_per_worker` blocks, and a worker waits while all its blocks are queued for
+/// the writer. Blocks keep their capacity when reused, so no memory is allocated once they have
+/// grown to the size of the output put in them.
+///
+/// A worker with no free block and a writer with no filled block sleep in `std::atomic::wait`,
+/// and are woken by the other side when it passes a block.
+///
+/// Block `index` is filled by worker `index % workers`, and the blocks of a worker are filled in
+/// order. The writer can then restore the order of indices by taking blocks from the workers in
+/// turn, without a reorder buffer.
+class Pipeline {
+ public:
+    struct Options {
+        std::size_t workers{1};
+        std::size_t blocks_per_worker{4};
+        std::size_t block_size{256 * 1024}; ///< initial capacity of a block
+        bool ordered{false};                ///< write blocks in the order of their indices
+    };
+
+    struct Block {
+        std::uint64_t index;
+        std::string data;
+    };
+
+    /// Appends the output of block `block.index` to `block.data`, which is empty, on thread
+    /// `worker`. Returns false if there is no such block, then no later block is asked from that
+    /// worker. Once it returns false for an index, it must return false for every greater one.
+    using Producer = std::function<bool(std::size_t worker, Block &block)>;
+
+    /// @throw std::invalid_argument if there are no workers or no blocks
+    explicit Pipeline(const Options &options);
+
+    ~Pipeline();
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    /// Runs `workers` threads that fill blocks with `produce`, and writes the blocks to `sink`
+    /// on the calling thread, until every worker is done. Can be called again.
+    /// @throw the first exception of `produce` or `sink`, after all threads stopped
+    void run(const Producer &produce, Sink &sink);
+
+    const Options &options() const { return options_; }
+
+ private:
+    struct Lane;
+
+    /// Fills the blocks of `worker` until `produce` returns false.
+    void work(const Producer &produce, std::size_t worker);
+
+    /// Writes blocks as workers fill them, until all are done.
+    void write(Sink &sink);
+
+    /// Sets `stopped_`, keeps the first error and wakes every thread.
+    void fail(std::exception_ptr error);
+
+    /// Wakes the writer after a block was filled or a worker is done.
+    void signal_filled();
+
+    Options options_;
+    std::vector<Block> blocks_;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::atomic<bool> stopped_{false};            ///< set when a thread failed, the others stop
+    std::atomic<bool> has_error_{false};
+    std::atomic<std::uint32_t> filled_signal_{0}; ///< bumped by `signal_filled`, the writer waits
+    std::exception_ptr error_;
+};
+
+} // namespace strex
+
+#endif
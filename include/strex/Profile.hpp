@@ -0,0 +1,63 @@
+/// @file
+
+#ifndef NEROLL_STREX_PROFILE_HPP
+#define NEROLL_STREX_PROFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <strex/TextRange.hpp>
+
+namespace strex {
+
+class ASTNode;
+class ParsedRegex;
+
+/// Cost of generation attributed to each AST node.
+/// Visits and bytes are exact. Time is sampled, `Generator` times one of every
+/// `sample_interval` steps and scales it, so profiling is cheap enough for large jobs.
+class Profile {
+    friend class Generator;
+
+ public:
+    /// Cost of a node.
+    struct Node {
+        const ASTNode *node;
+        TextRange range;          ///< range of the node in the regular expression
+        std::size_t depth;        ///< depth of the node in the AST, 0 for the root
+        std::uint64_t visits{0};  ///< times the node is generated
+        std::uint64_t bytes{0};   ///< bytes generated by the node and its children
+        std::uint64_t self_ns{0}; ///< sampled time spent in the node, without its children
+    };
+
+    constexpr static std::uint64_t sample_interval = 64;
+
+    explicit Profile(const ParsedRegex &regex);
+
+    explicit Profile(const ASTNode *ast);
+
+    /// Returns nodes in pre-order.
+    const std::vector<Node> &nodes() const { return nodes_; }
+
+    /// Returns sampled time spent in all nodes.
+    std::uint64_t total_ns() const;
+
+    /// Returns a line of the same width as `regex` that shows where time is spent.
+    /// Time of a node is spread over its range, denser characters mean more time.
+    std::string heat_map(std::string_view regex) const;
+
+ private:
+    Node &at(const ASTNode *node) { return nodes_[indices_.at(node)]; }
+
+    std::vector<Node> nodes_;
+    std::unordered_map<const ASTNode *, std::size_t> indices_;
+    std::uint64_t steps_{0}; ///< steps of generation, decides which step is timed
+};
+
+} // namespace strex
+
+#endif
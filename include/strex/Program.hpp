@@ -0,0 +1,84 @@
+/// @file
+
+#ifndef NEROLL_STREX_PROGRAM_HPP
+#define NEROLL_STREX_PROGRAM_HPP
+
+#include <bitset>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace strex {
+
+class ASTNode;
+
+/// Operations of NFA instructions.
+enum class OpCode : std::uint8_t {
+    Byte,         ///< consumes a byte in byte set `operand`
+    Split,        ///< continues at `target` and `operand`, `target` is preferred
+    Jump,         ///< continues at `target`
+    Save,         ///< records the position in register `operand`
+    Backref,      ///< consumes the text between registers `operand` and `operand + 1`
+    Loop_Check,   ///< fails if the position is still the one in register `operand`
+    Look,         ///< checks lookaround `operand`, whose body follows, then continues at `target`
+    Look_End,     ///< ends the body of lookaround `operand`
+    Assert_Begin, ///< fails unless at the beginning of the string
+    Assert_End,   ///< fails unless at the end of the string
+    Match         ///< accepts if the whole string is consumed
+};
+
+struct Instruction {
+    OpCode op;
+    std::uint32_t target{0};
+    std::uint32_t operand{0};
+};
+
+/// A lookaround, its body is the instructions between its `Look` and `Look_End`.
+struct Lookaround {
+    std::uint32_t pc; ///< the `Look` instruction
+    bool is_lookbehind;
+    bool is_negative;
+};
+
+/// NFA instructions compiled from an AST, shared by `Matcher` and `Automaton`.
+/// Bounded repetitions are unrolled, open-ended repetitions become loops.
+class Program {
+ public:
+    using ByteSet = std::bitset<UCHAR_MAX + 1>;
+
+    /// Unrolled repetitions beyond this size are rejected.
+    constexpr static std::size_t max_size = 1 << 22;
+
+    /// @throw SyntaxNotSupport if the program is larger than `max_size`
+    explicit Program(const ASTNode *ast);
+
+    const std::vector<Instruction> &instructions() const { return instructions_; }
+
+    const std::vector<ByteSet> &byte_sets() const { return byte_sets_; }
+
+    const std::vector<Lookaround> &lookarounds() const { return lookarounds_; }
+
+    /// Returns the number of registers, capture slots of groups and iteration starts of loops.
+    std::size_t registers() const { return registers_; }
+
+    bool has_backref() const { return has_backref_; }
+
+    /// Checks if the program has anchors or lookarounds.
+    bool has_assertion() const { return has_assertion_; }
+
+ private:
+    /// Builds the program from an AST.
+    class Compiler;
+
+    std::vector<Instruction> instructions_;
+    std::vector<ByteSet> byte_sets_;
+    std::vector<Lookaround> lookarounds_;
+    std::size_t registers_{0};
+    bool has_backref_{false};
+    bool has_assertion_{false};
+};
+
+} // namespace strex
+
+#endif
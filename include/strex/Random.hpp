@@ -0,0 +1,157 @@
+/// @file
+/// Small random engines for bulk generation.
+
+#ifndef NEROLL_STREX_RANDOM_HPP
+#define NEROLL_STREX_RANDOM_HPP
+
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace strex {
+
+/// SplitMix64, a fast engine with 64 bits of state, satisfies `UniformRandomBitGenerator`.
+class SplitMix64 {
+ public:
+    using result_type = std::uint64_t;
+
+    /// The increment of the state, engines seeded this far apart give independent streams.
+    constexpr static std::uint64_t gamma = 0x9E3779B97F4A7C15;
+
+    constexpr explicit SplitMix64(std::uint64_t seed) : state_(seed) {}
+
+    /// Returns the output of a state.
+    constexpr static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    constexpr static result_type min() { return 0; }
+
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() { return mix(state_ += gamma); }
+
+ private:
+    std::uint64_t state_;
+};
+
+/// xoshiro256** in `lanes` interleaved streams, which produces randomness a block at a time.
+/// The streams are stepped together, so a refill is a loop over lanes that runs in vector
+/// registers. The fill kernel is the one of `cpu::active()`.
+class BlockEngine {
+ public:
+    using result_type = std::uint32_t;
+
+    /// Number of interleaved streams.
+    constexpr static std::size_t lanes = 8;
+
+    /// Number of words in a block, 4 KB.
+    constexpr static std::size_t block_words = 1024;
+
+    /// Seeds the engine from `std::random_device`.
+    BlockEngine();
+
+    /// Seeds the streams from `SplitMix64` of `seed`.
+    explicit BlockEngine(std::uint64_t seed);
+
+    constexpr static result_type min() { return 0; }
+
+    constexpr static result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (position_ == block_words)
+            refill();
+        return block_[position_++];
+    }
+
+    /// Returns `count` random words, which are valid until the next call.
+    /// `count` must be at most `block_words`.
+    const result_type *take(std::size_t count) {
+        assert(count <= block_words);
+        if (block_words - position_ < count)
+            refill();
+        const result_type *words = block_.data() + position_;
+        position_ += count;
+        return words;
+    }
+
+ private:
+    /// Generates the next block.
+    void refill();
+
+    /// Word `i` of the state of lane `j` is at `i * lanes + j`.
+    alignas(64) std::array<std::uint64_t, 4 * lanes> state_{};
+    alignas(64) std::array<result_type, block_words> block_{};
+    std::size_t position_{block_words};
+};
+
+/// Returns a value in [0, `bound`) from 32 random bits by Lemire's multiply-shift, or `bound` if
+/// the product is biased and the caller has to draw again.
+constexpr std::uint32_t reduce(std::uint32_t bits, std::uint32_t bound) {
+    std::uint64_t product = static_cast<std::uint64_t>(bits) * bound;
+    auto low = static_cast<std::uint32_t>(product);
+    // Products whose low half is below `2^32 % bound` are the extra ones of some values.
+    if (low < bound && low < -bound % bound)
+        return bound;
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+/// Hands out uniform values in small ranges while taking only the entropy they need from the
+/// engine, so choosing a digit costs about 3.3 bits instead of a whole engine output.
+/// The reservoir is a value uniform in [0, range). A draw splits it into the result and a smaller
+/// uniform value that is carried to later draws, and 32 bits are shifted in when the range gets
+/// below 2^32.
+template <std::uniform_random_bit_generator Engine>
+class BitReservoir {
+    static_assert(Engine::min() == 0 && Engine::max() >= std::numeric_limits<std::uint32_t>::max(),
+                  "the engine must give at least 32 random bits");
+
+ public:
+    explicit BitReservoir(Engine engine) : engine_(std::move(engine)) {}
+
+    /// Returns a uniform value in [0, `bound`), `bound` must be positive.
+    std::uint32_t operator()(std::uint32_t bound) {
+        assert(bound > 0);
+        if (bound == 1)
+            return 0;
+        while (true) {
+            if (range_ <= std::numeric_limits<std::uint32_t>::max()) {
+                value_ = value_ << 32 | static_cast<std::uint32_t>(engine_());
+                range_ <<= 32;
+                engine_calls_++;
+            }
+            // [0, limit) holds `quotient` values for each result, the rest would bias the result.
+            std::uint64_t quotient = range_ / bound;
+            std::uint64_t limit = quotient * bound;
+            if (value_ < limit) {
+                auto result = static_cast<std::uint32_t>(value_ / quotient);
+                value_ %= quotient;
+                range_ = quotient;
+                return result;
+            }
+            // A rejected value is still uniform in [limit, range), which is kept.
+            value_ -= limit;
+            range_ -= limit;
+        }
+    }
+
+    /// Returns the number of engine outputs consumed since construction.
+    std::uint64_t engine_calls() const { return engine_calls_; }
+
+ private:
+    Engine engine_;
+    std::uint64_t value_{0};
+    std::uint64_t range_{1};
+    std::uint64_t engine_calls_{0};
+};
+
+} // namespace strex
+
+#endif
@@ -0,0 +1,48 @@
+/// @file
+
+#ifndef NEROLL_STREX_SINK_HPP
+#define NEROLL_STREX_SINK_HPP
+
+#include <functional>
+#include <string_view>
+#include <utility>
+
+namespace strex {
+
+/// Receives a generated string in chunks, for strings too large to hold in memory.
+class Sink {
+ public:
+    virtual ~Sink() = default;
+
+    /// Takes the next chunk, `text` is only valid during the call.
+    virtual void write(std::string_view text) = 0;
+};
+
+/// Writes chunks to a file descriptor.
+class FdSink : public Sink {
+ public:
+    /// The descriptor is not closed by the sink.
+    explicit FdSink(int fd) : fd_(fd) {}
+
+    /// @throw GenerateError if the descriptor cannot be written
+    void write(std::string_view text) override;
+
+ private:
+    int fd_;
+};
+
+/// Passes chunks to a function.
+class CallbackSink : public Sink {
+ public:
+    explicit CallbackSink(std::function<void(std::string_view)> callback)
+        : callback_(std::move(callback)) {}
+
+    void write(std::string_view text) override { callback_(text); }
+
+ private:
+    std::function<void(std::string_view)> callback_;
+};
+
+} // namespace strex
+
+#endif
@@ -0,0 +1,83 @@
+/// @file
+
+#ifndef NEROLL_STREX_SKELETON_HPP
+#define NEROLL_STREX_SKELETON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <strex/Random.hpp>
+
+namespace strex {
+
+class ASTNode;
+
+/// Fast path for patterns of fixed length and structure, like UUIDs, MAC addresses and dates.
+/// Literals are laid out once in a byte template, and a string is the template with its random
+/// slots filled from charset tables, so generation is a `memcpy` and a loop over slots.
+/// Consecutive slots of one charset are a run, which is filled by the `charset_run` kernel of
+/// `cpu::active()`.
+class Skeleton {
+ public:
+    /// Returns the skeleton of a pattern, `nullptr` if it has alternations, variable repetitions,
+    /// non-ASCII charsets or lookarounds, or is longer than `max_width`.
+    static std::unique_ptr<Skeleton> compile(const ASTNode *ast);
+
+    /// The longest template, longer patterns are not worth a template.
+    constexpr static std::size_t max_width = 1 << 16;
+
+    /// Returns the length of every generated string.
+    std::size_t width() const { return template_.size(); }
+
+    /// Returns the template, the bytes of slots are unspecified.
+    const std::string &skeleton() const { return template_; }
+
+    /// Returns the number of random slots.
+    std::size_t slot_count() const { return slot_count_; }
+
+    /// Writes `count` strings into `out`, string `i` at `out + i * stride`.
+    /// Bytes between strings are not written, `stride` must be at least `width()`.
+    void fill(char *out, std::size_t count, std::size_t stride);
+
+    /// Returns a generated string.
+    std::string generate();
+
+    /// Returns the number of random choices since construction, like `Generator::random_draws`.
+    std::uint64_t random_draws() const { return random_draws_; }
+
+ private:
+    /// `length` bytes chosen from the `size` bytes at `table` of `tables_`, written from `offset`.
+    /// A run is at most `BlockEngine::block_words` long, so its words are taken at once.
+    struct Run {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t table;
+        std::uint32_t size;
+    };
+
+    /// A backreference, copies `length` bytes from `source` to `offset` after runs before it
+    /// are filled.
+    struct Copy {
+        std::uint32_t offset;
+        std::uint32_t source;
+        std::uint32_t length;
+        std::uint32_t runs; ///< number of runs filled before the copy
+    };
+
+    Skeleton() = default;
+
+    std::string template_;
+    std::vector<Run> runs_;
+    std::size_t slot_count_{0};
+    std::vector<Copy> copies_;
+    std::string tables_; ///< characters of distinct charsets of slots, one after another
+    BlockEngine engine_;
+    std::uint64_t random_draws_{0};
+};
+
+} // namespace strex
+
+#endif
@@ -0,0 +1,769 @@
+/// @file
+
+#ifndef NEROLL_STREX_STATIC_REGEX_HPP
+#define NEROLL_STREX_STATIC_REGEX_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <strex/Token.hpp>
+
+namespace strex {
+
+/// A string literal that can be used as a template argument.
+template <std::size_t N>
+struct FixedString {
+    constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, data); } // NOLINT
+
+    constexpr std::string_view view() const { return {data, N - 1}; }
+
+    char data[N]{};
+};
+
+namespace detail {
+
+/// Reports an invalid pattern of `StaticRegex`.
+/// It is deliberately not `constexpr`, so reaching it during constant evaluation makes the
+/// compiler reject the pattern and point at the reason passed in.
+inline void static_regex_error(const char *reason) {
+    (void)reason;
+}
+
+/// Types of nodes in a compile-time generation plan, one for each `ASTNode` subclass.
+enum class StaticNodeType {
+    Text,
+    Charset,
+    Sequence,
+    Repeat,
+    Group,
+    Alternation,
+    Backref,
+};
+
+/// A node of the compile-time generation plan.
+struct StaticNode {
+    StaticNodeType type{StaticNodeType::Text};
+    int first{0};  ///< first character, first child, content node, charset index or group number
+    int count{0};  ///< count of characters or children
+    int lower{0};  ///< minimum times of repetition
+    int upper{0};  ///< maximum times of repetition
+    int group{-1}; ///< capture index of group
+};
+
+/// Printable characters of a charset, these are the only characters generated from it.
+struct StaticCharset {
+    std::array<char, 95> characters{};
+    int size{0};
+
+    constexpr bool operator==(const StaticCharset &other) const = default;
+};
+
+/// Sizes of the tables in a compile-time generation plan.
+struct StaticSizes {
+    std::size_t nodes;
+    std::size_t children;
+    std::size_t text;
+    std::size_t charsets;
+    std::size_t groups;
+};
+
+/// Flattened generation plan of a regular expression, every table is a constant.
+template <StaticSizes Sizes>
+struct StaticProgram {
+    std::array<StaticNode, Sizes.nodes> nodes{};
+    std::array<int, Sizes.children> children{};
+    std::array<char, Sizes.text> text{};
+    std::array<StaticCharset, Sizes.charsets> charsets{};
+    std::array<bool, Sizes.groups + 1> referenced{}; ///< if a group is used by a backreference
+    int root{0};
+};
+
+/// Token produced by `StaticLexer`, the compile-time counterpart of `Token`.
+struct StaticToken {
+    TokenType type{TokenType::Error};
+    char character{'\0'};
+    int repeat_lower{-1};
+    int repeat_upper{-1};
+    int group_number{-1};
+};
+
+/// Compile-time twin of `Lexer`, tokenizes the regular expression in the same way.
+class StaticLexer {
+ public:
+    constexpr explicit StaticLexer(std::string_view regex) : regex_(regex) {}
+
+    constexpr std::vector<StaticToken> tokenize() {
+        group_count_ = count_groups();
+        tokens_.clear();
+        StaticToken token = next_token();
+        while (token.type != TokenType::End) {
+            tokens_.push_back(token);
+            token = next_token();
+        }
+        tokens_.push_back(token);
+        return std::move(tokens_);
+    }
+
+ private:
+    constexpr int count_groups() const {
+        int count = 0;
+        bool in_charset = false;
+        for (std::size_t i = 0; i < regex_.size(); i++) {
+            char ch = regex_[i];
+            if (ch == '\\')
+                i++;
+            else if (in_charset && ch == ']')
+                in_charset = false;
+            else if (!in_charset && ch == '[')
+                in_charset = true;
+            else if (!in_charset && ch == '(' && (i + 1 == regex_.size() || regex_[i + 1] != '?'))
+                count++;
+        }
+        return count;
+    }
+
+    constexpr StaticToken next_token() {
+        if (is_end())
+            return make_token(TokenType::End);
+
+        char ch = advance();
+        switch (ch) {
+            case '\\':
+                return backslash();
+            case '[':
+                if (in_charset_)
+                    return make_character('[');
+                in_charset_ = true;
+                return make_token(TokenType::Left_Bracket);
+            case ']':
+                if (!in_charset_)
+                    return make_character(']');
+                in_charset_ = false;
+                return make_token(TokenType::Right_Bracket);
+            case '(':
+                return in_charset_ ? make_character('(') : make_token(TokenType::Left_Paren);
+            case ')':
+                return in_charset_ ? make_character(')') : make_token(TokenType::Right_Paren);
+            case '{':
+                return left_brace();
+            case '*':
+                return quantifier('*', TokenType::Star);
+            case '+':
+                return quantifier('+', TokenType::Plus);
+            case '|':
+                return in_charset_ ? make_character('|') : make_token(TokenType::Alternation);
+            case '-':
+                if (in_charset_ && (is_first_in_charset() || (!is_end() && peek() == ']')))
+                    return make_character('-');
+                return in_charset_ ? make_token(TokenType::Hyphen) : make_character('-');
+            case '?':
+                if (!tokens_.empty() && tokens_.back().type == TokenType::Left_Paren) {
+                    if (is_end() || advance() != ':')
+                        static_regex_error("extensions other than `(?:...)` are not supported");
+                    return make_token(TokenType::Non_Capturing_Group);
+                }
+                return quantifier('?', TokenType::Question);
+            case '.':
+                return in_charset_ ? make_character('.') : make_char_class('.');
+            case '^':
+                if (in_charset_ && !is_first_in_charset())
+                    return make_character('^');
+                return make_token(TokenType::Caret);
+            case '$':
+                return in_charset_ ? make_character('$') : make_token(TokenType::Dollar);
+            default:
+                if (in_charset_ && static_cast<unsigned char>(ch) > 0x7f)
+                    static_regex_error("non-ascii character in charset is not supported");
+                return make_character(ch);
+        }
+    }
+
+    constexpr StaticToken backslash() {
+        if (is_end())
+            static_regex_error("pattern may not end with a trailing backslash");
+
+        char ch = advance();
+        switch (ch) {
+            case 'd':
+            case 'D':
+            case 's':
+            case 'S':
+            case 'w':
+            case 'W':
+                return make_char_class(ch);
+            case 'b':
+                return in_charset_ ? make_character('\b') : make_token(TokenType::Word_Boundary);
+            case 'B':
+                return make_token(TokenType::Word_Boundary);
+            case 'f':
+                return make_character('\f');
+            case 'n':
+                return make_character('\n');
+            case 'r':
+                return make_character('\r');
+            case 't':
+                return make_character('\t');
+            case 'v':
+                return make_character('\v');
+            case 'x':
+                return hex_number(ch, 2);
+            case 'u':
+                return hex_number(ch, 4);
+            default:
+                if (is_digit(ch))
+                    return number_after_backslash(ch);
+                return make_character(ch);
+        }
+    }
+
+    constexpr StaticToken quantifier(char ch, TokenType type) {
+        if (in_charset_)
+            return make_character(ch);
+        if (!is_end() && peek() == '?') // lazy match
+            advance();
+        return make_token(type);
+    }
+
+    constexpr StaticToken left_brace() {
+        if (in_charset_)
+            return make_character('{');
+
+        std::size_t position = current_position_;
+        int lower = -1;
+        int upper = -1;
+        bool overflow = false;
+        bool has_lower = read_count(lower, overflow);
+        if (is_end() || (peek() != ',' && peek() != '}')) {
+            current_position_ = position;
+            return make_character('{');
+        }
+        if (advance() == '}') {
+            if (!has_lower) {
+                current_position_ = position;
+                return make_character('{');
+            }
+            upper = lower;
+        } else {
+            bool has_upper = read_count(upper, overflow);
+            if (is_end() || peek() != '}' || (!has_lower && !has_upper)) {
+                current_position_ = position;
+                return make_character('{');
+            }
+            advance();
+            if (!has_lower)
+                lower = 0;
+            if (!has_upper)
+                upper = -1;
+        }
+        if (overflow)
+            static_regex_error("repeat count too large");
+        if (upper != -1 && lower > upper)
+            static_regex_error("invalid repeat quantifier: lower bound is greater than upper");
+        if (!is_end() && peek() == '?') // lazy match
+            advance();
+        return make_repeat(lower, upper);
+    }
+
+    constexpr bool read_count(int &count, bool &overflow) {
+        bool has_digit = false;
+        count = 0;
+        while (!is_end() && is_digit(peek())) {
+            int digit = advance() - '0';
+            if (count > (max_repeat_count - digit) / 10)
+                overflow = true;
+            else
+                count = count * 10 + digit;
+            has_digit = true;
+        }
+        return has_digit;
+    }
+
+    constexpr StaticToken number_after_backslash(char first_digit) {
+        if (is_end() || !is_digit(peek())) {
+            if (first_digit == '0')
+                return make_character('\0');
+            if (first_digit - '0' > group_count_) {
+                if (is_octal(first_digit))
+                    return make_character(static_cast<char>(first_digit - '0'));
+                return make_character(first_digit);
+            }
+            return make_backreference(first_digit - '0');
+        }
+
+        char second_digit = peek();
+        int group_number = (first_digit - '0') * 10 + (second_digit - '0');
+        if (group_number != 0 && group_number <= group_count_) {
+            advance();
+            if (is_end() || !is_digit(peek()))
+                return make_backreference(group_number);
+            char third_digit = peek();
+            if (group_number * 10 + (third_digit - '0') <= group_count_) {
+                advance();
+                return make_backreference(group_number * 10 + third_digit - '0');
+            }
+        }
+
+        if (!is_octal(first_digit))
+            return make_character(first_digit);
+        if (!is_octal(second_digit))
+            return make_character(static_cast<char>(first_digit - '0'));
+
+        advance();
+        int value = (first_digit - '0') * 8 + (second_digit - '0');
+        if (is_end() || !is_octal(peek()))
+            return make_character(static_cast<char>(value));
+        if (value * 8 + (peek() - '0') > 255)
+            return make_character(static_cast<char>(value));
+        return make_character(static_cast<char>(value * 8 + (advance() - '0')));
+    }
+
+    constexpr StaticToken hex_number(char prev, int digit) {
+        std::size_t position = current_position_;
+        int value = 0;
+        for (int i = 0; i < digit; i++) {
+            if (is_end() || hex_value(peek()) < 0) {
+                current_position_ = position;
+                return make_character(prev);
+            }
+            value = value * 16 + hex_value(advance());
+        }
+        if (value > 255)
+            static_regex_error("unsupported hex value");
+        return make_character(static_cast<char>(value));
+    }
+
+    constexpr bool is_first_in_charset() const {
+        return !tokens_.empty() && tokens_.back().type == TokenType::Left_Bracket;
+    }
+
+    constexpr StaticToken make_character(char ch) const {
+        return {.type = TokenType::Character, .character = ch};
+    }
+
+    constexpr StaticToken make_char_class(char ch) const {
+        return {.type = TokenType::Char_Class, .character = ch};
+    }
+
+    constexpr StaticToken make_repeat(int lower, int upper) const {
+        return {.type = TokenType::Repeat, .repeat_lower = lower, .repeat_upper = upper};
+    }
+
+    constexpr StaticToken make_backreference(int group_number) const {
+        return {.type = TokenType::Backreference, .group_number = group_number};
+    }
+
+    constexpr StaticToken make_token(TokenType type) const { return {.type = type}; }
+
+    constexpr static bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+    constexpr static bool is_octal(char ch) { return ch >= '0' && ch <= '7'; }
+
+    constexpr static int hex_value(char ch) {
+        if (ch >= '0' && ch <= '9')
+            return ch - '0';
+        if (ch >= 'a' && ch <= 'f')
+            return 10 + ch - 'a';
+        if (ch >= 'A' && ch <= 'F')
+            return 10 + ch - 'A';
+        return -1;
+    }
+
+    constexpr char peek() const { return regex_[current_position_]; }
+
+    constexpr char advance() { return regex_[current_position_++]; }
+
+    constexpr bool is_end() const { return current_position_ >= regex_.size(); }
+
+    constexpr static int max_repeat_count = 0x7fffffff;
+
+    std::string_view regex_;
+    std::vector<StaticToken> tokens_;
+    std::size_t current_position_{0};
+    int group_count_{0};
+    bool in_charset_{false};
+};
+
+/// Compile-time twin of `Parser`, lowers tokens into a flat `StaticProgram`.
+/// The shape of the plan is the same as the AST built by `Parser`.
+class StaticCompiler {
+ public:
+    constexpr explicit StaticCompiler(std::string_view regex)
+        : tokens_(StaticLexer(regex).tokenize()) {
+        root_ = alternative();
+        if (tokens_[current_position_].type != TokenType::End) {
+            if (is_quantifier(tokens_[current_position_].type))
+                static_regex_error("the preceding token is not quantifiable");
+            static_regex_error("invalid regex");
+        }
+    }
+
+    constexpr StaticSizes sizes() const {
+        return {nodes_.size(), children_.size(), text_.size(), charsets_.size(), groups_.size()};
+    }
+
+    template <StaticSizes Sizes>
+    constexpr StaticProgram<Sizes> program() const {
+        StaticProgram<Sizes> program;
+        std::ranges::copy(nodes_, program.nodes.begin());
+        std::ranges::copy(children_, program.children.begin());
+        std::ranges::copy(text_, program.text.begin());
+        std::ranges::copy(charsets_, program.charsets.begin());
+        for (const StaticNode &node : nodes_) {
+            if (node.type == StaticNodeType::Backref)
+                program.referenced[node.first] = true;
+        }
+        program.root = root_;
+        return program;
+    }
+
+ private:
+    using CharacterSet = std::array<bool, 128>;
+
+    constexpr int alternative() {
+        int alter = sequence();
+        if (!check(TokenType::Alternation))
+            return alter;
+        std::vector<int> elements{alter};
+        while (match(TokenType::Alternation))
+            elements.push_back(sequence());
+        return add_compound(StaticNodeType::Alternation, elements);
+    }
+
+    constexpr int sequence() {
+        std::vector<int> elements;
+        while (is_atom(peek().type))
+            elements.push_back(term());
+        // No need for a sequence when there is only one element.
+        if (elements.size() == 1)
+            return elements[0];
+        return add_compound(StaticNodeType::Sequence, elements);
+    }
+
+    constexpr int term() {
+        int content = atom();
+        if (match(TokenType::Star))
+            return add_repeat(content, 0, default_max_repeat_count);
+        if (match(TokenType::Plus))
+            return add_repeat(content, 1, default_max_repeat_count);
+        if (match(TokenType::Question))
+            return add_repeat(content, 0, 1);
+        if (match(TokenType::Repeat)) {
+            int lower = previous().repeat_lower;
+            int upper = previous().repeat_upper;
+            return add_repeat(content, lower,
+                              upper == -1 ? lower + default_max_repeat_count : upper);
+        }
+        return content;
+    }
+
+    constexpr int atom() {
+        if (match(TokenType::Character))
+            return add_text(previous().character);
+        if (match(TokenType::Char_Class))
+            return add_charset(char_class(previous().character));
+        if (match(TokenType::Left_Paren))
+            return group();
+        if (match(TokenType::Left_Bracket))
+            return charset();
+        if (match(TokenType::Backreference))
+            return backreference();
+        static_regex_error("invalid regex");
+        return 0;
+    }
+
+    constexpr int group() {
+        if (match(TokenType::Non_Capturing_Group)) {
+            int content = alternative();
+            if (!match(TokenType::Right_Paren))
+                static_regex_error("expect ')' to complete group");
+            return content;
+        }
+        // Groups are numbered by the order of their left parentheses.
+        int index = static_cast<int>(groups_.size()) + 1;
+        groups_.push_back(false);
+        int content = alternative();
+        if (!match(TokenType::Right_Paren))
+            static_regex_error("expect ')' to complete group");
+        groups_[index - 1] = true;
+        return add_node({.type = StaticNodeType::Group, .first = content, .group = index});
+    }
+
+    constexpr int backreference() {
+        int group_number = previous().group_number;
+        // A backreference before the end of the associated group matches zero-length text.
+        if (group_number > static_cast<int>(groups_.size()) || !groups_[group_number - 1])
+            return add_node({.type = StaticNodeType::Text, .first = 0, .count = 0});
+        return add_node({.type = StaticNodeType::Backref, .first = group_number});
+    }
+
+    constexpr int charset() {
+        bool is_inclusive = !match(TokenType::Caret);
+        CharacterSet characters{};
+        while (!is_end() && !check(TokenType::Right_Bracket)) {
+            if (check(TokenType::Character) && peek(1).type == TokenType::Hyphen &&
+                peek(2).type == TokenType::Character) {
+                char start = advance().character;
+                advance();
+                char end = advance().character;
+                if (start > end)
+                    static_regex_error("invalid character range");
+                for (int ch = start; ch <= end; ch++)
+                    insert(characters, static_cast<char>(ch));
+            } else if (check(TokenType::Char_Class)) {
+                CharacterSet cs = char_class(advance().character);
+                for (std::size_t i = 0; i < cs.size(); i++)
+                    characters[i] = characters[i] || cs[i];
+            } else {
+                const StaticToken &token = advance();
+                insert(characters, token.type == TokenType::Hyphen ? '-' : token.character);
+            }
+        }
+        if (!match(TokenType::Right_Bracket))
+            static_regex_error("expect ']' to close character set");
+        if (!is_inclusive) {
+            for (bool &member : characters)
+                member = !member;
+        }
+        return add_charset(characters);
+    }
+
+    /// Non-ascii characters are never generated, so they are dropped here.
+    constexpr static void insert(CharacterSet &characters, char ch) {
+        if (ch >= 0)
+            characters[ch] = true;
+    }
+
+    constexpr static CharacterSet char_class(char ch) {
+        CharacterSet characters{};
+        for (int i = 0; i < 128; i++) {
+            bool is_digit = i >= '0' && i <= '9';
+            bool is_word = is_digit || (i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z') || i == '_';
+            bool is_space = i == ' ' || i == '\t' || i == '\r' || i == '\n';
+            switch (ch) {
+                case 'd':
+                case 'D':
+                    characters[i] = is_digit == (ch == 'd');
+                    break;
+                case 'w':
+                case 'W':
+                    characters[i] = is_word == (ch == 'w');
+                    break;
+                case 's':
+                case 'S':
+                    characters[i] = is_space == (ch == 's');
+                    break;
+                default:
+                    // `.` matches everything but newline.
+                    characters[i] = i != '\n';
+                    break;
+            }
+        }
+        return characters;
+    }
+
+    constexpr int add_text(char ch) {
+        int first = static_cast<int>(text_.size());
+        text_.push_back(ch);
+        return add_node({.type = StaticNodeType::Text, .first = first, .count = 1});
+    }
+
+    constexpr int add_charset(const CharacterSet &characters) {
+        StaticCharset charset;
+        // Only printable characters are generated.
+        for (int ch = 0x20; ch < 0x7f; ch++) {
+            if (characters[ch])
+                charset.characters[charset.size++] = static_cast<char>(ch);
+        }
+        auto iter = std::ranges::find(charsets_, charset);
+        if (iter == charsets_.end()) {
+            charsets_.push_back(charset);
+            iter = charsets_.end() - 1;
+        }
+        return add_node({.type = StaticNodeType::Charset,
+                         .first = static_cast<int>(iter - charsets_.begin())});
+    }
+
+    constexpr int add_repeat(int content, int lower, int upper) {
+        return add_node(
+            {.type = StaticNodeType::Repeat, .first = content, .lower = lower, .upper = upper});
+    }
+
+    constexpr int add_compound(StaticNodeType type, const std::vector<int> &elements) {
+        int first = static_cast<int>(children_.size());
+        children_.insert(children_.end(), elements.begin(), elements.end());
+        return add_node({.type = type, .first = first, .count = static_cast<int>(elements.size())});
+    }
+
+    constexpr int add_node(const StaticNode &node) {
+        nodes_.push_back(node);
+        return static_cast<int>(nodes_.size()) - 1;
+    }
+
+    constexpr static bool is_atom(TokenType type) {
+        return type == TokenType::Character || type == TokenType::Char_Class ||
+               type == TokenType::Left_Paren || type == TokenType::Left_Bracket ||
+               type == TokenType::Backreference;
+    }
+
+    constexpr static bool is_quantifier(TokenType type) {
+        return type == TokenType::Star || type == TokenType::Plus ||
+               type == TokenType::Question || type == TokenType::Repeat;
+    }
+
+    constexpr bool match(TokenType expect) {
+        if (!check(expect))
+            return false;
+        current_position_++;
+        return true;
+    }
+
+    constexpr bool check(TokenType expect) const { return peek().type == expect; }
+
+    constexpr const StaticToken &peek(std::size_t offset = 0) const {
+        return tokens_[std::min(current_position_ + offset, tokens_.size() - 1)];
+    }
+
+    constexpr const StaticToken &previous() const { return tokens_[current_position_ - 1]; }
+
+    constexpr const StaticToken &advance() { return tokens_[current_position_++]; }
+
+    constexpr bool is_end() const { return check(TokenType::End); }
+
+    // Keep the same limit as `Parser`.
+    constexpr static int default_max_repeat_count = 3;
+
+    std::vector<StaticToken> tokens_;
+    std::size_t current_position_{0};
+    std::vector<StaticNode> nodes_;
+    std::vector<int> children_;
+    std::vector<char> text_;
+    std::vector<StaticCharset> charsets_;
+    std::vector<bool> groups_; ///< if the group is closed, indexed by group number - 1
+    int root_{0};
+};
+
+/// Lexes, parses and lowers `Pattern` during constant evaluation.
+template <FixedString Pattern>
+consteval auto static_compile() {
+    constexpr StaticSizes sizes = StaticCompiler(Pattern.view()).sizes();
+    return StaticCompiler(Pattern.view()).program<sizes>();
+}
+
+} // namespace detail
+
+/// Regular expression that is parsed at compile time.
+/// Every branch, repeat bound and charset table of the pattern is a template constant, so the
+/// whole generator can be inlined. Invalid patterns are rejected at compile time.
+template <FixedString Pattern>
+class StaticRegex {
+ public:
+    /// Generates a string matching the pattern, using `engine` as the source of randomness.
+    template <std::uniform_random_bit_generator Engine>
+    std::string generate(Engine &engine) const {
+        std::string result;
+        Captures captures{};
+        generate_node<program_.root>(result, engine, captures);
+        return result;
+    }
+
+    /// Generates a string matching the pattern.
+    std::string generate() const {
+        thread_local std::mt19937 engine{std::random_device{}()};
+        return generate(engine);
+    }
+
+ private:
+    /// Captured text of a group, as a span in the generated string.
+    struct Capture {
+        std::size_t offset{0};
+        std::size_t length{0};
+        bool captured{false};
+    };
+
+    constexpr static auto program_ = detail::static_compile<Pattern>();
+
+    using Captures = std::array<Capture, program_.referenced.size()>;
+
+    template <int Index, typename Engine>
+    static void generate_node(std::string &result, Engine &engine, Captures &captures) {
+        constexpr detail::StaticNode node = program_.nodes[Index];
+
+        if constexpr (node.type == detail::StaticNodeType::Text) {
+            if constexpr (node.count > 0)
+                result.append(program_.text.data() + node.first, node.count);
+        } else if constexpr (node.type == detail::StaticNodeType::Charset) {
+            constexpr detail::StaticCharset charset = program_.charsets[node.first];
+            if constexpr (charset.size == 1) {
+                result.push_back(charset.characters[0]);
+            } else if constexpr (charset.size > 1) {
+                std::uniform_int_distribution<int> random(0, charset.size - 1);
+                result.push_back(charset.characters[random(engine)]);
+            }
+        } else if constexpr (node.type == detail::StaticNodeType::Sequence) {
+            generate_sequence<node.first>(result, engine, captures,
+                                          std::make_integer_sequence<int, node.count>{});
+        } else if constexpr (node.type == detail::StaticNodeType::Repeat) {
+            int repeat_count = node.lower;
+            if constexpr (node.lower != node.upper) {
+                std::uniform_int_distribution<int> random(node.lower, node.upper);
+                repeat_count = random(engine);
+            }
+            while (repeat_count--)
+                generate_node<node.first>(result, engine, captures);
+        } else if constexpr (node.type == detail::StaticNodeType::Group) {
+            // Only groups used by a backreference pay for capturing.
+            if constexpr (program_.referenced[node.group]) {
+                std::size_t offset = result.size();
+                generate_node<node.first>(result, engine, captures);
+                captures[node.group] = {offset, result.size() - offset, true};
+            } else {
+                generate_node<node.first>(result, engine, captures);
+            }
+        } else if constexpr (node.type == detail::StaticNodeType::Alternation) {
+            std::uniform_int_distribution<int> random(0, node.count - 1);
+            generate_alternation<node.first>(result, engine, captures, random(engine),
+                                             std::make_integer_sequence<int, node.count>{});
+        } else if constexpr (node.type == detail::StaticNodeType::Backref) {
+            // for regex like `(abc)|\1`
+            const Capture &capture = captures[node.first];
+            if (!capture.captured)
+                return;
+            result.reserve(result.size() + capture.length);
+            result.append(result.data() + capture.offset, capture.length);
+        }
+    }
+
+    template <int First, typename Engine, int... Is>
+    static void generate_sequence(std::string &result, Engine &engine, Captures &captures,
+                                  std::integer_sequence<int, Is...>) {
+        (generate_node<program_.children[First + Is]>(result, engine, captures), ...);
+    }
+
+    template <int First, typename Engine, int... Is>
+    static void generate_alternation(std::string &result, Engine &engine, Captures &captures,
+                                     int choice, std::integer_sequence<int, Is...>) {
+        ((choice == Is ? generate_node<program_.children[First + Is]>(result, engine, captures)
+                       : void()),
+         ...);
+    }
+};
+
+/// Compile-time parsed regular expression, e.g., `strex::static_regex<"\\d{4}">`.
+template <FixedString Pattern>
+inline constexpr StaticRegex<Pattern> static_regex{};
+
+/// Generates a string from a regular expression parsed at compile time.
+template <FixedString Pattern>
+std::string from_regex(const StaticRegex<Pattern> &regex) {
+    return regex.generate();
+}
+
+} // namespace strex
+
+#endif
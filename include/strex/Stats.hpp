@@ -0,0 +1,99 @@
+/// @file
+/// Runtime statistics of lexing, parsing and generation.
+/// Counters are thread-local, each thread merges its counters into the process-wide total with
+/// `stats::flush` when its work is done, so collecting statistics does not serialize threads.
+
+#ifndef NEROLL_STREX_STATS_HPP
+#define NEROLL_STREX_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace strex::stats {
+
+/// Histogram of latencies in nanoseconds.
+/// Each power of two is split into `sub_buckets` linear buckets, so the relative error of a
+/// percentile is at most 1 / `sub_buckets`.
+class LatencyHistogram {
+ public:
+    constexpr static std::size_t sub_buckets = 8;
+
+    void record(std::uint64_t nanoseconds);
+
+    void merge(const LatencyHistogram &other);
+
+    std::uint64_t count() const { return count_; }
+
+    /// Returns the upper bound of the bucket that holds the given percentile, 0 if empty.
+    /// @param percentile in [0, 100]
+    std::uint64_t percentile(double percentile) const;
+
+ private:
+    constexpr static std::size_t bucket_count = 64 * sub_buckets;
+
+    static std::size_t bucket_index(std::uint64_t nanoseconds);
+
+    static std::uint64_t bucket_upper_bound(std::size_t index);
+
+    std::array<std::uint64_t, bucket_count> buckets_{};
+    std::uint64_t count_{0};
+};
+
+/// Counters of one thread, or the total of all threads.
+struct Counters {
+    std::uint64_t lex_ns{0};         ///< time of `Lexer::tokenize`
+    std::uint64_t parse_ns{0};       ///< time of `Parser::parse` and optimization passes
+    std::uint64_t generate_ns{0};    ///< time of `Generator::generate`
+    std::uint64_t output_ns{0};      ///< time of writing generated strings, set by callers
+    std::uint64_t strings{0};        ///< number of generated strings
+    std::uint64_t bytes_emitted{0};  ///< total size of generated strings
+    std::uint64_t random_draws{0};   ///< values drawn from random engines
+    std::uint64_t allocations{0};    ///< heap allocations, counted only with an allocation hook
+    LatencyHistogram latency;        ///< time to generate each string
+
+    void merge(const Counters &other);
+};
+
+/// Enables or disables collecting statistics, disabled by default.
+void enable(bool enabled = true);
+
+bool is_enabled();
+
+/// Returns counters of current thread.
+Counters &local();
+
+/// Merges counters of current thread into the total, and resets them.
+/// Call it when a thread finishes its work.
+void flush();
+
+/// Returns the total of flushed counters.
+Counters collect();
+
+/// Counts a heap allocation of current thread.
+/// Called by the opt-in allocation hook, it never allocates.
+void count_allocation() noexcept;
+
+/// Adds the time from construction to destruction to a counter if statistics are enabled.
+class PhaseTimer {
+ public:
+    explicit PhaseTimer(std::uint64_t Counters::*phase);
+
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    /// Returns nanoseconds elapsed since construction, 0 if statistics are disabled.
+    std::uint64_t elapsed() const;
+
+ private:
+    std::uint64_t Counters::*phase_;
+    std::chrono::steady_clock::time_point start_;
+    bool is_enabled_;
+};
+
+} // namespace strex::stats
+
+#endif
@@ -3,14 +3,16 @@
 #ifndef NEROLL_STREX_TOKEN_HPP
 #define NEROLL_STREX_TOKEN_HPP
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 #include <strex/TextRange.hpp>
 
 namespace strex {
 
 /// Types of tokens.
-enum class TokenType {
+enum class TokenType : std::uint8_t {
 
     Character,  ///< any "non-special" character
     Char_Class, ///< `\w`, `\d`, `.`, etc.
@@ -48,14 +50,23 @@ enum class TokenType {
 };
 
 /// Basic element to be processed extracted from raw regular expression.
+/// Tokens are small trivially-copyable values. Text such as a group name is not stored in the
+/// token, it can be recovered from the regular expression through the token range.
 class Token {
  public:
+    /// Max length of the text of a token.
+    constexpr static std::size_t max_length = UINT16_MAX;
+
     /// Creates a token with type @link TokenType::Character Character @endlink.
-    static Token create_character(char ch, const TextRange &range);
+    static Token create_character(char32_t code_point, const TextRange &range);
 
     /// Creates a token with type `Char_Class`.
     static Token create_char_class(char ch, const TextRange &range);
 
+    /// Creates a token with type `Char_Class` for `\p{...}`, or `\P{...}` if not inclusive.
+    static Token create_property(std::uint32_t categories, bool is_inclusive,
+                                 const TextRange &range);
+
     /// Creates a token with type `Repeat`.
     static Token create_repeat(int repeat_lower, int repeat_upper, const TextRange &range);
 
@@ -75,7 +86,7 @@ class Token {
     }
 
     /// Returns the text range of token.
-    const TextRange &range() const { return range_; }
+    TextRange range() const { return {start_, start_ + length_}; }
 
     /// Returns the type of token.
     TokenType type() const { return type_; }
@@ -91,10 +102,18 @@ class Token {
     /// Can only be called when token type is `Backreference`.
     int group_number() const;
 
-    /// Returns character represented by token.
+    /// Returns character represented by token, code points beyond ASCII are truncated.
     /// Can only be called when token type is `Character` or `Char_Class`.
     char character() const;
 
+    /// Returns the code point represented by token.
+    /// Can only be called when token type is `Character`.
+    char32_t code_point() const;
+
+    /// Returns the mask of general categories of `\p{...}` or `\P{...}`.
+    /// Can only be called when token type is `Char_Class` and character is `p` or `P`.
+    std::uint32_t categories() const;
+
  private:
     /// Constructs Token with specific character and type.
     Token(char ch, TokenType type, const TextRange &range);
@@ -108,15 +127,20 @@ class Token {
     /// Constructs Token with specific type.
     Token(TokenType type, const TextRange &range);
 
+    std::uint32_t start_{0};        // start of text range in regular expression
+    std::uint16_t length_{0};       // length of text range in regular expression
     TokenType type_{TokenType::Error};
-    std::string group_name_; // for named group
-    TextRange range_;        // text range in regular expression
-    int repeat_lower_{-1};   // for Repeat, minimum times of repetition
-    int repeat_upper_{-1};   // for Repeat, maximum times of repetition
-    int group_number_{-1};   // for Backreference
-    char character_{'\0'};   // for Character and Char_Class
+    char character_{'\0'};          // for Character and Char_Class
+    std::int32_t value_{-1};        // for Repeat, minimum times of repetition
+                                    // for Backreference, group number
+                                    // for Character, code point
+                                    // for Char_Class of a property, mask of categories
+    std::int32_t repeat_upper_{-1}; // for Repeat, maximum times of repetition
 };
 
+static_assert(sizeof(Token) == 16);
+static_assert(std::is_trivially_copyable_v<Token>);
+
 } // namespace strex
 
 #endif
\ No newline at end of file
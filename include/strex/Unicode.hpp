@@ -0,0 +1,120 @@
+/// @file
+
+#ifndef NEROLL_STREX_UNICODE_HPP
+#define NEROLL_STREX_UNICODE_HPP
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace strex {
+
+/// A range of code points, both ends are included.
+struct CodePointRange {
+    char32_t first;
+    char32_t last;
+
+    auto operator<=>(const CodePointRange &) const = default;
+};
+
+/// Code points, UTF-8 and general categories.
+/// General categories come from `src/UnicodeTables.inc`, generated by `scripts/unicode_tables.py`.
+namespace unicode {
+
+/// Sorted and disjoint ranges of code points.
+using Ranges = std::vector<CodePointRange>;
+
+/// A range of bytes, both ends are included.
+struct ByteRange {
+    std::uint8_t first;
+    std::uint8_t last;
+};
+
+/// Byte ranges of a UTF-8 sequence, one for each byte.
+using Utf8Sequence = std::vector<ByteRange>;
+
+constexpr char32_t max_code_point = 0x10FFFF;
+
+/// Returned by `decode_utf8` for malformed sequences.
+constexpr char32_t invalid_code_point = 0xFFFFFFFF;
+
+/// Printable ASCII characters, the only characters generated by negated sets and `.`.
+constexpr CodePointRange ascii_printable{' ', '~'};
+
+constexpr bool is_surrogate(char32_t code_point) {
+    return code_point >= 0xD800 && code_point <= 0xDFFF;
+}
+
+/// Encodes a code point as UTF-8 into `out`, which has room for 4 bytes.
+/// @return the number of bytes written
+constexpr std::size_t encode_utf8(char32_t code_point, char *out) {
+    if (code_point < 0x80) {
+        out[0] = static_cast<char>(code_point);
+        return 1;
+    }
+    if (code_point < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+        out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    if (code_point < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+    out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/// Appends a code point to `text` as UTF-8.
+inline void append_utf8(std::string &text, char32_t code_point) {
+    if (code_point < 0x80) {
+        text.push_back(static_cast<char>(code_point));
+        return;
+    }
+    char buffer[4];
+    text.append(buffer, encode_utf8(code_point, buffer));
+}
+
+/// Decodes the UTF-8 sequence at `position` of `text`, and moves `position` past it.
+/// @return the code point, or `invalid_code_point` if the sequence is malformed, overlong or
+/// encodes a surrogate
+char32_t decode_utf8(std::string_view text, std::size_t &position);
+
+/// Returns the mask of general categories named by a property, 0 if the name is unknown.
+/// Names are short or long general categories, such as `L`, `Lu`, `Letter` or
+/// `Uppercase_Letter`, optionally after `gc=` or `General_Category=`.
+std::uint32_t property_categories(std::string_view name);
+
+/// Returns the code points whose general category is in the mask `categories`.
+Ranges category_ranges(std::uint32_t categories);
+
+/// Returns printable code points, all code points but controls, formats, surrogates, private
+/// uses, unassigned ones and line and paragraph separators.
+const Ranges &printable();
+
+/// Sorts ranges, and merges the ones that overlap or are adjacent.
+void normalize(Ranges &ranges);
+
+/// Returns the code points that are not in normalized `ranges`, surrogates excluded.
+Ranges complement(const Ranges &ranges);
+
+/// Returns the code points in both normalized `lhs` and `rhs`.
+Ranges intersect(const Ranges &lhs, const Ranges &rhs);
+
+/// Splits normalized `ranges` into UTF-8 sequences, a string matches one of the sequences if and
+/// only if it is the UTF-8 encoding of a code point in `ranges`.
+std::vector<Utf8Sequence> utf8_sequences(const Ranges &ranges);
+
+} // namespace unicode
+
+} // namespace strex
+
+#endif
@@ -11,6 +11,8 @@ class RepeatNode;
 class GroupNode;
 class AlternationNode;
 class BackrefNode;
+class AnchorNode;
+class LookaroundNode;
 
 class ASTVisitor {
  public:
@@ -23,6 +25,8 @@ class ASTVisitor {
     virtual void visit(const GroupNode *node) = 0;
     virtual void visit(const AlternationNode *node) = 0;
     virtual void visit(const BackrefNode *node) = 0;
+    virtual void visit(const AnchorNode *node) = 0;
+    virtual void visit(const LookaroundNode *node) = 0;
 };
 
 } // namespace strex
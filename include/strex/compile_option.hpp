@@ -1,6 +1,7 @@
 #ifndef NEROLL_STREX_COMPILE_OPTION_HPP
 #define NEROLL_STREX_COMPILE_OPTION_HPP
 
+#include <cstddef>
 #include <string>
 
 #include <argparse/argparse.hpp>
@@ -11,6 +12,38 @@ extern int generate_count;
 
 extern std::string base_regex;
 
+extern bool print_stats;
+
+extern bool print_stats_json;
+
+extern bool print_profile;
+
+extern bool verify;
+
+extern bool secure;
+
+extern std::string emit_cpp_name;
+
+extern bool print_cpu_info;
+
+extern bool stream;
+
+extern int max_repeat;
+
+extern std::string repeat_distribution;
+
+extern double repeat_mean;
+
+extern std::size_t max_bytes;
+
+extern std::string budget_policy;
+
+extern std::string output_path;
+
+extern int jobs;
+
+extern bool ordered;
+
 } // namespace strex::compile_option
 
 #endif
\ No newline at end of file
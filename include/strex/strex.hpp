@@ -1,21 +1,67 @@
 #ifndef NEROLL_STREX_STREX_HPP
 #define NEROLL_STREX_STREX_HPP
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
+
+#include <strex/GenerationOptions.hpp>
 
 namespace strex {
 
 class ASTNode;
+class Automaton;
+class BatchGenerator;
+class Generator;
+class Matcher;
+class Profile;
+class Sink;
+class Skeleton;
 
 /// Compiled regular expression.
 /// This is used to avoid multiple parsing of the same regular expression.
 class ParsedRegex { // NOLINT
     friend std::string from_regex(const ParsedRegex &regex);
+    friend std::string from_regex(const ParsedRegex &regex, Profile &profile);
+    friend void from_regex(const ParsedRegex &regex, Sink &sink);
+    friend std::vector<std::string> from_regex(const ParsedRegex &regex, std::size_t count);
+    friend void from_regex(const ParsedRegex &regex, std::size_t count, std::string &lines);
+    friend std::vector<std::string> from_regex_secure(const ParsedRegex &regex, std::size_t count);
+    friend bool matches(const ParsedRegex &regex, std::string_view text);
+    friend std::string emit_cpp(const ParsedRegex &regex, std::string_view name,
+                                std::string_view source);
+    friend class Matcher;
+    friend class Profile;
+    friend void generate_to_file(std::string_view regex, const GenerationOptions &options,
+                                 const std::string &path, std::size_t count, unsigned jobs);
 
  public:
+    /// Ways that `from_regex(regex, count)` generates strings, from the fastest.
+    enum class Backend {
+        Skeleton,  ///< fills fixed-length strings at a stride
+        Batch,     ///< `BatchGenerator`, `BatchGenerator::lanes` strings at a time
+        Generator, ///< `Generator` one by one, for options other than the default
+        Automaton  ///< `Automaton`, for lookarounds and inner anchors
+    };
+
     explicit ParsedRegex(std::string_view regex);
+
+    /// Compiles `regex` with the repeat ceiling of `options`, and generates strings with its
+    /// repeat distribution and byte budget. Patterns with lookarounds or inner anchors only
+    /// generate strings that fit the budget.
+    /// @throw std::invalid_argument if `options` are not valid
+    /// @throw SyntaxNotSupport if `regex` has lookarounds or inner anchors and the repeat
+    /// distribution is not uniform, their strings have uniform lengths
+    ParsedRegex(std::string_view regex, const GenerationOptions &options);
+
+    /// Returns the options that strings are generated with.
+    const GenerationOptions &options() const { return options_; }
+
+    /// Returns how `from_regex(regex, count)` generates strings.
+    Backend backend() const;
+
     ~ParsedRegex();
 
     ParsedRegex(const ParsedRegex &other) = delete;
@@ -27,13 +73,67 @@ class ParsedRegex { // NOLINT
  private:
     const ASTNode *ast() const;
 
+    /// Compiles the regex again with `PassManager::matching_pipeline`. Generation prunes
+    /// branches that only have unprintable characters, which strings to match can still take.
+    std::unique_ptr<ASTNode> matching_ast() const;
+
+    std::string source_; ///< text of the regex, compiled again by `matching_ast`
+    GenerationOptions options_;
     std::unique_ptr<ASTNode> ast_;
+    std::unique_ptr<Automaton> automaton_; ///< built if the regex has lookarounds or inner anchors
+    std::unique_ptr<Skeleton> skeleton_;   ///< built if the regex has a fixed length and structure
+    mutable std::unique_ptr<Matcher> matcher_; ///< built by the first call of `matches`
+    mutable std::unique_ptr<BatchGenerator> batch_generator_; ///< built by the first batch
+    mutable std::unique_ptr<Generator> generator_;            ///< built for strings one by one
+    mutable std::unique_ptr<Generator> secure_generator_;     ///< built by the first secure call
 };
 
 std::string from_regex(std::string_view regex);
 
+/// Generates a string. The `Generator` is kept in `regex` and reused by later calls, so do not
+/// call it on the same `regex` from multiple threads.
 std::string from_regex(const ParsedRegex &regex);
 
+/// Generates a string and records its cost in `profile`, which must be built from `regex`.
+/// @throw SyntaxNotSupport if `regex` has lookarounds or inner anchors, they are not generated
+/// node by node
+std::string from_regex(const ParsedRegex &regex, Profile &profile);
+
+/// Writes a string to `sink` in chunks of `Generator::chunk_size` as it is generated, for strings
+/// too large to hold in memory. Patterns with lookarounds or inner anchors are generated whole,
+/// then written. The `Generator` is kept in `regex` like `from_regex(regex)`.
+/// @throw GenerateError if the string is over the byte budget and the policy does not allow a
+/// shorter one, the chunks written before stay written
+void from_regex(const ParsedRegex &regex, Sink &sink);
+
+/// Generates `count` strings for bulk generation, from the `Skeleton` of `regex` if it has one,
+/// or `BatchGenerator::lanes` at a time. With a repeat distribution other than uniform or a byte
+/// budget, strings are generated one by one by a `Generator` kept in `regex`.
+/// Generators are kept in `regex`, so do not call it on the same `regex` from multiple threads.
+std::vector<std::string> from_regex(const ParsedRegex &regex, std::size_t count);
+
+/// Appends `count` strings to `lines`, each followed by a newline, for bulk output into a buffer
+/// that is reused. Strings are generated like `from_regex(regex, count)`, but straight into
+/// `lines`, so nothing is allocated once `lines` has grown to the size of the output. Patterns
+/// with lookarounds or inner anchors still allocate each string.
+void from_regex(const ParsedRegex &regex, std::size_t count, std::string &lines);
+
+/// Generates `count` strings with choices drawn from `ChaCha20` and reduced without bias, for
+/// keys and passwords. The engine is kept in `regex` like the batch generator.
+/// @throw SyntaxNotSupport if `regex` has lookarounds or inner anchors, the weights of their
+/// choices are approximate
+std::vector<std::string> from_regex_secure(const ParsedRegex &regex, std::size_t count);
+
+/// Checks if the whole `text` matches `regex`.
+/// The `Matcher` is built on first use and kept in `regex`, so do not call it on the same `regex`
+/// from multiple threads, each thread can build its own `Matcher` instead.
+bool matches(const ParsedRegex &regex, std::string_view text);
+
+/// Returns a standalone C++ header that defines a generator function `name` specialized for
+/// `regex`, see `CppEmitter`. `source` is the text of `regex`, written into a comment.
+/// @throw SyntaxNotSupport if `regex` has lookarounds or inner anchors
+std::string emit_cpp(const ParsedRegex &regex, std::string_view name, std::string_view source);
+
 } // namespace strex
 
 #endif
\ No newline at end of file
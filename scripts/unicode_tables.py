@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Generates src/UnicodeTables.inc, the general categories of Unicode code points.
+
+The table comes from the `unicodedata` module of Python, so its Unicode version is the one of the
+Python that runs this script. Run it from the root directory of the project:
+
+    python3 scripts/unicode_tables.py > src/UnicodeTables.inc
+"""
+
+import unicodedata
+
+# The index of a category is its bit in a category mask, keep it in sync with src/Unicode.cpp.
+CATEGORIES = [
+    "Lu", "Ll", "Lt", "Lm", "Lo",
+    "Mn", "Mc", "Me",
+    "Nd", "Nl", "No",
+    "Pc", "Pd", "Ps", "Pe", "Pi", "Pf", "Po",
+    "Sm", "Sc", "Sk", "So",
+    "Zs", "Zl", "Zp",
+    "Cc", "Cf", "Cs", "Co", "Cn",
+]
+
+MAX_CODE_POINT = 0x10FFFF
+VALUES_PER_LINE = 8
+
+
+def category_runs():
+    """Returns (first code point, category index) of each run of the same category."""
+    runs = []
+    for code_point in range(MAX_CODE_POINT + 1):
+        category = CATEGORIES.index(unicodedata.category(chr(code_point)))
+        if not runs or runs[-1][1] != category:
+            runs.append((code_point, category))
+    return runs
+
+
+def main():
+    runs = category_runs()
+    print(f"// Generated by scripts/unicode_tables.py from Unicode {unicodedata.unidata_version},"
+          " do not edit.")
+    print()
+    print(f'constexpr std::string_view unicode_version = "{unicodedata.unidata_version}";')
+    print()
+    print("/// Two-letter general categories, the index of a category is its bit in a mask.")
+    print(f"constexpr std::array<std::string_view, {len(CATEGORIES)}> category_names = {{")
+    for start in range(0, len(CATEGORIES), VALUES_PER_LINE):
+        names = ", ".join(f'"{name}"' for name in CATEGORIES[start:start + VALUES_PER_LINE])
+        print(f"    {names},")
+    print("};")
+    print()
+    print("/// Runs of code points in the same general category, `first << 5 | category`, sorted.")
+    print(f"constexpr std::array<std::uint32_t, {len(runs)}> category_runs = {{")
+    for start in range(0, len(runs), VALUES_PER_LINE):
+        values = ", ".join(f"0x{first << 5 | category:08x}"
+                           for first, category in runs[start:start + VALUES_PER_LINE])
+        print(f"    {values},")
+    print("};", end="")
+
+
+if __name__ == "__main__":
+    main()
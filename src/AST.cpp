@@ -1,6 +1,8 @@
+#include <cassert>
 #include <memory>
 #include <print>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <strex/AST.hpp>
@@ -9,6 +11,29 @@
 #include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
 
+// Nodes whose destruction is deferred by `dispose`, `nullptr` if no AST is being destroyed.
+static thread_local std::vector<std::unique_ptr<strex::ASTNode>> *pending_nodes = nullptr;
+
+// Destroys a node without nested destructor calls.
+// Children released while destroying a node are queued and destroyed one after another.
+static void dispose(std::unique_ptr<strex::ASTNode> &node) {
+    if (node == nullptr)
+        return;
+    if (pending_nodes != nullptr) {
+        pending_nodes->push_back(std::move(node));
+        return;
+    }
+    std::vector<std::unique_ptr<strex::ASTNode>> nodes;
+    pending_nodes = &nodes;
+    nodes.push_back(std::move(node));
+    while (!nodes.empty()) {
+        auto last = std::move(nodes.back());
+        nodes.pop_back();
+        last.reset();
+    }
+    pending_nodes = nullptr;
+}
+
 strex::TextNode::TextNode(char text, const TextRange &range) : range_(range), text_(1, text) {}
 
 strex::TextNode::TextNode(std::string text, const TextRange &range)
@@ -21,9 +46,15 @@ strex::SequenceNode::SequenceNode(std::vector<std::unique_ptr<ASTNode>> nodes,
                                   const TextRange &range)
     : range_(range), nodes_(std::move(nodes)) {}
 
+strex::SequenceNode::~SequenceNode() {
+    for (auto &node : nodes_)
+        dispose(node);
+}
+
 strex::RepeatNode::RepeatNode(std::unique_ptr<ASTNode> node, int lower, int upper,
-                              const TextRange &range)
-    : node_(std::move(node)), range_(range), lower_(lower), upper_(upper) {
+                              const TextRange &range, bool is_open_ended)
+    : node_(std::move(node)), range_(range), lower_(lower), upper_(upper),
+      is_open_ended_(is_open_ended) {
     // minimum value of lower_ is 0
     assert(lower_ >= 0);
     // maximum value of upper_ is indicated by `Parser`
@@ -34,14 +65,38 @@ strex::RepeatNode::RepeatNode(std::unique_ptr<ASTNode> node, int lower, int uppe
     assert(lower_ <= upper_);
 }
 
+strex::RepeatNode::~RepeatNode() {
+    dispose(node_);
+}
+
 strex::GroupNode::GroupNode(std::unique_ptr<ASTNode> node, int index, const TextRange &range)
     : node_(std::move(node)), range_(range), index_(index) {}
 
+strex::GroupNode::~GroupNode() {
+    dispose(node_);
+}
+
 strex::AlternationNode::AlternationNode(std::vector<std::unique_ptr<ASTNode>> elements,
                                         const TextRange &range)
     : elements_(std::move(elements)), range_(range) {}
 
+strex::AlternationNode::~AlternationNode() {
+    for (auto &element : elements_)
+        dispose(element);
+}
+
 strex::BackrefNode::BackrefNode(const GroupNode *group, const TextRange &range)
     : group_(group), range_(range) {
     assert(group != nullptr);
+}
+
+strex::AnchorNode::AnchorNode(Type type, const TextRange &range) : type_(type), range_(range) {}
+
+strex::LookaroundNode::LookaroundNode(std::unique_ptr<ASTNode> node, bool is_lookbehind,
+                                      bool is_negative, const TextRange &range)
+    : node_(std::move(node)), range_(range), is_lookbehind_(is_lookbehind),
+      is_negative_(is_negative) {}
+
+strex::LookaroundNode::~LookaroundNode() {
+    dispose(node_);
 }
\ No newline at end of file
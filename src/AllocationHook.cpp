@@ -0,0 +1,82 @@
+// Replaces the global allocation functions to count heap allocations for `--stats`.
+// This file is linked into the command line program only if allocation statistics are enabled,
+// the library never replaces allocation functions of its users.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include <strex/Stats.hpp>
+
+void *operator new(std::size_t size) {
+    strex::stats::count_allocation();
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    strex::stats::count_allocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+
+
+// Over-aligned types, like SIMD blocks, use the aligned forms. `std::aligned_alloc` takes a size
+// that is a multiple of the alignment.
+static void *allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept {
+    auto align = static_cast<std::size_t>(alignment);
+    size = size == 0 ? align : (size + align - 1) / align * align;
+#if defined(_WIN32)
+    return _aligned_malloc(size, align);
+#else
+    return std::aligned_alloc(align, size);
+#endif
+}
+
+static void free_aligned(void *p) noexcept {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    strex::stats::count_allocation();
+    if (void *p = allocate_aligned(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    strex::stats::count_allocation();
+    return allocate_aligned(size, alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept {
+    free_aligned(p);
+}
\ No newline at end of file
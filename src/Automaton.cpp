@@ -0,0 +1,658 @@
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Automaton.hpp>
+#include <strex/Charset.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Program.hpp>
+#include <strex/Unicode.hpp>
+
+namespace {
+
+/// Gives ids to sets, id 0 is the empty set.
+template <typename T>
+class Interner {
+ public:
+    Interner() { intern({}); }
+
+    std::uint32_t intern(std::vector<T> values) {
+        auto [iter, is_new] = ids_.try_emplace(values, static_cast<std::uint32_t>(sets_.size()));
+        if (is_new)
+            sets_.push_back(std::move(values));
+        return iter->second;
+    }
+
+    const std::vector<T> &operator[](std::uint32_t id) const { return sets_[id]; }
+
+    std::size_t size() const { return sets_.size(); }
+
+ private:
+    std::vector<std::vector<T>> sets_;
+    std::map<std::vector<T>, std::uint32_t> ids_;
+};
+
+} // namespace
+
+/// Builds the DFA of a program by product construction.
+/// A thread is an instruction with the set of lookaheads it has passed but that have not
+/// decided yet. A lookahead is an obligation: the threads running its body, which advance with
+/// every byte until the body matches or fails, and then the obligation is dropped or the thread
+/// dies. A DFA state is the set of main threads, and the set of threads that track lookbehinds.
+/// Lookbehind bodies restart at every position, a lookbehind holds at a position if its body
+/// ends there. `$` is a negative lookahead of any byte.
+class strex::Automaton::Builder {
+ public:
+    Builder(Automaton &automaton, const Program &program);
+
+    /// Splits bytes into classes, and finds the bytes that each class generates.
+    void split_classes(const ASTNode *ast);
+
+    /// Builds DFA states reachable from the start, `split_classes` must be called first.
+    void build();
+
+ private:
+    struct Thread {
+        std::uint32_t pc;
+        std::uint32_t obligations; ///< id of a set of obligations
+
+        auto operator<=>(const Thread &) const = default;
+    };
+
+    /// A lookahead that has not decided yet.
+    struct Obligation {
+        std::uint32_t lookaround;
+        std::uint32_t threads; ///< id of the set of threads running its body
+
+        auto operator<=>(const Obligation &) const = default;
+    };
+
+    enum class Outcome { Failed, Satisfied, Pending };
+
+    /// Facts of the position where threads run.
+    struct Context {
+        bool is_start;
+        std::uint32_t holds; ///< id of the set of lookbehinds that hold
+    };
+
+    constexpr static std::uint32_t failed = std::numeric_limits<std::uint32_t>::max();
+
+    /// Returns the id of the set of stopped threads reachable from `seeds` without consuming a
+    /// byte. A thread stops at `Byte`, `Match` and `Look_End`.
+    std::uint32_t closure(std::vector<Thread> seeds, const Context &context);
+
+    /// Returns the threads of `threads` that consume a byte of `byte_class`, run to the next
+    /// position. Threads that reached `Look_End` stay, while their obligations advance.
+    std::uint32_t step(std::uint32_t threads, std::size_t byte_class, std::uint32_t holds);
+
+    /// Returns the obligations advanced by a byte of `byte_class`, or `failed`.
+    std::uint32_t step_obligations(std::uint32_t obligations, std::size_t byte_class,
+                                   std::uint32_t holds);
+
+    /// Decides lookahead `lookaround` from the threads running its body.
+    Outcome resolve(std::uint32_t lookaround, std::uint32_t threads) const;
+
+    /// Checks if obligations are satisfied when the string ends.
+    bool is_satisfied_at_end(std::uint32_t obligations);
+
+    /// Returns the tracker of lookbehinds at the next position.
+    std::uint32_t step_tracker(std::uint32_t tracker, std::size_t byte_class);
+
+    /// Returns the id of the set of lookbehinds whose body ends in `tracker`.
+    std::uint32_t holds(std::uint32_t tracker);
+
+    /// Returns the DFA state of the tracker and main threads, adds it if it is new.
+    std::uint32_t state(std::uint32_t tracker, std::uint32_t threads);
+
+    std::uint32_t look_end(std::uint32_t lookaround) const {
+        return instructions_[lookarounds_[lookaround].pc].target - 1;
+    }
+
+    Automaton &automaton_;
+    std::vector<Instruction> instructions_;
+    std::vector<Program::ByteSet> byte_sets_;
+    std::vector<Lookaround> lookarounds_;
+    std::uint32_t end_lookahead_;          ///< the lookahead that `$` checks
+    std::vector<Thread> lookbehind_starts_; ///< threads that start each lookbehind body
+    std::vector<unsigned char> class_representatives_;
+
+    Interner<Thread> thread_sets_;
+    Interner<Obligation> obligation_sets_;
+    Interner<std::uint32_t> holds_sets_;
+    std::map<std::tuple<std::uint32_t, std::size_t, std::uint32_t>, std::uint32_t> steps_;
+    std::map<std::tuple<std::uint32_t, std::size_t, std::uint32_t>, std::uint32_t>
+        obligation_steps_;
+    std::vector<signed char> satisfied_at_end_; ///< memo by obligations, -1 if unknown
+
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> state_ids_;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> states_;
+};
+
+strex::Automaton::Builder::Builder(Automaton &automaton, const Program &program)
+    : automaton_(automaton), instructions_(program.instructions()),
+      byte_sets_(program.byte_sets()), lookarounds_(program.lookarounds()) {
+    if (program.has_backref())
+        throw SyntaxNotSupport("backreferences cannot be used with lookarounds");
+
+    // `$` checks the body `Byte(any); Look_End` appended to the program.
+    auto pc = static_cast<std::uint32_t>(instructions_.size());
+    end_lookahead_ = static_cast<std::uint32_t>(lookarounds_.size());
+    lookarounds_.push_back({pc, false, true});
+    byte_sets_.push_back(Program::ByteSet{}.set());
+    instructions_.push_back({OpCode::Look, pc + 3, end_lookahead_});
+    instructions_.push_back({OpCode::Byte, 0, static_cast<std::uint32_t>(byte_sets_.size() - 1)});
+    instructions_.push_back({OpCode::Look_End, 0, end_lookahead_});
+
+    for (std::uint32_t index = 0; index < lookarounds_.size(); index++) {
+        const Lookaround &look = lookarounds_[index];
+        if (!look.is_lookbehind)
+            continue;
+        for (std::uint32_t body = look.pc + 1; body < look_end(index); body++) {
+            OpCode op = instructions_[body].op;
+            if (op == OpCode::Look || op == OpCode::Assert_End)
+                throw SyntaxNotSupport("lookarounds and `$` cannot be used inside lookbehinds");
+        }
+        lookbehind_starts_.push_back({look.pc + 1, 0});
+    }
+}
+
+void strex::Automaton::Builder::build() {
+    std::uint32_t tracker = closure(lookbehind_starts_, {true, 0});
+    std::uint32_t threads = closure({{0, 0}}, {true, holds(tracker)});
+    state(0, 0);
+    automaton_.start_state_ = state(tracker, threads);
+
+    std::size_t class_count = automaton_.class_bytes_.size();
+    for (std::size_t id = 0; id < states_.size(); id++) {
+        auto [current_tracker, current_threads] = states_[id];
+        for (std::size_t byte_class = 0; byte_class < class_count; byte_class++) {
+            std::uint32_t next = dead_state;
+            if (id != dead_state) {
+                std::uint32_t next_tracker = step_tracker(current_tracker, byte_class);
+                std::uint32_t next_holds = holds(next_tracker);
+                next = state(next_tracker, step(current_threads, byte_class, next_holds));
+            }
+            automaton_.transitions_.push_back(next);
+        }
+
+        bool is_accepting = false;
+        for (auto [pc, obligations] : thread_sets_[current_threads]) {
+            if (instructions_[pc].op == OpCode::Match && is_satisfied_at_end(obligations)) {
+                is_accepting = true;
+                break;
+            }
+        }
+        automaton_.accepting_.push_back(is_accepting);
+    }
+}
+
+auto strex::Automaton::Builder::closure(std::vector<Thread> seeds, const Context &context)
+    -> std::uint32_t {
+    std::vector<Thread> pending = std::move(seeds);
+    std::set<Thread> visited;
+    std::vector<Thread> stopped;
+
+    // Runs the body of lookahead `index` at this position, and continues at `pc` unless it fails.
+    auto spawn = [&](std::uint32_t index, std::uint32_t pc, std::uint32_t obligations) {
+        std::uint32_t body = closure({{lookarounds_[index].pc + 1, 0}}, context);
+        switch (resolve(index, body)) {
+            case Outcome::Failed:
+                break;
+            case Outcome::Satisfied:
+                pending.push_back({pc, obligations});
+                break;
+            case Outcome::Pending: {
+                std::vector<Obligation> added = obligation_sets_[obligations];
+                added.push_back({index, body});
+                std::ranges::sort(added);
+                added.erase(std::ranges::unique(added).begin(), added.end());
+                pending.push_back({pc, obligation_sets_.intern(std::move(added))});
+                break;
+            }
+        }
+    };
+
+    while (!pending.empty()) {
+        Thread thread = pending.back();
+        pending.pop_back();
+        if (!visited.insert(thread).second)
+            continue;
+
+        const Instruction &instruction = instructions_[thread.pc];
+        switch (instruction.op) {
+            case OpCode::Byte:
+            case OpCode::Match:
+            case OpCode::Look_End:
+                stopped.push_back(thread);
+                break;
+            case OpCode::Split:
+                pending.push_back({instruction.operand, thread.obligations});
+                pending.push_back({instruction.target, thread.obligations});
+                break;
+            case OpCode::Jump:
+                pending.push_back({instruction.target, thread.obligations});
+                break;
+            case OpCode::Save:
+            case OpCode::Loop_Check:
+                pending.push_back({thread.pc + 1, thread.obligations});
+                break;
+            case OpCode::Assert_Begin:
+                if (context.is_start)
+                    pending.push_back({thread.pc + 1, thread.obligations});
+                break;
+            case OpCode::Assert_End:
+                spawn(end_lookahead_, thread.pc + 1, thread.obligations);
+                break;
+            case OpCode::Look: {
+                const Lookaround &look = lookarounds_[instruction.operand];
+                if (!look.is_lookbehind) {
+                    spawn(instruction.operand, instruction.target, thread.obligations);
+                    break;
+                }
+                bool is_held = std::ranges::binary_search(holds_sets_[context.holds],
+                                                          instruction.operand);
+                if (is_held != look.is_negative)
+                    pending.push_back({instruction.target, thread.obligations});
+                break;
+            }
+            case OpCode::Backref:
+                assert(false && "[Automaton::Builder::closure] backreferences are rejected");
+                std::unreachable();
+        }
+    }
+
+    // A thread without obligations covers the threads at the same instruction with obligations.
+    std::ranges::sort(stopped);
+    std::vector<Thread> threads;
+    for (const Thread &thread : stopped) {
+        if (threads.empty() || threads.back().pc != thread.pc || threads.back().obligations != 0)
+            threads.push_back(thread);
+    }
+    return thread_sets_.intern(std::move(threads));
+}
+
+auto strex::Automaton::Builder::step(std::uint32_t threads, std::size_t byte_class,
+                                     std::uint32_t holds) -> std::uint32_t {
+    auto key = std::make_tuple(threads, byte_class, holds);
+    if (auto iter = steps_.find(key); iter != steps_.end())
+        return iter->second;
+
+    unsigned char byte = class_representatives_[byte_class];
+    std::vector<Thread> seeds;
+    // Copied, because advancing obligations adds thread sets.
+    std::vector<Thread> current = thread_sets_[threads];
+    for (auto [pc, obligations] : current) {
+        const Instruction &instruction = instructions_[pc];
+        std::uint32_t next_pc;
+        if (instruction.op == OpCode::Byte && byte_sets_[instruction.operand].test(byte))
+            next_pc = pc + 1;
+        else if (instruction.op == OpCode::Look_End)
+            next_pc = pc;
+        else
+            continue;
+        std::uint32_t next_obligations = step_obligations(obligations, byte_class, holds);
+        if (next_obligations != failed)
+            seeds.push_back({next_pc, next_obligations});
+    }
+    std::uint32_t next = closure(std::move(seeds), {false, holds});
+    steps_.emplace(key, next);
+    return next;
+}
+
+auto strex::Automaton::Builder::step_obligations(std::uint32_t obligations,
+                                                 std::size_t byte_class, std::uint32_t holds)
+    -> std::uint32_t {
+    if (obligations == 0)
+        return 0;
+    auto key = std::make_tuple(obligations, byte_class, holds);
+    if (auto iter = obligation_steps_.find(key); iter != obligation_steps_.end())
+        return iter->second;
+
+    std::vector<Obligation> next;
+    std::uint32_t result = 0;
+    // Copied, because `step` adds obligation sets.
+    std::vector<Obligation> current = obligation_sets_[obligations];
+    for (auto [lookaround, threads] : current) {
+        std::uint32_t next_threads = step(threads, byte_class, holds);
+        Outcome outcome = resolve(lookaround, next_threads);
+        if (outcome == Outcome::Failed) {
+            result = failed;
+            break;
+        }
+        if (outcome == Outcome::Pending)
+            next.push_back({lookaround, next_threads});
+    }
+    if (result != failed) {
+        std::ranges::sort(next);
+        next.erase(std::ranges::unique(next).begin(), next.end());
+        result = obligation_sets_.intern(std::move(next));
+    }
+    obligation_steps_.emplace(key, result);
+    return result;
+}
+
+auto strex::Automaton::Builder::resolve(std::uint32_t lookaround, std::uint32_t threads) const
+    -> Outcome {
+    bool is_matched = std::ranges::binary_search(thread_sets_[threads],
+                                                 Thread{look_end(lookaround), 0});
+    bool is_empty = threads == 0;
+    if (lookarounds_[lookaround].is_negative)
+        std::swap(is_matched, is_empty);
+    if (is_matched)
+        return Outcome::Satisfied;
+    return is_empty ? Outcome::Failed : Outcome::Pending;
+}
+
+bool strex::Automaton::Builder::is_satisfied_at_end(std::uint32_t obligations) {
+    if (obligations >= satisfied_at_end_.size())
+        satisfied_at_end_.resize(obligation_sets_.size(), -1);
+    if (satisfied_at_end_[obligations] >= 0)
+        return satisfied_at_end_[obligations] != 0;
+
+    bool is_satisfied = true;
+    for (auto [lookaround, threads] : obligation_sets_[obligations]) {
+        bool is_matched = std::ranges::any_of(thread_sets_[threads], [&](const Thread &thread) {
+            return thread.pc == look_end(lookaround) && is_satisfied_at_end(thread.obligations);
+        });
+        if (is_matched == lookarounds_[lookaround].is_negative) {
+            is_satisfied = false;
+            break;
+        }
+    }
+    satisfied_at_end_[obligations] = is_satisfied ? 1 : 0;
+    return is_satisfied;
+}
+
+auto strex::Automaton::Builder::step_tracker(std::uint32_t tracker, std::size_t byte_class)
+    -> std::uint32_t {
+    // A lookbehind body has to end exactly at a position, so `Look_End` does not stay.
+    unsigned char byte = class_representatives_[byte_class];
+    std::vector<Thread> seeds = lookbehind_starts_;
+    for (auto [pc, obligations] : thread_sets_[tracker]) {
+        const Instruction &instruction = instructions_[pc];
+        if (instruction.op == OpCode::Byte && byte_sets_[instruction.operand].test(byte))
+            seeds.push_back({pc + 1, 0});
+    }
+    return closure(std::move(seeds), {false, 0});
+}
+
+auto strex::Automaton::Builder::holds(std::uint32_t tracker) -> std::uint32_t {
+    std::vector<std::uint32_t> held;
+    for (std::uint32_t index = 0; index < lookarounds_.size(); index++) {
+        if (lookarounds_[index].is_lookbehind &&
+            std::ranges::binary_search(thread_sets_[tracker], Thread{look_end(index), 0}))
+            held.push_back(index);
+    }
+    return holds_sets_.intern(std::move(held));
+}
+
+auto strex::Automaton::Builder::state(std::uint32_t tracker, std::uint32_t threads)
+    -> std::uint32_t {
+    // Without main threads nothing is accepted anymore.
+    if (threads == 0 && !states_.empty())
+        return dead_state;
+    auto [iter, is_new] = state_ids_.try_emplace({tracker, threads},
+                                                 static_cast<std::uint32_t>(states_.size()));
+    if (is_new) {
+        if (states_.size() >= max_states)
+            throw SyntaxNotSupport("lookarounds make the automaton too large");
+        states_.emplace_back(tracker, threads);
+    }
+    return iter->second;
+}
+
+void strex::Automaton::Builder::split_classes(const ASTNode *ast) {
+    // Bytes in the same byte sets behave the same, a DFA state has a transition per class.
+    std::map<std::vector<bool>, std::uint16_t> class_ids;
+    for (unsigned byte = 0; byte <= UCHAR_MAX; byte++) {
+        std::vector<bool> membership;
+        membership.reserve(byte_sets_.size());
+        for (const Program::ByteSet &bytes : byte_sets_)
+            membership.push_back(bytes.test(byte));
+        auto [iter, is_new] = class_ids.try_emplace(
+            std::move(membership), static_cast<std::uint16_t>(class_representatives_.size()));
+        if (is_new) {
+            class_representatives_.push_back(static_cast<unsigned char>(byte));
+            automaton_.class_bytes_.emplace_back();
+        }
+        automaton_.classes_[byte] = iter->second;
+    }
+
+    // Like `Generator`, charsets generate printable characters, and text is generated as is.
+    Program::ByteSet generated;
+    for (unsigned char ch = ' '; ch <= '~'; ch++)
+        generated.set(ch);
+    std::vector<const ASTNode *> pending{ast};
+    while (!pending.empty()) {
+        const ASTNode *node = pending.back();
+        pending.pop_back();
+        if (auto *text = dynamic_cast<const TextNode *>(node)) {
+            for (char ch : text->text())
+                generated.set(static_cast<unsigned char>(ch));
+        } else if (auto *charset = dynamic_cast<const CharsetNode *>(node)) {
+            // Non-ASCII code points are generated as bytes of their UTF-8 sequences, a walk only
+            // reaches the ones the DFA accepts.
+            auto others = unicode::intersect(charset->charset()->generated(),
+                                             {{0x80, unicode::max_code_point}});
+            for (const unicode::Utf8Sequence &sequence : unicode::utf8_sequences(others)) {
+                for (unicode::ByteRange range : sequence) {
+                    for (unsigned byte = range.first; byte <= range.last; byte++)
+                        generated.set(byte);
+                }
+            }
+        } else if (auto *sequence = dynamic_cast<const SequenceNode *>(node)) {
+            for (const auto &element : sequence->sequence())
+                pending.push_back(element.get());
+        } else if (auto *alternation = dynamic_cast<const AlternationNode *>(node)) {
+            for (const auto &element : alternation->elements())
+                pending.push_back(element.get());
+        } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+            pending.push_back(repeat->content());
+        } else if (auto *group = dynamic_cast<const GroupNode *>(node)) {
+            pending.push_back(group->content());
+        } else if (auto *lookaround = dynamic_cast<const LookaroundNode *>(node)) {
+            pending.push_back(lookaround->content());
+        }
+    }
+    for (unsigned byte = 0; byte <= UCHAR_MAX; byte++) {
+        if (generated.test(byte))
+            automaton_.class_bytes_[automaton_.classes_[byte]].push_back(static_cast<char>(byte));
+    }
+}
+
+// Returns the length of the longest string that `Generator` could generate from the AST,
+// saturated at `limit`. Lookarounds consume nothing. Sets `is_capped` if an open-ended repeat
+// outside lookarounds bounds the length with the repeat ceiling of the parser.
+static std::size_t longest_length(const strex::ASTNode *ast, std::size_t limit,
+                                  bool &is_capped) {
+    auto add = [limit](std::size_t lhs, std::size_t rhs) { return std::min(lhs + rhs, limit); };
+
+    // Nodes are visited twice, children are computed before their parent on the second visit.
+    std::vector<std::pair<const strex::ASTNode *, bool>> pending{{ast, false}};
+    std::vector<std::size_t> lengths;
+    while (!pending.empty()) {
+        auto [node, is_computed] = pending.back();
+        pending.pop_back();
+        if (auto *text = dynamic_cast<const strex::TextNode *>(node)) {
+            lengths.push_back(std::min(text->text().size(), limit));
+        } else if (auto *charset = dynamic_cast<const strex::CharsetNode *>(node)) {
+            // The longest UTF-8 sequence is the one of the largest code point.
+            const auto &generated = charset->charset()->generated();
+            char buffer[4];
+            std::size_t length = 1;
+            if (!generated.empty())
+                length = strex::unicode::encode_utf8(generated.back().last, buffer);
+            lengths.push_back(length);
+        } else if (auto *sequence = dynamic_cast<const strex::SequenceNode *>(node)) {
+            if (!is_computed) {
+                pending.emplace_back(node, true);
+                for (const auto &element : sequence->sequence())
+                    pending.emplace_back(element.get(), false);
+                continue;
+            }
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < sequence->sequence().size(); i++) {
+                length = add(length, lengths.back());
+                lengths.pop_back();
+            }
+            lengths.push_back(length);
+        } else if (auto *alternation = dynamic_cast<const strex::AlternationNode *>(node)) {
+            if (!is_computed) {
+                pending.emplace_back(node, true);
+                for (const auto &element : alternation->elements())
+                    pending.emplace_back(element.get(), false);
+                continue;
+            }
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < alternation->elements().size(); i++) {
+                length = std::max(length, lengths.back());
+                lengths.pop_back();
+            }
+            lengths.push_back(length);
+        } else if (auto *repeat = dynamic_cast<const strex::RepeatNode *>(node)) {
+            if (!is_computed) {
+                pending.emplace_back(node, true);
+                pending.emplace_back(repeat->content(), false);
+                continue;
+            }
+            auto upper = static_cast<std::size_t>(repeat->repeat_upper());
+            std::size_t content = lengths.back();
+            is_capped |= repeat->is_open_ended() && content > 0;
+            lengths.back() = content == 0 ? 0 : std::min(content * std::min(upper, limit), limit);
+        } else if (auto *group = dynamic_cast<const strex::GroupNode *>(node)) {
+            // A group adds nothing, its content leaves its length.
+            pending.emplace_back(group->content(), false);
+        } else {
+            // Anchors and lookarounds, backreferences are rejected before.
+            lengths.push_back(0);
+        }
+    }
+    assert(lengths.size() == 1);
+    return lengths.back();
+}
+
+strex::Automaton::Automaton(const ASTNode *ast) {
+    assert(ast != nullptr);
+    Program program(ast);
+    Builder builder(*this, program);
+    builder.split_classes(ast);
+    builder.build();
+
+    max_length_ = longest_length(ast, max_counts / accepting_.size(), is_capped_);
+    count_paths();
+}
+
+void strex::Automaton::count_paths() {
+    std::size_t state_count = accepting_.size();
+    if ((max_length_ + 1) * state_count > max_counts)
+        throw SyntaxNotSupport("lookarounds make the automaton too large");
+
+    // Counts overflow doubles for long strings, so each length is scaled by its largest count.
+    // Sampling only compares counts of the same length.
+    counts_.assign((max_length_ + 1) * state_count, 0.0);
+    for (std::uint32_t state = 0; state < state_count; state++)
+        counts_[state] = accepting_[state] ? 1.0 : 0.0;
+    for (std::size_t length = 1; length <= max_length_; length++) {
+        double *layer = &counts_[length * state_count];
+        double largest = 0.0;
+        for (std::uint32_t state = 0; state < state_count; state++) {
+            double total = 0.0;
+            for (std::size_t byte_class = 0; byte_class < class_bytes_.size(); byte_class++) {
+                total += static_cast<double>(class_bytes_[byte_class].size()) *
+                         count(length - 1, next(state, byte_class));
+            }
+            layer[state] = total;
+            largest = std::max(largest, total);
+        }
+        if (largest > 0.0) {
+            for (std::uint32_t state = 0; state < state_count; state++)
+                layer[state] /= largest;
+        }
+    }
+
+    for (std::size_t length = 0; length <= max_length_; length++) {
+        if (count(length, start_state_) > 0.0)
+            lengths_.push_back(length);
+    }
+}
+
+std::string strex::Automaton::generate(BlockEngine &engine, std::uint64_t &random_draws,
+                                      std::size_t max_bytes) const {
+    if (lengths_.empty() && is_capped_)
+        throw GenerateError("failed to generate string: no string matches the regex with "
+                            "open-ended repeats outside lookarounds capped at max_repeat, raise "
+                            "max_repeat to satisfy the lookarounds");
+    if (lengths_.empty())
+        throw GenerateError("failed to generate string: no string matches the regex");
+    // Lengths are in increasing order.
+    auto length_count = static_cast<std::size_t>(std::ranges::upper_bound(lengths_, max_bytes) -
+                                                 lengths_.begin());
+    if (length_count == 0)
+        throw GenerateError("failed to generate string: no string fits the byte budget");
+
+    std::uniform_int_distribution<std::size_t> random_length(0, length_count - 1);
+    random_draws++;
+    std::size_t length = lengths_[random_length(engine)];
+
+    std::string generated;
+    generated.reserve(length);
+    std::uint32_t state = start_state_;
+    for (std::size_t remaining = length; remaining > 0; remaining--) {
+        // Each class is weighted by the strings that it leads to.
+        double total = 0.0;
+        for (std::size_t byte_class = 0; byte_class < class_bytes_.size(); byte_class++) {
+            total += static_cast<double>(class_bytes_[byte_class].size()) *
+                     count(remaining - 1, next(state, byte_class));
+        }
+        std::uniform_real_distribution<double> random_weight(0.0, total);
+        random_draws++;
+        double weight = random_weight(engine);
+
+        std::size_t chosen = class_bytes_.size();
+        for (std::size_t byte_class = 0; byte_class < class_bytes_.size(); byte_class++) {
+            double share = static_cast<double>(class_bytes_[byte_class].size()) *
+                           count(remaining - 1, next(state, byte_class));
+            if (share <= 0.0)
+                continue;
+            // The last class with a share absorbs rounding errors.
+            chosen = byte_class;
+            if (weight < share)
+                break;
+            weight -= share;
+        }
+        assert(chosen < class_bytes_.size());
+
+        const std::string &bytes = class_bytes_[chosen];
+        std::size_t index = 0;
+        if (bytes.size() > 1) {
+            std::uniform_int_distribution<std::size_t> random_byte(0, bytes.size() - 1);
+            random_draws++;
+            index = random_byte(engine);
+        }
+        generated.push_back(bytes[index]);
+        state = next(state, chosen);
+    }
+    return generated;
+}
+
+bool strex::Automaton::matches(std::string_view text) const {
+    std::uint32_t state = start_state_;
+    for (char ch : text) {
+        state = next(state, classes_[static_cast<unsigned char>(ch)]);
+        if (state == dead_state)
+            return false;
+    }
+    return accepting_[state];
+}
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <string>
+
+#include <strex/AST.hpp>
+#include <strex/BatchGenerator.hpp>
+#include <strex/Charset.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Random.hpp>
+#include <strex/Unicode.hpp>
+
+// Calls `function` with the index of each lane in `mask`.
+template <typename Function>
+static void for_each_lane(std::uint64_t mask, Function function) {
+    while (mask != 0) {
+        function(static_cast<std::size_t>(std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+
+strex::BatchGenerator::BatchGenerator(const ASTNode *ast) {
+    assert(ast != nullptr);
+    compile(ast);
+}
+
+void strex::BatchGenerator::compile(const ASTNode *ast) {
+    // Like `Program::Compiler`, nodes are compiled from an explicit stack, and the end of a step
+    // is patched when the steps inside it are compiled.
+    enum class CompileType { Visit, Close, Alternative };
+    struct CompileTask {
+        CompileType type;
+        const ASTNode *node;
+        std::uint32_t step{0};
+        std::uint32_t alternative{0};
+    };
+    auto next_step = [this] { return static_cast<std::uint32_t>(steps_.size()); };
+
+    std::vector<CompileTask> pending{{CompileType::Visit, ast}};
+    while (!pending.empty()) {
+        CompileTask task = pending.back();
+        pending.pop_back();
+        if (task.type == CompileType::Close) {
+            steps_[task.step].end = next_step();
+            continue;
+        }
+        if (task.type == CompileType::Alternative) {
+            alternatives_[steps_[task.step].value + task.alternative] = next_step();
+            continue;
+        }
+
+        const ASTNode *node = task.node;
+        if (auto *text = dynamic_cast<const TextNode *>(node)) {
+            if (text->text().empty())
+                continue;
+            steps_.push_back({StepType::Text, next_step() + 1,
+                              static_cast<std::uint32_t>(texts_.size())});
+            texts_.push_back(text->text());
+        } else if (auto *charset_node = dynamic_cast<const CharsetNode *>(node)) {
+            const Charset *charset = charset_node->charset();
+            CharsetStep charset_step{charset, {}};
+            for (std::size_t i = 0; i < charset->size(); i++) {
+                char32_t code_point = charset->at(i);
+                if (code_point >= 0x80) {
+                    charset_step.ascii.clear();
+                    // A character may be longer than others.
+                    is_fixed_shape_ = false;
+                    break;
+                }
+                charset_step.ascii.push_back(static_cast<char>(code_point));
+            }
+            steps_.push_back({StepType::Charset, next_step() + 1,
+                              static_cast<std::uint32_t>(charsets_.size())});
+            charsets_.push_back(std::move(charset_step));
+        } else if (auto *sequence = dynamic_cast<const SequenceNode *>(node)) {
+            for (const auto &element : sequence->sequence() | std::views::reverse)
+                pending.push_back({CompileType::Visit, element.get()});
+        } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+            auto lower = static_cast<std::uint32_t>(repeat->repeat_lower());
+            auto upper = static_cast<std::uint32_t>(repeat->repeat_upper());
+            if (upper == 0)
+                continue;
+            if (lower != upper)
+                is_fixed_shape_ = false;
+            steps_.push_back({StepType::Repeat, 0, 0, lower, upper});
+            pending.push_back({CompileType::Close, node, next_step() - 1});
+            pending.push_back({CompileType::Visit, repeat->content()});
+        } else if (auto *group = dynamic_cast<const GroupNode *>(node)) {
+            if (!group->is_referenced()) {
+                pending.push_back({CompileType::Visit, group->content()});
+                continue;
+            }
+            auto index = static_cast<std::uint32_t>(group->index());
+            if (index >= captures_.size())
+                captures_.resize(index + 1);
+            steps_.push_back({StepType::Group, 0, index});
+            pending.push_back({CompileType::Close, node, next_step() - 1});
+            pending.push_back({CompileType::Visit, group->content()});
+        } else if (auto *alternation = dynamic_cast<const AlternationNode *>(node)) {
+            const auto &elements = alternation->elements();
+            if (elements.size() <= 1) {
+                if (!elements.empty())
+                    pending.push_back({CompileType::Visit, elements[0].get()});
+                continue;
+            }
+            is_fixed_shape_ = false;
+            auto count = static_cast<std::uint32_t>(elements.size());
+            steps_.push_back({StepType::Alternation, 0,
+                              static_cast<std::uint32_t>(alternatives_.size()), count});
+            alternatives_.resize(alternatives_.size() + count);
+            std::uint32_t step = next_step() - 1;
+            pending.push_back({CompileType::Close, node, step});
+            for (std::uint32_t i = count; i-- > 0;) {
+                pending.push_back({CompileType::Visit, elements[i].get()});
+                pending.push_back({CompileType::Alternative, node, step, i});
+            }
+        } else if (auto *backref = dynamic_cast<const BackrefNode *>(node)) {
+            steps_.push_back({StepType::Backref, next_step() + 1,
+                              static_cast<std::uint32_t>(backref->group()->index())});
+        } else if (dynamic_cast<const LookaroundNode *>(node) != nullptr) {
+            throw SyntaxNotSupport("lookarounds cannot be generated in batches");
+        }
+        // Anchors at the edges of a pattern always hold, like in `Generator`.
+    }
+}
+
+auto strex::BatchGenerator::generate() -> const std::array<std::string, lanes> & {
+    columns_.clear();
+    for (std::string &string : strings_)
+        string.clear();
+    for (Capture &capture : captures_)
+        capture.captured = 0;
+
+    tasks_.push_back({TaskType::Run, 0, static_cast<std::uint32_t>(steps_.size()), ~Mask{0}});
+    while (!tasks_.empty()) {
+        Task task = tasks_.back();
+        tasks_.pop_back();
+        switch (task.type) {
+            case TaskType::Run:
+                if (task.begin == task.end)
+                    break;
+                tasks_.push_back({TaskType::Run, steps_[task.begin].end, task.end, task.mask});
+                run(task.begin, task.mask);
+                break;
+            case TaskType::Repeat: {
+                LaneValues &remaining = lane_values_.back();
+                Mask active = 0;
+                for_each_lane(task.mask, [&](std::size_t lane) {
+                    if (remaining[lane] > 0) {
+                        remaining[lane]--;
+                        active |= Mask{1} << lane;
+                    }
+                });
+                if (active == 0) {
+                    lane_values_.pop_back();
+                    break;
+                }
+                tasks_.push_back({TaskType::Repeat, task.begin, task.end, active});
+                tasks_.push_back({TaskType::Run, task.begin + 1, task.end, active});
+                break;
+            }
+            case TaskType::Close_Group: {
+                Capture &capture = captures_[steps_[task.begin].value];
+                const LaneValues &starts = lane_values_.back();
+                for_each_lane(task.mask, [&](std::size_t lane) {
+                    capture.offsets[lane] = starts[lane];
+                    capture.lengths[lane] = position(lane) - starts[lane];
+                });
+                capture.captured |= task.mask;
+                lane_values_.pop_back();
+                break;
+            }
+        }
+    }
+
+    if (is_fixed_shape_) {
+        // Transposes columns into strings.
+        std::size_t width = columns_.size() / lanes;
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            std::string &string = strings_[lane];
+            string.resize(width);
+            for (std::size_t column = 0; column < width; column++)
+                string[column] = columns_[column * lanes + lane];
+        }
+    }
+    return strings_;
+}
+
+void strex::BatchGenerator::run(std::uint32_t index, Mask mask) {
+    const Step &step = steps_[index];
+    switch (step.type) {
+        case StepType::Text:
+            append_text(texts_[step.value], mask);
+            break;
+        case StepType::Charset:
+            append_charset(charsets_[step.value], mask);
+            break;
+        case StepType::Repeat: {
+            LaneValues remaining;
+            if (step.lower == step.upper) {
+                remaining.fill(step.lower);
+            } else {
+                draw(step.upper - step.lower + 1, mask);
+                for (std::size_t lane = 0; lane < lanes; lane++)
+                    remaining[lane] = step.lower + draws_[lane];
+            }
+            lane_values_.push_back(remaining);
+            tasks_.push_back({TaskType::Repeat, index, step.end, mask});
+            break;
+        }
+        case StepType::Alternation: {
+            draw(step.lower, mask);
+            for (std::uint32_t i = 0; i < step.lower; i++) {
+                Mask chosen = 0;
+                for_each_lane(mask, [&](std::size_t lane) {
+                    if (draws_[lane] == i)
+                        chosen |= Mask{1} << lane;
+                });
+                if (chosen == 0)
+                    continue;
+                std::uint32_t begin = alternatives_[step.value + i];
+                std::uint32_t end =
+                    i + 1 < step.lower ? alternatives_[step.value + i + 1] : step.end;
+                tasks_.push_back({TaskType::Run, begin, end, chosen});
+            }
+            break;
+        }
+        case StepType::Group: {
+            LaneValues starts;
+            for (std::size_t lane = 0; lane < lanes; lane++)
+                starts[lane] = position(lane);
+            lane_values_.push_back(starts);
+            tasks_.push_back({TaskType::Close_Group, index, step.end, mask});
+            tasks_.push_back({TaskType::Run, index + 1, step.end, mask});
+            break;
+        }
+        case StepType::Backref:
+            // for regex like `(abc)|\1`
+            if (step.value < captures_.size())
+                append_backref(captures_[step.value], mask & captures_[step.value].captured);
+            break;
+    }
+}
+
+void strex::BatchGenerator::draw(std::uint32_t bound, Mask mask) {
+    assert(bound > 1);
+    random_draws_ += static_cast<std::uint64_t>(std::popcount(mask));
+
+    // Lanes are independent, so the loop is vectorized.
+    const std::uint32_t *words = engine_.take(lanes);
+    Mask biased = 0;
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+        draws_[lane] = reduce(words[lane], bound);
+        biased |= Mask{draws_[lane] == bound} << lane;
+    }
+    // A biased value is rare, and is drawn again for that lane only.
+    for_each_lane(biased & mask, [&](std::size_t lane) {
+        do {
+            draws_[lane] = reduce(engine_(), bound);
+        } while (draws_[lane] == bound);
+    });
+}
+
+std::uint32_t strex::BatchGenerator::position(std::size_t lane) const {
+    if (is_fixed_shape_)
+        return static_cast<std::uint32_t>(columns_.size() / lanes);
+    return static_cast<std::uint32_t>(strings_[lane].size());
+}
+
+void strex::BatchGenerator::append_text(const std::string &text, Mask mask) {
+    if (!is_fixed_shape_) {
+        for_each_lane(mask, [&](std::size_t lane) { strings_[lane].append(text); });
+        return;
+    }
+    std::size_t offset = columns_.size();
+    columns_.resize(offset + text.size() * lanes);
+    for (char ch : text) {
+        std::fill_n(columns_.begin() + static_cast<std::ptrdiff_t>(offset), lanes, ch);
+        offset += lanes;
+    }
+}
+
+void strex::BatchGenerator::append_charset(const CharsetStep &charset, Mask mask) {
+    std::size_t size = charset.charset->size();
+    if (size == 0)
+        return;
+    if (size == 1) {
+        std::string text;
+        unicode::append_utf8(text, charset.charset->at(0));
+        append_text(text, mask);
+        return;
+    }
+
+    draw(static_cast<std::uint32_t>(size), mask);
+    if (is_fixed_shape_) {
+        std::size_t offset = columns_.size();
+        columns_.resize(offset + lanes);
+        for (std::size_t lane = 0; lane < lanes; lane++)
+            columns_[offset + lane] = charset.ascii[draws_[lane]];
+    } else if (!charset.ascii.empty()) {
+        for_each_lane(mask, [&](std::size_t lane) {
+            strings_[lane].push_back(charset.ascii[draws_[lane]]);
+        });
+    } else {
+        for_each_lane(mask, [&](std::size_t lane) {
+            unicode::append_utf8(strings_[lane], charset.charset->at(draws_[lane]));
+        });
+    }
+}
+
+void strex::BatchGenerator::append_backref(const Capture &capture, Mask mask) {
+    if (!is_fixed_shape_) {
+        for_each_lane(mask, [&](std::size_t lane) {
+            std::string &string = strings_[lane];
+            string.append(string, capture.offsets[lane], capture.lengths[lane]);
+        });
+        return;
+    }
+    // All lanes capture the same columns.
+    if (mask == 0)
+        return;
+    std::size_t offset = columns_.size();
+    std::size_t length = capture.lengths[0] * lanes;
+    columns_.resize(offset + length);
+    std::copy_n(columns_.begin() + static_cast<std::ptrdiff_t>(capture.offsets[0] * lanes),
+                length, columns_.begin() + static_cast<std::ptrdiff_t>(offset));
+}
\ No newline at end of file
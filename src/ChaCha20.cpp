@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/random.h>
+#endif
+
+#include <strex/ChaCha20.hpp>
+#include <strex/Cpu.hpp>
+#include <strex/Exception.hpp>
+
+// Fills `data` with bytes from the cryptographically secure generator of the OS.
+static void read_entropy(void *data, std::size_t size) {
+#if defined(__linux__)
+    auto *bytes = static_cast<unsigned char *>(data);
+    while (size > 0) {
+        ssize_t count = getrandom(bytes, size, 0);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw strex::GenerateError("failed to read entropy from getrandom");
+        }
+        bytes += count;
+        size -= static_cast<std::size_t>(count);
+    }
+#else
+    // Standard libraries on other systems read `std::random_device` from the OS generator.
+    std::random_device device;
+    auto *bytes = static_cast<unsigned char *>(data);
+    for (std::size_t i = 0; i < size; i += sizeof(unsigned int)) {
+        unsigned int value = device();
+        std::memcpy(bytes + i, &value, std::min(sizeof(value), size - i));
+    }
+#endif
+}
+
+strex::ChaCha20::ChaCha20() : is_rekeyed_(true) {
+    rekey();
+}
+
+strex::ChaCha20::ChaCha20(const Key &key, std::uint64_t nonce, std::uint64_t counter)
+    : key_(key), nonce_(nonce), counter_(counter) {}
+
+void strex::ChaCha20::rekey() {
+    if (next_key_ == keys_.size()) {
+        read_entropy(keys_.data(), sizeof(keys_));
+        next_key_ = 0;
+    }
+    key_ = keys_[next_key_];
+    // A used key is not kept.
+    keys_[next_key_++] = {};
+    counter_ = 0;
+    generated_ = 0;
+}
+
+void strex::ChaCha20::refill() {
+    if (is_rekeyed_ && generated_ >= rekey_interval)
+        rekey();
+
+    // "expand 32-byte k"
+    constexpr std::array<std::uint32_t, 4> constants{0x61707865, 0x3320646E, 0x79622D32,
+                                                     0x6B206574};
+    // Word `i` of every lane is at `input[i]`, so each step of a round is a loop over lanes.
+    std::uint32_t input[block_words][lanes];
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+        std::uint64_t counter = counter_ + lane;
+        for (std::size_t i = 0; i < 4; i++)
+            input[i][lane] = constants[i];
+        for (std::size_t i = 0; i < 8; i++)
+            input[4 + i][lane] = key_[i];
+        input[12][lane] = static_cast<std::uint32_t>(counter);
+        input[13][lane] = static_cast<std::uint32_t>(counter >> 32);
+        input[14][lane] = static_cast<std::uint32_t>(nonce_);
+        input[15][lane] = static_cast<std::uint32_t>(nonce_ >> 32);
+    }
+    counter_ += lanes;
+    generated_ += sizeof(buffer_);
+
+    cpu::active().chacha20_blocks(&input[0][0], buffer_.data());
+    position_ = 0;
+}
\ No newline at end of file
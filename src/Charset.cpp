@@ -1,11 +1,16 @@
 #include <algorithm>
+#include <bitset>
 #include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <set>
-#include <string_view>
+#include <string>
 #include <tuple>
 #include <utility>
 
 #include <strex/Charset.hpp>
+#include <strex/Unicode.hpp>
 
 #define DIGIT_CHARACTERS "0123456789"
 #define UPPER_CHARACTERS "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -15,11 +20,39 @@
 #define WORD_CHARACTERS  DIGIT_CHARACTERS UPPER_CHARACTERS LOWER_CHARACTERS UNDER_SCROLL
 
 auto strex::Charset::get(std::string alphabet, bool is_inclusive) -> const Charset * {
+    // Collects characters in linear time, an alphabet may be very long.
+    std::bitset<UCHAR_MAX + 1> included;
+    for (char ch : alphabet)
+        included.set(static_cast<unsigned char>(ch));
+    Ranges ranges;
+    for (char32_t ch = 0; ch <= UCHAR_MAX; ch++) {
+        if (!included.test(ch))
+            continue;
+        if (!ranges.empty() && ranges.back().last + 1 == ch)
+            ranges.back().last = ch;
+        else
+            ranges.push_back({ch, ch});
+    }
+    Ranges generated = is_inclusive ? ranges : Ranges{unicode::ascii_printable};
+    return intern({std::move(ranges), std::move(generated), is_inclusive});
+}
+
+auto strex::Charset::get(Ranges ranges, Ranges generated) -> const Charset * {
+    unicode::normalize(ranges);
+    unicode::normalize(generated);
+    return intern({std::move(ranges), std::move(generated), true});
+}
+
+auto strex::Charset::from_property(std::uint32_t categories, bool is_inclusive)
+    -> const Charset * {
+    Ranges ranges = unicode::category_ranges(categories);
+    Ranges generated = is_inclusive ? ranges : Ranges{unicode::ascii_printable};
+    return intern({std::move(ranges), std::move(generated), is_inclusive});
+}
+
+auto strex::Charset::intern(Charset charset) -> const Charset * {
     static std::set<Charset> charsets;
-    std::ranges::sort(alphabet);
-    auto [first, last] = std::ranges::unique(alphabet);
-    alphabet.erase(first, last);
-    auto [iter, _] = charsets.insert({std::move(alphabet), is_inclusive});
+    auto [iter, _] = charsets.insert(std::move(charset));
     return &(*iter);
 }
 
@@ -46,56 +79,64 @@ auto strex::Charset::from_char_class(char char_class) -> const Charset * {
 }
 
 auto strex::Charset::digits() -> const Charset * {
-    return get(DIGIT_CHARACTERS, true);
+    static const Charset *charset = get(DIGIT_CHARACTERS, true);
+    return charset;
 }
 
 auto strex::Charset::non_digit() -> const Charset * {
-    return get(DIGIT_CHARACTERS, false);
+    static const Charset *charset = get(DIGIT_CHARACTERS, false);
+    return charset;
 }
 
 auto strex::Charset::word() -> const Charset * {
-    return get(WORD_CHARACTERS, true);
+    static const Charset *charset = get(WORD_CHARACTERS, true);
+    return charset;
 }
 
 auto strex::Charset::non_word() -> const Charset * {
-    return get(WORD_CHARACTERS, false);
+    static const Charset *charset = get(WORD_CHARACTERS, false);
+    return charset;
 }
 
 auto strex::Charset::space() -> const Charset * {
-    return get(SPACE_CHARACTERS, true);
+    static const Charset *charset = get(SPACE_CHARACTERS, true);
+    return charset;
 }
 
 auto strex::Charset::non_space() -> const Charset * {
-    return get(SPACE_CHARACTERS, false);
+    static const Charset *charset = get(SPACE_CHARACTERS, false);
+    return charset;
 }
 
 auto strex::Charset::any() -> const Charset * {
-    auto all_characters = [] {
-        std::string s;
-        s.resize_and_overwrite(128, [](char *s, std::size_t) {
-            int i;
-            char ch = '\0';
-            for (i = 0; i < 127; i++, ch++) {
-                s[i] = ch;
-                // Skip newline characters as they cannot be matched by `.`.
-                if (ch == '\n')
-                    i--;
-            }
-            return i;
-        });
-        return s;
-    }();
-    return get(std::move(all_characters), true);
+    // Only `\n` cannot be matched by `.`.
+    static const Charset *charset = get("\n", false);
+    return charset;
 }
 
-std::string_view strex::Charset::alphabet() const {
-    assert(std::ranges::is_sorted(alphabet_));
-    return alphabet_;
+auto strex::Charset::members() const -> Ranges {
+    return is_inclusive_ ? ranges_ : unicode::complement(ranges_);
+}
+
+char32_t strex::Charset::at(std::size_t index) const {
+    assert(index < size_);
+    auto iter = std::ranges::upper_bound(starts_, index);
+    auto range = static_cast<std::size_t>(iter - starts_.begin()) - 1;
+    return generated_[range].first + static_cast<char32_t>(index - starts_[range]);
 }
 
 bool strex::Charset::operator<(const Charset &other) const {
-    return std::tie(alphabet_, is_inclusive_) < std::tie(other.alphabet_, other.is_inclusive_);
+    return std::tie(ranges_, is_inclusive_, generated_) <
+           std::tie(other.ranges_, other.is_inclusive_, other.generated_);
 }
 
-strex::Charset::Charset(std::string alphabet, bool is_inclusive)
-    : alphabet_(std::move(alphabet)), is_inclusive_(is_inclusive) {}
\ No newline at end of file
+strex::Charset::Charset(Ranges ranges, Ranges generated, bool is_inclusive)
+    : ranges_(std::move(ranges)), is_inclusive_(is_inclusive) {
+    assert(std::ranges::is_sorted(ranges_));
+    generated_ = unicode::intersect(unicode::intersect(generated, members()), unicode::printable());
+    starts_.reserve(generated_.size());
+    for (const CodePointRange &range : generated_) {
+        starts_.push_back(static_cast<std::uint32_t>(size_));
+        size_ += range.last - range.first + 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <strex/AST.hpp>
+#include <strex/Charset.hpp>
+#include <strex/CppEmitter.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Unicode.hpp>
+
+// Shared by all emitted headers, the guard lets several of them be included together.
+static constexpr std::string_view runtime = R"(#ifndef STREX_GENERATED_RUNTIME
+#define STREX_GENERATED_RUNTIME
+
+namespace strex_generated {
+
+/// SplitMix64 random engine.
+class Engine {
+ public:
+    explicit Engine(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t operator()() {
+        std::uint64_t z = state_ += 0x9E3779B97F4A7C15;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    /// Returns a uniform value in [0, bound) by Lemire's multiply-shift with rejection.
+    std::uint32_t below(std::uint32_t bound) {
+        while (true) {
+            std::uint64_t product = ((*this)() >> 32) * bound;
+            auto low = static_cast<std::uint32_t>(product);
+            if (low >= bound || low >= (0u - bound) % bound)
+                return static_cast<std::uint32_t>(product >> 32);
+        }
+    }
+
+ private:
+    std::uint64_t state_;
+};
+
+namespace detail {
+
+/// Appends the code point at `index` of a charset as UTF-8. The charset is given as `count`
+/// ranges of {first code point, index of the first code point}.
+inline void append_code_point(std::string &out, const std::uint32_t (*ranges)[2],
+                              std::size_t count, std::uint32_t index) {
+    std::size_t low = 0;
+    while (count > 1) {
+        std::size_t half = count / 2;
+        if (ranges[low + half][1] <= index)
+            low += half;
+        count -= half;
+    }
+    std::uint32_t code_point = ranges[low][0] + (index - ranges[low][1]);
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | code_point >> 6));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | code_point >> 12));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | code_point >> 18));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+} // namespace detail
+
+} // namespace strex_generated
+
+#endif
+)";
+
+// Keywords and alternative tokens of C++23, which cannot name a function.
+static constexpr std::string_view keywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept",
+    "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await",
+    "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+    "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+    "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"};
+
+// Names in namespace `strex_generated` and in the emitted function.
+static constexpr std::string_view emitted_names[] = {"Engine", "detail", "out", "engine"};
+
+// Prefixes of names of locals in the emitted function, a number or more follows them.
+static constexpr std::string_view emitted_prefixes[] = {"table_", "capture_", "begin_"};
+
+// Checks if `name` cannot name the emitted function: a keyword, a name the emitted code uses, or
+// an identifier reserved to the implementation.
+static bool is_reserved(std::string_view name) {
+    auto is_in = [&](const auto &names) {
+        return std::ranges::find(names, name) != std::ranges::end(names);
+    };
+    if (is_in(keywords) || is_in(emitted_names))
+        return true;
+    if (std::ranges::any_of(emitted_prefixes,
+                            [&](std::string_view prefix) { return name.starts_with(prefix); }))
+        return true;
+    // Loop variables are `i0`, `i1` and so on.
+    auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+    if (name.size() > 1 && name[0] == 'i' && std::ranges::all_of(name.substr(1), is_digit))
+        return true;
+    return name.contains("__") || (name.size() > 1 && name[0] == '_' && name[1] >= 'A' &&
+                                   name[1] <= 'Z');
+}
+
+strex::CppEmitter::CppEmitter(const ASTNode *ast, std::string_view name) : ast_(ast), name_(name) {
+    assert(ast != nullptr);
+    auto is_identifier_char = [](char c) {
+        return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9');
+    };
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9') ||
+        !std::ranges::all_of(name, is_identifier_char))
+        throw std::invalid_argument(std::format("invalid function name: \"{}\"", name));
+    if (is_reserved(name))
+        throw std::invalid_argument(
+            std::format("invalid function name: \"{}\" is reserved in C++ or in the header", name));
+}
+
+std::string strex::CppEmitter::quote(std::string_view text, char mark) {
+    std::string quoted(1, mark);
+    for (char c : text) {
+        if (c == mark || c == '\\') {
+            quoted.push_back('\\');
+            quoted.push_back(c);
+        } else if (c >= ' ' && c <= '~') {
+            quoted.push_back(c);
+        } else {
+            // Octal escapes have at most 3 digits, so a digit after them is not taken in.
+            quoted += std::format("\\{:03o}", static_cast<unsigned char>(c));
+        }
+    }
+    quoted.push_back(mark);
+    return quoted;
+}
+
+std::string strex::CppEmitter::emit(std::string_view regex) {
+    tables_.clear();
+    body_.clear();
+    loops_ = 0;
+    table_names_.clear();
+    groups_.clear();
+    tasks_.push_back({TaskType::Visit, ast_});
+    while (!tasks_.empty()) {
+        Task task = std::move(tasks_.back());
+        tasks_.pop_back();
+        switch (task.type) {
+            case TaskType::Visit:
+                visit(task.node);
+                break;
+            case TaskType::Line:
+                write(task.line);
+                break;
+            case TaskType::Text:
+                write_text(task.line);
+                break;
+            case TaskType::Open:
+                write(task.line);
+                indent_++;
+                break;
+            case TaskType::Close:
+                indent_--;
+                write(task.line);
+                break;
+        }
+    }
+
+    std::string header = "// Generated by `strex --emit-cpp`, do not edit.\n\n"
+                         "#pragma once\n\n"
+                         "#include <cstddef>\n"
+                         "#include <cstdint>\n"
+                         "#include <string>\n\n";
+    header += runtime;
+    header += "\nnamespace strex_generated {\n\n";
+    header += std::format("/// Appends a string that matches {}.\n", quote(regex));
+    header += std::format("inline void {}(std::string &out, Engine &engine) {{\n", name_);
+    header += tables_;
+    for (int group : groups_) {
+        header += std::format("    std::size_t capture_{}_offset = 0, capture_{}_length = 0;\n",
+                              group, group);
+    }
+    if (!tables_.empty() || !groups_.empty())
+        header += "\n";
+    header += body_;
+    header += "}\n\n";
+    header += std::format("inline std::string {}(Engine &engine) {{\n"
+                          "    std::string out;\n"
+                          "    {}(out, engine);\n"
+                          "    return out;\n"
+                          "}}\n\n",
+                          name_, name_);
+    header += "} // namespace strex_generated\n";
+    return header;
+}
+
+void strex::CppEmitter::write(std::string_view line) {
+    body_.append(static_cast<std::size_t>(indent_) * 4, ' ');
+    body_ += line;
+    body_ += '\n';
+}
+
+void strex::CppEmitter::write_text(std::string_view text) {
+    if (text.size() == 1)
+        write(std::format("out.push_back({});", quote(text, '\'')));
+    else if (!text.empty())
+        write(std::format("out.append({}, {});", quote(text), text.size()));
+}
+
+std::string strex::CppEmitter::table(const Charset *charset) {
+    auto [iter, is_new] =
+        table_names_.try_emplace(charset, std::format("table_{}", table_names_.size()));
+    if (!is_new)
+        return iter->second;
+
+    const auto &ranges = charset->generated();
+    if (ranges.back().last < 0x80) {
+        std::string characters;
+        for (std::size_t i = 0; i < charset->size(); i++)
+            characters.push_back(static_cast<char>(charset->at(i)));
+        tables_ += std::format("    static constexpr char {}[] = {};\n", iter->second,
+                               quote(characters));
+        return iter->second;
+    }
+    tables_ += std::format("    static constexpr std::uint32_t {}[][2] = {{\n", iter->second);
+    std::size_t start = 0;
+    for (const auto &range : ranges) {
+        auto first = static_cast<std::uint32_t>(range.first);
+        tables_ += std::format("        {{0x{:x}, {}}},\n", first, start);
+        start += range.last - range.first + 1;
+    }
+    tables_ += "    };\n";
+    return iter->second;
+}
+
+void strex::CppEmitter::emit_charset(const Charset *charset) {
+    if (charset->size() == 0)
+        return;
+    if (charset->size() == 1) {
+        std::string text;
+        unicode::append_utf8(text, charset->at(0));
+        write_text(text);
+        return;
+    }
+    std::string name = table(charset);
+    if (charset->generated().back().last < 0x80) {
+        write(std::format("out.push_back({}[engine.below({})]);", name, charset->size()));
+        return;
+    }
+    write(std::format("detail::append_code_point(out, {}, {}, engine.below({}));", name,
+                      charset->generated().size(), charset->size()));
+}
+
+void strex::CppEmitter::visit(const ASTNode *node) {
+    if (auto *text = dynamic_cast<const TextNode *>(node)) {
+        write_text(text->text());
+    } else if (auto *charset = dynamic_cast<const CharsetNode *>(node)) {
+        emit_charset(charset->charset());
+    } else if (auto *sequence = dynamic_cast<const SequenceNode *>(node)) {
+        // Adjacent texts are appended at once. The last pushed task runs first.
+        const auto &elements = sequence->sequence();
+        auto is_text = [&](std::size_t i) {
+            return dynamic_cast<const TextNode *>(elements[i].get()) != nullptr;
+        };
+        std::size_t end = elements.size();
+        while (end > 0) {
+            std::size_t begin = end;
+            while (begin > 0 && is_text(begin - 1))
+                begin--;
+            if (begin == end) {
+                tasks_.push_back({TaskType::Visit, elements[--end].get()});
+                continue;
+            }
+            std::string text;
+            for (std::size_t i = begin; i < end; i++)
+                text += static_cast<const TextNode *>(elements[i].get())->text();
+            tasks_.push_back({TaskType::Text, nullptr, std::move(text)});
+            end = begin;
+        }
+    } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+        int lower = repeat->repeat_lower();
+        int upper = repeat->repeat_upper();
+        const ASTNode *content = repeat->content();
+        if (upper == 0)
+            return;
+        if (auto *text = dynamic_cast<const TextNode *>(content); text && lower == upper) {
+            std::string repeated;
+            for (int i = 0; i < upper; i++)
+                repeated += text->text();
+            tasks_.push_back({TaskType::Text, nullptr, std::move(repeated)});
+            return;
+        }
+        bool is_character = dynamic_cast<const CharsetNode *>(content) != nullptr;
+        if (lower == upper && (upper == 1 || (is_character && upper <= max_unrolled))) {
+            for (int i = 0; i < upper; i++)
+                tasks_.push_back({TaskType::Visit, content});
+            return;
+        }
+        std::string i = std::format("i{}", loops_++);
+        tasks_.push_back({TaskType::Close, nullptr, "}"});
+        tasks_.push_back({TaskType::Visit, content});
+        if (lower == upper) {
+            write(std::format("for (int {} = 0; {} < {}; {}++) {{", i, i, upper, i));
+        } else {
+            write(std::format("for (auto {} = {} + engine.below({}); {} > 0; {}--) {{", i, lower,
+                              upper - lower + 1, i, i));
+        }
+        indent_++;
+    } else if (auto *group = dynamic_cast<const GroupNode *>(node)) {
+        if (!group->is_referenced()) {
+            tasks_.push_back({TaskType::Visit, group->content()});
+            return;
+        }
+        // The text of the group is recorded like `Generator` does, the last one wins.
+        int index = group->index();
+        groups_.insert(index);
+        write("{");
+        indent_++;
+        std::string begin = std::format("begin_{}", index);
+        write(std::format("std::size_t {} = out.size();", begin));
+        tasks_.push_back({TaskType::Close, nullptr, "}"});
+        std::string capture = std::format("capture_{}", index);
+        tasks_.push_back({TaskType::Line, nullptr,
+                          std::format("{}_offset = {}, {}_length = out.size() - {};", capture,
+                                      begin, capture, begin)});
+        tasks_.push_back({TaskType::Visit, group->content()});
+    } else if (auto *alternation = dynamic_cast<const AlternationNode *>(node)) {
+        const auto &elements = alternation->elements();
+        if (elements.size() == 1)
+            tasks_.push_back({TaskType::Visit, elements[0].get()});
+        if (elements.size() <= 1)
+            return;
+        write(std::format("switch (engine.below({})) {{", elements.size()));
+        tasks_.push_back({TaskType::Close, nullptr, "}"});
+        for (std::size_t i = elements.size(); i-- > 0;) {
+            tasks_.push_back({TaskType::Close, nullptr, "}"});
+            tasks_.push_back({TaskType::Line, nullptr, "break;"});
+            tasks_.push_back({TaskType::Visit, elements[i].get()});
+            tasks_.push_back({TaskType::Open, nullptr,
+                              i + 1 == elements.size() ? std::string{"default: {"}
+                                                       : std::format("case {}: {{", i)});
+        }
+        indent_++;
+    } else if (auto *backref = dynamic_cast<const BackrefNode *>(node)) {
+        // Captures start empty, for regex like `(abc)|\1`.
+        int index = backref->group()->index();
+        groups_.insert(index);
+        write(std::format("out.append(out, capture_{}_offset, capture_{}_length);", index, index));
+    } else if (dynamic_cast<const LookaroundNode *>(node) != nullptr) {
+        throw SyntaxNotSupport("lookarounds cannot be emitted as C++");
+    }
+    // Anchors at the edges of a pattern always hold, like in `Generator`.
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#include <strex/ChaCha20.hpp>
+#include <strex/Cpu.hpp>
+#include <strex/Random.hpp>
+
+namespace {
+
+using strex::cpu::Kernels;
+using strex::cpu::Level;
+
+#if defined(__GNUC__)
+#define STREX_ALWAYS_INLINE [[gnu::always_inline]] inline
+#else
+#define STREX_ALWAYS_INLINE inline
+#endif
+
+constexpr std::size_t xoshiro_lanes = strex::BlockEngine::lanes;
+constexpr std::size_t chacha20_lanes = strex::ChaCha20::lanes;
+constexpr std::size_t chacha20_block_words = 16;
+
+// Kernel bodies are inlined into one function for each level, so each is vectorized for its own
+// instruction set. They are loops over lanes, which the compiler turns into vector code.
+
+STREX_ALWAYS_INLINE void xoshiro_block(std::uint64_t *state, std::uint32_t *block) {
+    constexpr std::size_t lanes = xoshiro_lanes;
+    std::uint64_t s0[lanes], s1[lanes], s2[lanes], s3[lanes];
+    std::memcpy(s0, state, sizeof(s0));
+    std::memcpy(s1, state + lanes, sizeof(s1));
+    std::memcpy(s2, state + 2 * lanes, sizeof(s2));
+    std::memcpy(s3, state + 3 * lanes, sizeof(s3));
+
+    auto rotate = [](std::uint64_t value, int shift) {
+        return value << shift | value >> (64 - shift);
+    };
+    constexpr std::size_t steps = strex::BlockEngine::block_words / 2 / lanes;
+    for (std::size_t step = 0; step < steps; step++) {
+        std::uint64_t results[lanes];
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            // Multiplications by 5 and 9 are shifts and adds, AVX2 has no 64-bit multiply.
+            std::uint64_t times_5 = s1[lane] + (s1[lane] << 2);
+            std::uint64_t rotated = rotate(times_5, 7);
+            results[lane] = rotated + (rotated << 3);
+
+            std::uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotate(s3[lane], 45);
+        }
+        std::memcpy(block + step * lanes * 2, results, sizeof(results));
+    }
+
+    std::memcpy(state, s0, sizeof(s0));
+    std::memcpy(state + lanes, s1, sizeof(s1));
+    std::memcpy(state + 2 * lanes, s2, sizeof(s2));
+    std::memcpy(state + 3 * lanes, s3, sizeof(s3));
+}
+
+STREX_ALWAYS_INLINE void chacha20_blocks(const std::uint32_t *input, std::uint32_t *output) {
+    constexpr std::size_t lanes = chacha20_lanes;
+    std::uint32_t x[chacha20_block_words][lanes];
+    std::memcpy(x, input, sizeof(x));
+    auto quarter_round = [&x](std::size_t a, std::size_t b, std::size_t c, std::size_t d) {
+        auto rotate = [](std::uint32_t value, int shift) {
+            return value << shift | value >> (32 - shift);
+        };
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            x[a][lane] += x[b][lane];
+            x[d][lane] = rotate(x[d][lane] ^ x[a][lane], 16);
+            x[c][lane] += x[d][lane];
+            x[b][lane] = rotate(x[b][lane] ^ x[c][lane], 12);
+            x[a][lane] += x[b][lane];
+            x[d][lane] = rotate(x[d][lane] ^ x[a][lane], 8);
+            x[c][lane] += x[d][lane];
+            x[b][lane] = rotate(x[b][lane] ^ x[c][lane], 7);
+        }
+    };
+    for (int round = 0; round < 10; round++) {
+        quarter_round(0, 4, 8, 12);
+        quarter_round(1, 5, 9, 13);
+        quarter_round(2, 6, 10, 14);
+        quarter_round(3, 7, 11, 15);
+        quarter_round(0, 5, 10, 15);
+        quarter_round(1, 6, 11, 12);
+        quarter_round(2, 7, 8, 13);
+        quarter_round(3, 4, 9, 14);
+    }
+
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+        for (std::size_t i = 0; i < chacha20_block_words; i++)
+            output[lane * chacha20_block_words + i] = x[i][lane] + input[i * lanes + lane];
+    }
+}
+
+STREX_ALWAYS_INLINE bool charset_run(char *out, const std::uint32_t *words, std::size_t count,
+                                     const char *table, std::uint32_t size) {
+    // Unlike `reduce`, the threshold is computed once, so the loop has no division or branch.
+    std::uint32_t threshold = -size % size;
+    bool is_biased = false;
+    for (std::size_t i = 0; i < count; i++) {
+        std::uint64_t product = static_cast<std::uint64_t>(words[i]) * size;
+        is_biased |= static_cast<std::uint32_t>(product) < threshold;
+        out[i] = table[product >> 32];
+    }
+    return !is_biased;
+}
+
+// Defines the kernels of a level, `attributes` select its instruction set.
+#define STREX_DEFINE_KERNELS(suffix, attributes)                                                   \
+    attributes void xoshiro_block_##suffix(std::uint64_t *state, std::uint32_t *block) {           \
+        xoshiro_block(state, block);                                                               \
+    }                                                                                              \
+    attributes void chacha20_blocks_##suffix(const std::uint32_t *input, std::uint32_t *output) {  \
+        chacha20_blocks(input, output);                                                            \
+    }                                                                                              \
+    attributes bool charset_run_##suffix(char *out, const std::uint32_t *words, std::size_t count, \
+                                         const char *table, std::uint32_t size) {                  \
+        return charset_run(out, words, count, table, size);                                        \
+    }
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define STREX_DISPATCH_X86 1
+STREX_DEFINE_KERNELS(sse2, )
+STREX_DEFINE_KERNELS(avx2, [[gnu::target("avx2")]])
+STREX_DEFINE_KERNELS(avx512, [[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]])
+
+// Ordered by level. The entry of `Level::Scalar` holds the SSE2 kernels, as x86-64 has none
+// below the baseline, and its `level` says so.
+constexpr Kernels kernel_table[] = {
+    {Level::SSE2, xoshiro_block_sse2, chacha20_blocks_sse2, charset_run_sse2},
+    {Level::SSE2, xoshiro_block_sse2, chacha20_blocks_sse2, charset_run_sse2},
+    {Level::AVX2, xoshiro_block_avx2, chacha20_blocks_avx2, charset_run_avx2},
+    {Level::AVX512, xoshiro_block_avx512, chacha20_blocks_avx512, charset_run_avx512},
+};
+#else
+STREX_DEFINE_KERNELS(scalar, )
+
+constexpr Kernels kernel_table[] = {
+    {Level::Scalar, xoshiro_block_scalar, chacha20_blocks_scalar, charset_run_scalar},
+};
+#endif
+
+} // namespace
+
+std::string_view strex::cpu::name(Level level) {
+    switch (level) {
+        case Level::Scalar:
+            return "scalar";
+        case Level::SSE2:
+            return "sse2";
+        case Level::AVX2:
+            return "avx2";
+        case Level::AVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+auto strex::cpu::parse_level(std::string_view name) -> std::optional<Level> {
+    for (Level level : {Level::Scalar, Level::SSE2, Level::AVX2, Level::AVX512}) {
+        if (name == cpu::name(level))
+            return level;
+    }
+    return std::nullopt;
+}
+
+auto strex::cpu::detect() -> Level {
+#if defined(STREX_DISPATCH_X86)
+    // These also check that the OS saves the vector registers.
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+        return Level::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+    return Level::SSE2;
+#else
+    return Level::Scalar;
+#endif
+}
+
+auto strex::cpu::kernels(Level level) -> const Kernels & {
+    auto index = std::min(static_cast<std::size_t>(level), std::size(kernel_table) - 1);
+    return kernel_table[index];
+}
+
+auto strex::cpu::active() -> const Kernels & {
+    static const Kernels &active = []() -> const Kernels & {
+        Level level = detect();
+        // Lowering the level helps to compare kernels, or to work around a faulty one.
+        if (const char *value = std::getenv("STREX_CPU")) {
+            auto requested = parse_level(value);
+            if (requested && *requested < level)
+                level = *requested;
+        }
+        return kernels(level);
+    }();
+    return active;
+}
\ No newline at end of file
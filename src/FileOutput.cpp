@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#include <strex/Exception.hpp>
+#include <strex/FileOutput.hpp>
+#include <strex/GenerationOptions.hpp>
+#include <strex/Sink.hpp>
+#include <strex/Skeleton.hpp>
+#include <strex/Stats.hpp>
+#include <strex/strex.hpp>
+
+// Strings a thread generates at a time.
+constexpr std::size_t batch_strings = 4096;
+
+// A chunk file created by this run, only these are removed.
+struct Chunk {
+    std::string name;
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file;
+};
+
+// Creates a chunk file for thread `index` next to `path`. Names of files that exist are skipped,
+// so no other file is truncated or removed.
+static Chunk create_chunk(const std::string &path, std::size_t index) {
+    for (std::size_t attempt = 0;; attempt++) {
+        auto name = attempt == 0 ? std::format("{}.part{}", path, index)
+                                 : std::format("{}.part{}.{}", path, index, attempt);
+        // `x` fails if the file exists, like `O_EXCL`.
+        if (std::FILE *file = std::fopen(name.c_str(), "wbx"))
+            return {std::move(name), {file, std::fclose}};
+        if (errno != EEXIST)
+            throw strex::GenerateError("failed to create a chunk file");
+    }
+}
+
+#if defined(__linux__)
+// Closes a file descriptor when it goes out of scope.
+struct Descriptor {
+    int fd;
+
+    explicit Descriptor(int fd) : fd(fd) {}
+    ~Descriptor() {
+        if (fd >= 0)
+            close(fd);
+    }
+    Descriptor(const Descriptor &) = delete;
+    Descriptor &operator=(const Descriptor &) = delete;
+};
+
+// Opens `path` for writing, emptied, and returns its descriptor.
+static int create(const std::string &path) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw strex::GenerateError("failed to open the output file");
+    return fd;
+}
+
+// Appends the file at `name` to `out` inside the kernel, or through a buffer where the file
+// systems cannot copy between each other.
+static void append_file(int out, const std::string &name) {
+    Descriptor in(open(name.c_str(), O_RDONLY));
+    if (in.fd < 0)
+        throw strex::GenerateError("failed to open a chunk file");
+    while (true) {
+        ssize_t count = copy_file_range(in.fd, nullptr, out, nullptr, std::size_t{1} << 30, 0);
+        if (count > 0)
+            continue;
+        if (count == 0)
+            return;
+        if (errno == EINTR)
+            continue;
+        if (errno != EXDEV && errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP)
+            throw strex::GenerateError("failed to copy a chunk file");
+        break;
+    }
+    std::vector<char> buffer(1 << 20);
+    while (true) {
+        ssize_t count = read(in.fd, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            throw strex::GenerateError("failed to read a chunk file");
+        if (count == 0)
+            return;
+        strex::FdSink(out).write({buffer.data(), static_cast<std::size_t>(count)});
+    }
+}
+
+// Asks the kernel to start writing back the pages of [`begin`, `end`).
+static void sync_range(char *begin, char *end) {
+    auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    std::size_t offset = reinterpret_cast<std::uintptr_t>(begin) % page;
+    msync(begin - offset, static_cast<std::size_t>(end - begin) + offset, MS_ASYNC);
+}
+#endif
+
+// Writes `count` strings of `regex`, one per line, into `chunk`, and closes it.
+static void write_chunk(const strex::ParsedRegex &regex, Chunk &chunk, std::size_t count) {
+    for (std::size_t done = 0; done < count;) {
+        std::size_t taken = std::min(batch_strings, count - done);
+        for (const std::string &generated : strex::from_regex(regex, taken)) {
+            std::fwrite(generated.data(), 1, generated.size(), chunk.file.get());
+            std::fputc('\n', chunk.file.get());
+        }
+        done += taken;
+    }
+    bool is_written = std::ferror(chunk.file.get()) == 0;
+    if (std::fclose(chunk.file.release()) != 0 || !is_written)
+        throw strex::GenerateError("failed to write a chunk file");
+}
+
+// Writes `chunks` one after another into `path`.
+static void join_chunks(const std::string &path, const std::vector<Chunk> &chunks) {
+#if defined(__linux__)
+    Descriptor file(create(path));
+    for (const Chunk &chunk : chunks)
+        append_file(file.fd, chunk.name);
+#else
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (const Chunk &chunk : chunks)
+        file << std::ifstream(chunk.name, std::ios::binary).rdbuf();
+    if (!file)
+        throw strex::GenerateError("failed to write the output file");
+#endif
+}
+
+// Closes and removes `chunks`.
+static void remove_chunks(std::vector<Chunk> &chunks) {
+    for (Chunk &chunk : chunks) {
+        chunk.file.reset();
+        std::remove(chunk.name.c_str());
+    }
+}
+
+// Runs `work(index)` for every index in [0, `jobs`) on its own thread, and rethrows the first
+// exception thrown by any of them after all have finished.
+template <typename Work>
+static void run_threads(std::size_t jobs, const Work &work) {
+    std::vector<std::exception_ptr> errors(jobs);
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < jobs; i++) {
+            threads.emplace_back([&, i] {
+                try {
+                    work(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+                strex::stats::flush();
+            });
+        }
+    }
+    for (const auto &error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+void strex::generate_to_file(std::string_view regex, const GenerationOptions &options,
+                             const std::string &path, std::size_t count, unsigned jobs) {
+    std::size_t thread_count = std::max<std::size_t>(std::min<std::size_t>(jobs, count), 1);
+    // Generators are kept in a `ParsedRegex`, so every thread gets its own.
+    std::vector<std::unique_ptr<ParsedRegex>> regexes;
+    for (std::size_t i = 0; i < thread_count; i++)
+        regexes.push_back(std::make_unique<ParsedRegex>(regex, options));
+    auto first = [&](std::size_t index) { return count * index / thread_count; };
+
+#if defined(__linux__)
+    if (regexes[0]->skeleton_ != nullptr) {
+        std::size_t stride = regexes[0]->skeleton_->width() + 1;
+        std::size_t size = count * stride;
+        Descriptor file(create(path));
+        if (size == 0)
+            return;
+        // Blocks are reserved up front, so a full disk is an error here instead of a SIGBUS when
+        // a page of the mapping is written. Only file systems without `fallocate(2)` get a
+        // sparse file.
+        if (fallocate(file.fd, 0, 0, static_cast<off_t>(size)) != 0) {
+            if (errno != EOPNOTSUPP && errno != ENOSYS)
+                throw GenerateError("failed to allocate the output file");
+            if (ftruncate(file.fd, static_cast<off_t>(size)) != 0)
+                throw GenerateError("failed to resize the output file");
+        }
+        void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+        if (mapping == MAP_FAILED)
+            throw GenerateError("failed to map the output file");
+        madvise(mapping, size, MADV_SEQUENTIAL);
+
+        auto *out = static_cast<char *>(mapping);
+        try {
+            run_threads(thread_count, [&](std::size_t index) {
+                using strex::stats::Counters;
+                Skeleton &skeleton = *regexes[index]->skeleton_;
+                char *synced = out + first(index) * stride;
+                for (std::size_t i = first(index); i < first(index + 1);) {
+                    strex::stats::PhaseTimer timer(&Counters::generate_ns);
+                    std::size_t taken = std::min(batch_strings, first(index + 1) - i);
+                    std::uint64_t random_draws = skeleton.random_draws();
+                    char *batch = out + i * stride;
+                    skeleton.fill(batch, taken, stride);
+                    for (std::size_t j = 1; j <= taken; j++)
+                        batch[j * stride - 1] = '\n';
+                    i += taken;
+                    if (strex::stats::is_enabled()) {
+                        Counters &counters = strex::stats::local();
+                        counters.strings += taken;
+                        counters.bytes_emitted += taken * (stride - 1);
+                        counters.random_draws += skeleton.random_draws() - random_draws;
+                        // Strings of a batch are filled together, each takes an equal share.
+                        std::uint64_t latency = timer.elapsed() / taken;
+                        for (std::size_t j = 0; j < taken; j++)
+                            counters.latency.record(latency);
+                    }
+                    if (static_cast<std::size_t>(out + i * stride - synced) >= file_sync_bytes) {
+                        sync_range(synced, out + i * stride);
+                        synced = out + i * stride;
+                    }
+                }
+            });
+        }
+        catch (...) {
+            munmap(mapping, size);
+            throw;
+        }
+        if (munmap(mapping, size) != 0)
+            throw GenerateError("failed to unmap the output file");
+        return;
+    }
+#endif
+
+    std::vector<Chunk> chunks;
+    try {
+        for (std::size_t i = 0; i < thread_count; i++)
+            chunks.push_back(create_chunk(path, i));
+        run_threads(thread_count, [&](std::size_t index) {
+            write_chunk(*regexes[index], chunks[index], first(index + 1) - first(index));
+        });
+        join_chunks(path, chunks);
+    }
+    catch (...) {
+        remove_chunks(chunks);
+        throw;
+    }
+    remove_chunks(chunks);
+}
\ No newline at end of file
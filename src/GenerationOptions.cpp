@@ -0,0 +1,31 @@
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <strex/GenerationOptions.hpp>
+
+void strex::GenerationOptions::validate() const {
+    if (max_repeat < 0)
+        throw std::invalid_argument("the repeat ceiling must not be negative");
+    if (!std::isfinite(repeat_mean) || repeat_mean <= 0.0)
+        throw std::invalid_argument("the mean of geometric repetitions must be positive");
+}
+
+auto strex::parse_repeat_distribution(std::string_view name) -> RepeatDistribution {
+    if (name == "uniform")
+        return RepeatDistribution::Uniform;
+    if (name == "geometric")
+        return RepeatDistribution::Geometric;
+    throw std::invalid_argument("unknown repeat distribution: " + std::string{name});
+}
+
+auto strex::parse_budget_policy(std::string_view name) -> BudgetPolicy {
+    if (name == "truncate")
+        return BudgetPolicy::Truncate;
+    if (name == "shortest")
+        return BudgetPolicy::Shortest;
+    if (name == "error")
+        return BudgetPolicy::Error;
+    throw std::invalid_argument("unknown budget policy: " + std::string{name});
+}
\ No newline at end of file
@@ -1,63 +1,291 @@
 #include <algorithm>
 #include <cassert>
-#include <cctype>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
-#include <functional>
-#include <random>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ranges>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <strex/AST.hpp>
 #include <strex/Charset.hpp>
 #include <strex/Exception.hpp>
+#include <strex/GenerationOptions.hpp>
 #include <strex/Generator.hpp>
+#include <strex/Sink.hpp>
+#include <strex/Unicode.hpp>
 
-strex::Generator::Generator(const ASTNode *ast) : ast_(ast) {
+strex::Generator::Generator(const ASTNode *ast, bool is_secure)
+    : Generator(ast, GenerationOptions{}, is_secure) {}
+
+strex::Generator::Generator(const ASTNode *ast, const GenerationOptions &options, bool is_secure)
+    : ast_(ast), options_(options),
+      budget_(options.max_bytes > 0 ? options.max_bytes : std::numeric_limits<std::size_t>::max()),
+      repeat_log_(std::log(options.repeat_mean / (options.repeat_mean + 1.0))),
+      random_(GeneratorEngine{{}, is_secure ? std::make_unique<ChaCha20>() : nullptr}) {
     assert(ast != nullptr);
+    options.validate();
 }
 
 std::string strex::Generator::generate() {
+    std::string generated;
+    generate_into(generated);
+    return generated;
+}
+
+void strex::Generator::generate_into(std::string &out) {
+    sink_ = nullptr;
+    start();
+    run();
+    if (position() > budget_)
+        apply_budget();
+    out.append(generated_string_);
+}
+
+void strex::Generator::generate(Sink &sink) {
+    sink_ = &sink;
+    start();
+    run();
+    if (position() > budget_)
+        apply_budget();
+    flush();
+    sink_ = nullptr;
+}
+
+void strex::Generator::start() {
     generated_string_.clear();
-    group_generated_.clear();
+    streamed_ = 0;
+    std::ranges::fill(captures_, Capture{});
+    std::ranges::fill(capture_texts_, std::string{});
+    open_groups_.clear();
     generate(ast_);
-    return generated_string_;
+}
+
+void strex::Generator::append(std::string_view text) {
+    if (sink_ == nullptr) {
+        generated_string_.append(text);
+        return;
+    }
+    // Long texts are appended a chunk at a time, cut between characters.
+    while (!text.empty() && position() <= budget_) {
+        std::size_t size = std::min(text.size(), chunk_size);
+        while (size < text.size() && size > 0 &&
+               (static_cast<unsigned char>(text[size]) & 0xC0) == 0x80)
+            size--;
+        if (size == 0)
+            size = text.size();
+        generated_string_.append(text.substr(0, size));
+        text.remove_prefix(size);
+        if (position() <= budget_ && generated_string_.size() >= chunk_size)
+            flush();
+    }
+}
+
+void strex::Generator::flush() {
+    // Open groups that are referenced keep their text, which their backreferences copy.
+    for (OpenGroup &group : open_groups_)
+        group.text.append(generated_string_, group.offset - std::min(group.offset, streamed_));
+    sink_->write(generated_string_);
+    streamed_ += generated_string_.size();
+    generated_string_.clear();
+}
+
+void strex::Generator::close_streamed_group(std::size_t index) {
+    OpenGroup &group = open_groups_.back();
+    group.text.append(generated_string_, group.offset - std::min(group.offset, streamed_));
+    capture_texts_[index] = std::move(group.text);
+    open_groups_.pop_back();
+}
+
+void strex::Generator::apply_budget() {
+    switch (options_.budget_policy) {
+        case BudgetPolicy::Truncate: {
+            // Streamed bytes are all within the budget, and continuation bytes of the character
+            // at the cut are dropped with it.
+            std::size_t end = budget_ - streamed_;
+            while (end > 0 && (static_cast<unsigned char>(generated_string_[end]) & 0xC0) == 0x80)
+                end--;
+            generated_string_.resize(end);
+            break;
+        }
+        case BudgetPolicy::Shortest:
+            if (shortest_.empty())
+                measure_shortest();
+            if (shortest_.at(ast_) > budget_)
+                throw GenerateError("failed to generate string: the shortest string of the regex "
+                                    "is longer than the byte budget");
+            // Only budgets below `chunk_size` are sure to have nothing streamed yet.
+            if (streamed_ > 0)
+                throw GenerateError("failed to generate string: it is longer than the byte "
+                                    "budget, and a part has been streamed");
+            start();
+            is_shortest_ = true;
+            run();
+            is_shortest_ = false;
+            break;
+        case BudgetPolicy::Error:
+            throw GenerateError("failed to generate string: it is longer than the byte budget");
+    }
+}
+
+int strex::Generator::geometric_count(int cap) {
+    // A uniform value in (0, 1] with 24 bits, the count is the floor of `log(u)` in the base of
+    // the ratio of probabilities.
+    constexpr std::uint32_t resolution = 1 << 24;
+    double uniform = (random_(resolution) + 1.0) / resolution;
+    double count = std::floor(std::log(uniform) / repeat_log_);
+    return count >= cap ? cap : static_cast<int>(count);
+}
+
+void strex::Generator::measure_shortest() {
+    // Lengths saturate at `unbounded`.
+    constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+    auto add = [](std::size_t a, std::size_t b) { return a > unbounded - b ? unbounded : a + b; };
+    // Nodes are measured after their children from an explicit stack, children in order, so a
+    // group is measured before the backreferences that follow it.
+    std::vector<std::pair<const ASTNode *, bool>> pending{{ast_, false}};
+    while (!pending.empty()) {
+        auto [node, is_expanded] = pending.back();
+        pending.pop_back();
+        std::vector<const ASTNode *> children;
+        if (auto *sequence = dynamic_cast<const SequenceNode *>(node)) {
+            for (const auto &element : sequence->sequence())
+                children.push_back(element.get());
+        } else if (auto *alternation = dynamic_cast<const AlternationNode *>(node)) {
+            for (const auto &element : alternation->elements())
+                children.push_back(element.get());
+        } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+            children.push_back(repeat->content());
+        } else if (auto *group = dynamic_cast<const GroupNode *>(node)) {
+            children.push_back(group->content());
+        }
+        if (!is_expanded) {
+            pending.push_back({node, true});
+            for (const ASTNode *child : children | std::views::reverse)
+                pending.push_back({child, false});
+            continue;
+        }
+
+        std::size_t length = 0;
+        if (auto *text = dynamic_cast<const TextNode *>(node)) {
+            length = text->text().size();
+        } else if (auto *charset_node = dynamic_cast<const CharsetNode *>(node)) {
+            // Characters are still random, so the largest one counts.
+            const Charset *charset = charset_node->charset();
+            char bytes[4];
+            if (charset->size() > 0)
+                length = unicode::encode_utf8(charset->at(charset->size() - 1), bytes);
+        } else if (dynamic_cast<const SequenceNode *>(node) != nullptr) {
+            for (const ASTNode *child : children)
+                length = add(length, shortest_[child]);
+        } else if (dynamic_cast<const AlternationNode *>(node) != nullptr) {
+            if (!children.empty())
+                length = unbounded;
+            for (const ASTNode *child : children)
+                length = std::min(length, shortest_[child]);
+        } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+            std::size_t content = shortest_[children[0]];
+            auto lower = static_cast<std::size_t>(repeat->repeat_lower());
+            length = content != 0 && lower > unbounded / content ? unbounded : content * lower;
+        } else if (dynamic_cast<const GroupNode *>(node) != nullptr) {
+            length = shortest_[children[0]];
+        } else if (auto *backref = dynamic_cast<const BackrefNode *>(node)) {
+            // A group that has not generated yet, like in `\1(a)`, is not measured either.
+            auto group = shortest_.find(backref->group());
+            if (group != shortest_.end())
+                length = group->second;
+        }
+        shortest_[node] = length;
+    }
 }
 
 void strex::Generator::generate(const ASTNode *node) {
-    node->accept(this);
+    tasks_.push_back({TaskType::Visit, node});
 }
 
-void strex::Generator::visit(const TextNode *node) {
-    generated_string_.append(node->text());
+void strex::Generator::run() {
+    while (!tasks_.empty()) {
+        Task task = tasks_.back();
+        tasks_.pop_back();
+        switch (task.type) {
+            case TaskType::Visit:
+                if (profile_ != nullptr)
+                    visit_profiled(task.node);
+                else
+                    task.node->accept(this);
+                break;
+            case TaskType::Repeat:
+                if (task.value > 1)
+                    tasks_.push_back({TaskType::Repeat, task.node, task.value - 1});
+                generate(static_cast<const RepeatNode *>(task.node)->content());
+                break;
+            case TaskType::Close_Group: {
+                auto group = static_cast<const GroupNode *>(task.node);
+                std::size_t length = position() - task.value;
+                captures_[group->index()] = {task.value, length, true};
+                if (sink_ != nullptr)
+                    close_streamed_group(group->index());
+                break;
+            }
+            case TaskType::Profile_End:
+                profile_->at(task.node).bytes += position() - task.value;
+                break;
+        }
+        // Over the budget, the rest of the string is not generated.
+        if (position() > budget_) {
+            tasks_.clear();
+            return;
+        }
+        if (sink_ != nullptr && generated_string_.size() >= chunk_size)
+            flush();
+    }
 }
 
-static std::string exclude(std::string_view except);
+void strex::Generator::visit_profiled(const ASTNode *node) {
+    Profile::Node &profiled = profile_->at(node);
+    profiled.visits++;
+    // Runs after the tasks pushed by visiting the node, which generate its children.
+    tasks_.push_back({TaskType::Profile_End, node, position()});
 
-static std::string remove_unprintable(std::string &characters);
+    if (++profile_->steps_ % Profile::sample_interval != 0) {
+        node->accept(this);
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    node->accept(this);
+    auto duration = std::chrono::steady_clock::now() - start;
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    profiled.self_ns += nanoseconds * Profile::sample_interval;
+}
+
+void strex::Generator::visit(const TextNode *node) {
+    append(node->text());
+}
 
 void strex::Generator::visit(const CharsetNode *node) {
     const Charset *charset = node->charset();
-    std::string characters{charset->alphabet()};
-    if (!charset->is_inclusive())
-        characters = exclude(characters);
 
-    remove_unprintable(characters);
-
-    if (characters.empty())
+    if (charset->size() == 0)
         return;
 
-    if (characters.size() == 1) {
-        generated_string_.push_back(characters[0]);
+    if (charset->size() == 1) {
+        unicode::append_utf8(generated_string_, charset->at(0));
         return;
     }
 
-    std::uniform_int_distribution<std::size_t> random(0, characters.size() - 1);
-
-    generated_string_.push_back(characters[random(engine_)]);
+    random_draws_++;
+    auto index = random_(static_cast<std::uint32_t>(charset->size()));
+    unicode::append_utf8(generated_string_, charset->at(index));
 }
 
 void strex::Generator::visit(const SequenceNode *node) {
-    for (const auto &element : node->sequence()) {
+    // The last pushed task runs first.
+    for (const auto &element : node->sequence() | std::views::reverse) {
         generate(element.get());
     }
 }
@@ -66,21 +294,34 @@ void strex::Generator::visit(const RepeatNode *node) {
     int lower = node->repeat_lower();
     int upper = node->repeat_upper();
 
-    std::uniform_int_distribution<int> random(lower, upper);
-
-    int repeat_count = random(engine_);
-    while (repeat_count--)
-        generate(node->content());
+    // The shortest string takes the fewest repetitions, without a random choice.
+    int repeat_count = lower;
+    if (!is_shortest_ && options_.repeat_distribution == RepeatDistribution::Geometric &&
+        upper > lower) {
+        random_draws_++;
+        repeat_count = lower + geometric_count(upper - lower);
+    } else if (!is_shortest_) {
+        random_draws_++;
+        auto range = static_cast<std::uint32_t>(upper - lower + 1);
+        repeat_count = lower + static_cast<int>(random_(range));
+    }
+    if (repeat_count > 0)
+        tasks_.push_back({TaskType::Repeat, node, static_cast<std::size_t>(repeat_count)});
 }
 
 void strex::Generator::visit(const GroupNode *node) {
-    // assert(!group_generated_.contains(node));
-
-    std::string temp = std::move(generated_string_);
+    if (!node->is_referenced()) {
+        generate(node->content());
+        return;
+    }
+    if (static_cast<std::size_t>(node->index()) >= captures_.size()) {
+        captures_.resize(node->index() + 1);
+        capture_texts_.resize(node->index() + 1);
+    }
+    if (sink_ != nullptr)
+        open_groups_.push_back({position(), {}});
+    tasks_.push_back({TaskType::Close_Group, node, position()});
     generate(node->content());
-    group_generated_[node] = generated_string_;
-    generated_string_ = std::move(temp);
-    generated_string_.append(group_generated_[node]);
 }
 
 void strex::Generator::visit(const AlternationNode *node) {
@@ -91,43 +332,37 @@ void strex::Generator::visit(const AlternationNode *node) {
         generate(elements[0].get());
         return;
     }
-    std::uniform_int_distribution<std::size_t> random(0, elements.size() - 1);
-
-    generate(elements[random(engine_)].get());
+    if (is_shortest_) {
+        auto shortest = std::ranges::min_element(elements, {}, [this](const auto &element) {
+            return shortest_.at(element.get());
+        });
+        generate(shortest->get());
+        return;
+    }
+    random_draws_++;
+    generate(elements[random_(static_cast<std::uint32_t>(elements.size()))].get());
 }
 
 void strex::Generator::visit(const BackrefNode *node) {
+    auto index = static_cast<std::size_t>(node->group()->index());
     // for regex like `(abc)|\1`
-    if (!group_generated_.contains(node->group()))
+    if (index >= captures_.size() || !captures_[index].captured)
         return;
 
-    assert(group_generated_.contains(node->group()));
-
-    generated_string_.append(group_generated_[node->group()]);
+    if (sink_ != nullptr) {
+        append(capture_texts_[index]);
+        return;
+    }
+    // The capture is a span of the generated string, so the text is copied from the string itself.
+    auto [offset, length, _] = captures_[index];
+    generated_string_.reserve(generated_string_.size() + length);
+    generated_string_.append(generated_string_, offset, length);
 }
 
-std::string exclude(std::string_view except) {
-    assert(std::ranges::is_sorted(except));
-
-    static const auto ascii_characters = [] {
-        std::string s;
-        s.resize_and_overwrite(128, [](char *s, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++)
-                s[i] = static_cast<char>(i);
-            return n;
-        });
-        return s;
-    }();
-
-    std::string characters;
-
-    std::ranges::set_difference(ascii_characters, except, std::back_inserter(characters));
-    return characters;
+void strex::Generator::visit(const AnchorNode *) {
+    // Generated strings are matched as a whole, anchors at the edges of a pattern always hold.
 }
 
-std::string remove_unprintable(std::string &characters) {
-    assert(std::ranges::is_sorted(characters));
-    auto [last, end] = std::ranges::remove_if(characters, std::not_fn(::isprint));
-    characters.erase(last, end);
-    return characters;
+void strex::Generator::visit(const LookaroundNode *) {
+    throw GenerateError("failed to generate string: lookarounds need the automaton backend");
 }
\ No newline at end of file
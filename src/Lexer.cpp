@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cassert>
 #include <charconv>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <system_error>
@@ -11,37 +13,46 @@
 #include <strex/Lexer.hpp>
 #include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
+#include <strex/Unicode.hpp>
 
 strex::Lexer::Lexer(std::string regex) : regex_(std::move(regex)) {}
 
-void strex::Lexer::scan_groups() {
-    std::vector<Token> tokens;
-    tokens_ = &tokens;
-    auto token = next_token();
-    while (!token.is(TokenType::End)) {
-        tokens.push_back(token);
-        token = next_token();
+int strex::Lexer::count_groups() const {
+    int count = 0;
+    bool in_charset = false;
+    for (std::size_t i = 0; i < regex_.size(); i++) {
+        char ch = regex_[i];
+        if (ch == '\\')
+            i++; // escaped character never opens a group or a charset
+        else if (in_charset && ch == ']')
+            in_charset = false;
+        else if (!in_charset && ch == '[')
+            in_charset = true;
+        else if (!in_charset && ch == '(' && (i + 1 == regex_.size() || regex_[i + 1] != '?'))
+            count++; // extensions such as `(?:` do not capture
     }
-    tokens.push_back(token);
+    return count;
+}
+
+auto strex::Lexer::tokenize() -> std::vector<Token> {
+    if (regex_.size() > UINT32_MAX)
+        throw LexicalError("regular expression is too long: {} bytes", regex_.size());
 
     current_position_ = 0;
-    token_begin_position_ = 0;
     in_charset_ = false;
-    tokens_ = nullptr;
-    has_preprocessed_ = true;
-}
+    previous_type_ = TokenType::Error;
+    group_count_ = count_groups();
 
-auto strex::Lexer::tokenize() -> std::vector<Token> {
-    scan_groups();
     std::vector<Token> tokens;
-    tokens_ = &tokens;
+    // Every token but `End` consumes at least one character.
+    tokens.reserve(regex_.size() + 1);
     auto token = next_token();
     while (!token.is(TokenType::End)) {
         tokens.push_back(token);
+        previous_type_ = token.type();
         token = next_token();
     }
     tokens.push_back(token);
-    tokens_ = nullptr;
     return tokens;
 }
 
@@ -133,9 +144,14 @@ auto strex::Lexer::backslash() -> Token {
             return hex_number(ch, 2);
         case 'u':
             return hex_number(ch, 4);
+        case 'p':
+        case 'P':
+            return property(ch);
         default:
             // other escape characters are treated as normal characters, e.g., \(, \$
-            return make_character(ch);
+            if (!isascii(ch))
+                return make_character(utf8_character());
+            return make_character(static_cast<char32_t>(ch));
     }
 }
 
@@ -157,8 +173,6 @@ auto strex::Lexer::right_bracket() -> Token {
 auto strex::Lexer::left_paren() -> Token {
     if (in_charset_)
         return make_character('(');
-    if (!has_preprocessed_)
-        group_count_++;
     return make_token(TokenType::Left_Paren);
 }
 
@@ -219,7 +233,7 @@ auto strex::Lexer::hyphen() -> Token {
 }
 
 auto strex::Lexer::question() -> Token {
-    if (!tokens_->empty() && prev_token().is(TokenType::Left_Paren))
+    if (previous_type_ == TokenType::Left_Paren)
         return extension();
     if (in_charset_)
         return make_character('?');
@@ -249,9 +263,19 @@ auto strex::Lexer::dollar() -> Token {
 }
 
 auto strex::Lexer::character(char ch) -> Token {
-    if (in_charset_ && !isascii(ch))
-        throw LexicalError("non-ascii character in charset is not supported");
-    return make_character(ch);
+    if (!isascii(ch))
+        return make_character(utf8_character());
+    return make_character(static_cast<char32_t>(ch));
+}
+
+char32_t strex::Lexer::utf8_character() {
+    // The first byte of the sequence has been consumed.
+    std::size_t position = current_position_ - 1;
+    char32_t code_point = unicode::decode_utf8(regex_, position);
+    if (code_point == unicode::invalid_code_point)
+        throw LexicalError("invalid UTF-8 sequence at offset {}", current_position_ - 1);
+    current_position_ = position;
+    return code_point;
 }
 
 auto strex::Lexer::word_boundary(char ch) -> Token {
@@ -311,8 +335,8 @@ auto strex::Lexer::number_after_backslash(char ch) -> Token {
             return make_character('\0');
         if (first_digit - '0' > group_count_) {
             if (is_octal(first_digit))
-                return make_character(static_cast<char>(first_digit - '0'));
-            return make_character(first_digit);
+                return make_character(static_cast<char32_t>(first_digit - '0'));
+            return make_character(static_cast<char32_t>(first_digit));
         }
         return make_backreference(first_digit - '0');
     }
@@ -337,32 +361,33 @@ auto strex::Lexer::number_after_backslash(char ch) -> Token {
     // not a backreference
 
     if (!is_octal(first_digit))
-        return make_character(first_digit);
+        return make_character(static_cast<char32_t>(first_digit));
 
     // the first digit is octal
 
     if (!is_octal(second_digit))
-        return make_character(static_cast<char>(first_digit - '0'));
+        return make_character(static_cast<char32_t>(first_digit - '0'));
 
     // the second digit is octal
 
     advance();
     if (is_end() || !is_digit(peek()))
-        return make_character(static_cast<char>(octal_value(first_digit, second_digit)));
+        return make_character(static_cast<char32_t>(octal_value(first_digit, second_digit)));
 
     // if has the thrid digit
 
     char third_digit = peek();
     if (!is_octal(third_digit))
-        return make_character(static_cast<char>(octal_value(first_digit, second_digit)));
+        return make_character(static_cast<char32_t>(octal_value(first_digit, second_digit)));
 
     // all three digits are octal
 
     if (octal_value(first_digit, second_digit, third_digit) > 255)
-        return make_character(static_cast<char>(octal_value(first_digit, second_digit)));
+        return make_character(static_cast<char32_t>(octal_value(first_digit, second_digit)));
 
     advance();
-    return make_character(static_cast<char>(octal_value(first_digit, second_digit, third_digit)));
+    return make_character(
+        static_cast<char32_t>(octal_value(first_digit, second_digit, third_digit)));
 }
 
 // Checks if a character is a valid hex character.
@@ -374,24 +399,83 @@ auto strex::Lexer::hex_number(char prev, int digit) -> Token {
     assert(prev == 'x' || prev == 'u');
     assert(digit == 2 || digit == 4);
 
-    if (!is_hex(peek()))
-        return make_character(prev);
+    if (prev == 'u' && !is_end() && peek() == '{')
+        return braced_code_point();
+
+    int value = hex_digits(digit);
+    if (value < 0)
+        return make_character(static_cast<char32_t>(prev));
+
+    auto code_point = static_cast<char32_t>(value);
+    // A pair of `\uXXXX` escapes of UTF-16 surrogates is one code point.
+    if (prev == 'u' && code_point >= 0xD800 && code_point <= 0xDBFF && regex_.size() >= 6 &&
+        current_position_ <= regex_.size() - 6 && regex_[current_position_] == '\\' &&
+        regex_[current_position_ + 1] == 'u') {
+        std::size_t position = current_position_;
+        current_position_ += 2;
+        int low = hex_digits(4);
+        if (low >= 0xDC00 && low <= 0xDFFF)
+            return make_character(0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00));
+        current_position_ = position;
+    }
+    if (unicode::is_surrogate(code_point))
+        throw LexicalError("lone surrogate \\u{:04x} is not a character", value);
+    return make_character(code_point);
+}
 
+int strex::Lexer::hex_digits(int digit) {
     std::size_t position = current_position_;
-
     int value = 0;
     for (int i = 0; i < digit; i++) {
-        char ch = advance();
-        if (!is_hex(ch)) {
+        if (is_end() || !is_hex(peek())) {
             current_position_ = position;
-            return make_character(prev);
+            return -1;
         }
-        value = value * 16 + hex_value(ch);
+        value = value * 16 + hex_value(advance());
     }
+    return value;
+}
 
-    if (value > 255)
-        throw LexicalError("unsupported hex value {:x}", value);
-    return make_character(static_cast<char>(value));
+auto strex::Lexer::braced_code_point() -> Token {
+    std::size_t position = current_position_;
+    advance(); // {
+    std::size_t digits_start = current_position_;
+    char32_t code_point = 0;
+    while (!is_end() && is_hex(peek())) {
+        // Saturates, larger values are all out of range.
+        code_point = std::min<char32_t>(code_point * 16 + hex_value(advance()),
+                                        unicode::max_code_point + 1);
+    }
+    // Without the closing brace or digits, `\u` is an escaped `u`.
+    if (current_position_ == digits_start || is_end() || peek() != '}') {
+        current_position_ = position;
+        return make_character('u');
+    }
+    std::string_view digits(regex_.data() + digits_start, current_position_ - digits_start);
+    advance(); // }
+    if (code_point > unicode::max_code_point)
+        throw LexicalError("code point \\u{{{}}} is out of range", digits);
+    if (unicode::is_surrogate(code_point))
+        throw LexicalError("lone surrogate \\u{{{}}} is not a character", digits);
+    return make_character(code_point);
+}
+
+auto strex::Lexer::property(char ch) -> Token {
+    assert(ch == 'p' || ch == 'P');
+
+    // Without braces, `\p` is an escaped `p`.
+    if (is_end() || peek() != '{')
+        return make_character(static_cast<char32_t>(ch));
+    std::size_t close = regex_.find('}', current_position_);
+    if (close == std::string::npos)
+        throw LexicalError("expect '}}' to close unicode property at offset {}",
+                           token_begin_position_);
+    std::string_view name(regex_.data() + current_position_ + 1, close - current_position_ - 1);
+    std::uint32_t categories = unicode::property_categories(name);
+    if (categories == 0)
+        throw LexicalError("unknown unicode property '{}'", name);
+    current_position_ = close + 1;
+    return Token::create_property(categories, ch == 'p', make_token_range());
 }
 
 // convert string to int
@@ -459,23 +543,22 @@ auto strex::Lexer::repeat() -> Token {
 
 auto strex::Lexer::extension() -> Token {
     char ext = advance();
-    // TODO support lookahead, lookbehind and non-capture group
     switch (ext) {
         case ':':
-            throw SyntaxNotSupport("non-capture group is not supported");
+            return make_token(TokenType::Non_Capturing_Group);
         case '=':
-            throw SyntaxNotSupport("positive lookahead is not supported");
+            return make_token(TokenType::Positive_Lookahead);
         case '!':
-            throw SyntaxNotSupport("negative lookahead is not supported");
+            return make_token(TokenType::Negative_Lookahead);
         case '<':
             ext = peek();
             if (ext == '=') {
                 advance();
-                throw SyntaxNotSupport("positive lookbehind is not supported");
+                return make_token(TokenType::Positive_Lookbehind);
             }
             if (ext == '!') {
                 advance();
-                throw SyntaxNotSupport("negative lookbehind is not supported");
+                return make_token(TokenType::Negative_Lookbehind);
             }
             // Named capture group is not support yet.
             // if (is_alpha(ext))
@@ -532,16 +615,15 @@ bool strex::Lexer::is_repeat() {
 }
 
 bool strex::Lexer::is_first_in_charset() const {
-    assert(tokens_ != nullptr);
-    return !tokens_->empty() && prev_token().is(TokenType::Left_Bracket);
+    return previous_type_ == TokenType::Left_Bracket;
 }
 
 auto strex::Lexer::make_char_class(char ch) const -> Token {
     return Token::create_char_class(ch, make_token_range());
 }
 
-auto strex::Lexer::make_character(char ch) const -> Token {
-    return Token::create_character(ch, make_token_range());
+auto strex::Lexer::make_character(char32_t code_point) const -> Token {
+    return Token::create_character(code_point, make_token_range());
 }
 
 auto strex::Lexer::make_backreference(int group_number) const -> Token {
@@ -557,15 +639,11 @@ auto strex::Lexer::make_token(TokenType type) const -> Token {
 }
 
 auto strex::Lexer::make_token_range() const -> TextRange {
+    if (current_position_ - token_begin_position_ > Token::max_length)
+        throw LexicalError("token at offset {} is too long", token_begin_position_);
     return {token_begin_position_, current_position_};
 }
 
-auto strex::Lexer::prev_token() const -> const Token & {
-    assert(tokens_ != nullptr);
-    assert(!tokens_->empty());
-    return tokens_->back();
-}
-
 char strex::Lexer::peek() const {
     assert(!is_end());
     return regex_[current_position_];
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Program.hpp>
+#include <strex/strex.hpp>
+
+std::size_t strex::Matcher::InstructionsHash::operator()(
+    const std::vector<std::uint32_t> &instructions) const {
+    // FNV-1a over the instructions.
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::uint32_t instruction : instructions) {
+        hash ^= instruction;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+// The AST is only read while the program is compiled.
+strex::Matcher::Matcher(const ParsedRegex &regex) : Matcher(regex.matching_ast().get()) {}
+
+strex::Matcher::Matcher(const ASTNode *ast)
+    : program_(ast), is_backtracking_(program_.has_backref() || program_.has_assertion()) {
+    visited_.resize(program_.instructions().size(), 0);
+    if (!is_backtracking_)
+        reset_dfa();
+}
+
+bool strex::Matcher::matches(std::string_view text) {
+    if (is_backtracking_)
+        return backtrack(text, 0, 0, std::string_view::npos,
+                         std::vector<std::size_t>(program_.registers(), std::string_view::npos));
+    return dfa_matches(text);
+}
+
+bool strex::Matcher::dfa_matches(std::string_view text) {
+    std::int32_t state = start_state_;
+    for (char ch : text) {
+        auto byte = static_cast<unsigned char>(ch);
+        std::int32_t next = dfa_transitions_[state * (UCHAR_MAX + 1) + byte];
+        state = next != unknown_state ? next : transition(state, byte);
+        if (state == dead_state)
+            return false;
+    }
+    return dfa_states_[state].is_accepting;
+}
+
+auto strex::Matcher::transition(std::int32_t state, unsigned char byte) -> std::int32_t {
+    if (++visit_generation_ == 0) {
+        std::ranges::fill(visited_, 0);
+        visit_generation_ = 1;
+    }
+    std::vector<std::uint32_t> next;
+    for (std::uint32_t pc : dfa_states_[state].instructions) {
+        const Instruction &instruction = program_.instructions()[pc];
+        if (instruction.op == OpCode::Byte && program_.byte_sets()[instruction.operand].test(byte))
+            add_closure(pc + 1, next);
+    }
+    std::ranges::sort(next);
+
+    // The cache is full, states are rebuilt from the next one.
+    bool is_reset = dfa_states_.size() >= max_dfa_states && !dfa_ids_.contains(next);
+    if (is_reset)
+        reset_dfa();
+    std::int32_t next_state = dfa_state(std::move(next));
+    if (!is_reset)
+        dfa_transitions_[state * (UCHAR_MAX + 1) + byte] = next_state;
+    return next_state;
+}
+
+auto strex::Matcher::dfa_state(std::vector<std::uint32_t> instructions) -> std::int32_t {
+    if (auto iter = dfa_ids_.find(instructions); iter != dfa_ids_.end())
+        return iter->second;
+
+    auto id = static_cast<std::int32_t>(dfa_states_.size());
+    bool is_accepting = std::ranges::any_of(
+        instructions,
+        [&](std::uint32_t pc) { return program_.instructions()[pc].op == OpCode::Match; });
+    dfa_ids_.emplace(instructions, id);
+    dfa_states_.push_back({std::move(instructions), is_accepting});
+    // The dead state has no instructions, it never leaves itself.
+    dfa_transitions_.resize(dfa_transitions_.size() + UCHAR_MAX + 1,
+                            id == dead_state ? dead_state : unknown_state);
+    return id;
+}
+
+void strex::Matcher::add_closure(std::uint32_t start, std::vector<std::uint32_t> &closure) {
+    pending_.push_back(start);
+    while (!pending_.empty()) {
+        std::uint32_t pc = pending_.back();
+        pending_.pop_back();
+        if (visited_[pc] == visit_generation_)
+            continue;
+        visited_[pc] = visit_generation_;
+
+        const Instruction &instruction = program_.instructions()[pc];
+        switch (instruction.op) {
+            case OpCode::Byte:
+            case OpCode::Match:
+                closure.push_back(pc);
+                break;
+            case OpCode::Split:
+                pending_.push_back(instruction.operand);
+                pending_.push_back(instruction.target);
+                break;
+            case OpCode::Jump:
+                pending_.push_back(instruction.target);
+                break;
+            case OpCode::Save:
+            case OpCode::Loop_Check:
+                // Sets of states do not loop forever, and do not need positions.
+                pending_.push_back(pc + 1);
+                break;
+            default:
+                assert(false && "[Matcher::add_closure] the program needs backtracking");
+                std::unreachable();
+        }
+    }
+}
+
+void strex::Matcher::reset_dfa() {
+    dfa_states_.clear();
+    dfa_transitions_.clear();
+    dfa_ids_.clear();
+    dfa_state({});
+
+    if (++visit_generation_ == 0) {
+        std::ranges::fill(visited_, 0);
+        visit_generation_ = 1;
+    }
+    std::vector<std::uint32_t> start;
+    add_closure(0, start);
+    std::ranges::sort(start);
+    start_state_ = dfa_state(std::move(start));
+}
+
+bool strex::Matcher::backtrack(std::string_view text, std::uint32_t pc, std::size_t position,
+                               std::size_t end, std::vector<std::size_t> registers) const {
+    constexpr std::size_t unset = std::string_view::npos;
+    constexpr std::uint32_t restore = std::numeric_limits<std::uint32_t>::max();
+
+    // A branch to try later, or a register to restore when backtracking past a `Save`.
+    struct Choice {
+        std::uint32_t pc; ///< `restore` for a register
+        std::uint32_t register_index;
+        std::size_t position;
+    };
+
+    const auto &instructions = program_.instructions();
+    std::vector<Choice> choices{{pc, 0, position}};
+    while (!choices.empty()) {
+        auto choice = choices.back();
+        choices.pop_back();
+        if (choice.pc == restore) {
+            registers[choice.register_index] = choice.position;
+            continue;
+        }
+        pc = choice.pc;
+        position = choice.position;
+
+        // Runs the thread until it fails.
+        for (bool is_failed = false; !is_failed;) {
+            const Instruction &instruction = instructions[pc];
+            switch (instruction.op) {
+                case OpCode::Byte:
+                    if (position < text.size() &&
+                        program_.byte_sets()[instruction.operand].test(
+                            static_cast<unsigned char>(text[position]))) {
+                        pc++;
+                        position++;
+                    } else {
+                        is_failed = true;
+                    }
+                    break;
+                case OpCode::Split:
+                    choices.push_back({instruction.operand, 0, position});
+                    pc = instruction.target;
+                    break;
+                case OpCode::Jump:
+                    pc = instruction.target;
+                    break;
+                case OpCode::Save:
+                    choices.push_back(
+                        {restore, instruction.operand, registers[instruction.operand]});
+                    registers[instruction.operand] = position;
+                    pc++;
+                    break;
+                case OpCode::Loop_Check:
+                    is_failed = registers[instruction.operand] == position;
+                    pc++;
+                    break;
+                case OpCode::Backref: {
+                    std::size_t start = registers[instruction.operand];
+                    std::size_t stop = registers[instruction.operand + 1];
+                    // A group that has not captured matches the empty string.
+                    if (start != unset && stop != unset && start <= stop) {
+                        std::string_view captured = text.substr(start, stop - start);
+                        if (!text.substr(position).starts_with(captured)) {
+                            is_failed = true;
+                            break;
+                        }
+                        position += captured.size();
+                    }
+                    pc++;
+                    break;
+                }
+                case OpCode::Look: {
+                    // The body runs as a separate thread, captures in it are not kept.
+                    const Lookaround &look = program_.lookarounds()[instruction.operand];
+                    bool is_found = false;
+                    if (!look.is_lookbehind) {
+                        is_found = backtrack(text, pc + 1, position, unset, registers);
+                    } else {
+                        for (std::size_t start = position + 1; start-- > 0 && !is_found;)
+                            is_found = backtrack(text, pc + 1, start, position, registers);
+                    }
+                    is_failed = is_found == look.is_negative;
+                    pc = instruction.target;
+                    break;
+                }
+                case OpCode::Look_End:
+                    if (end == unset || position == end)
+                        return true;
+                    is_failed = true;
+                    break;
+                case OpCode::Assert_Begin:
+                    is_failed = position != 0;
+                    pc++;
+                    break;
+                case OpCode::Assert_End:
+                    is_failed = position != text.size();
+                    pc++;
+                    break;
+                case OpCode::Match:
+                    if (position == text.size())
+                        return true;
+                    is_failed = true;
+                    break;
+            }
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Charset.hpp>
+#include <strex/Optimizer.hpp>
+
+using strex::ASTNode;
+
+// Returns the slots that hold children of node.
+static std::vector<std::unique_ptr<ASTNode> *> children(ASTNode *node) {
+    std::vector<std::unique_ptr<ASTNode> *> slots;
+    if (auto *sequence = dynamic_cast<strex::SequenceNode *>(node)) {
+        for (auto &element : sequence->mutable_sequence())
+            slots.push_back(&element);
+    } else if (auto *alternation = dynamic_cast<strex::AlternationNode *>(node)) {
+        for (auto &element : alternation->mutable_elements())
+            slots.push_back(&element);
+    } else if (auto *repeat = dynamic_cast<strex::RepeatNode *>(node)) {
+        slots.push_back(&repeat->mutable_content());
+    } else if (auto *group = dynamic_cast<strex::GroupNode *>(node)) {
+        slots.push_back(&group->mutable_content());
+    } else if (auto *lookaround = dynamic_cast<strex::LookaroundNode *>(node)) {
+        slots.push_back(&lookaround->mutable_content());
+    }
+    return slots;
+}
+
+// Calls `rewrite` on every slot of the AST, children before their parent.
+// `rewrite` may replace the node in the slot, the new node is not visited again.
+template <typename Rewrite>
+static void rewrite_post_order(std::unique_ptr<ASTNode> &root, Rewrite rewrite) {
+    struct Entry {
+        std::unique_ptr<ASTNode> *slot;
+        bool expanded;
+    };
+    std::vector<Entry> stack{{&root, false}};
+    while (!stack.empty()) {
+        auto [slot, expanded] = stack.back();
+        if (*slot == nullptr) {
+            stack.pop_back();
+            continue;
+        }
+        if (!expanded) {
+            stack.back().expanded = true;
+            for (auto *child : children(slot->get()) | std::views::reverse)
+                stack.push_back({child, false});
+            continue;
+        }
+        stack.pop_back();
+        rewrite(*slot);
+    }
+}
+
+static bool is_empty_text(const ASTNode *node) {
+    auto *text = dynamic_cast<const strex::TextNode *>(node);
+    return text != nullptr && text->text().empty();
+}
+
+void strex::FlattenSequencesPass::run(std::unique_ptr<ASTNode> &ast) {
+    rewrite_post_order(ast, [](std::unique_ptr<ASTNode> &slot) {
+        auto *sequence = dynamic_cast<SequenceNode *>(slot.get());
+        if (sequence == nullptr)
+            return;
+
+        auto &elements = sequence->mutable_sequence();
+        auto is_sequence = [](const auto &node) {
+            return dynamic_cast<const SequenceNode *>(node.get()) != nullptr;
+        };
+        if (std::ranges::any_of(elements, is_sequence)) {
+            // Nested sequences are flattened already, so one level is enough.
+            std::vector<std::unique_ptr<ASTNode>> flattened;
+            for (auto &element : elements) {
+                if (auto *nested = dynamic_cast<SequenceNode *>(element.get())) {
+                    for (auto &nested_element : nested->mutable_sequence())
+                        flattened.push_back(std::move(nested_element));
+                } else {
+                    flattened.push_back(std::move(element));
+                }
+            }
+            elements = std::move(flattened);
+        }
+
+        if (elements.size() == 1)
+            slot = std::move(elements.front());
+    });
+}
+
+void strex::MergeCharAlternationsPass::run(std::unique_ptr<ASTNode> &ast) {
+    rewrite_post_order(ast, [](std::unique_ptr<ASTNode> &slot) {
+        auto *alternation = dynamic_cast<AlternationNode *>(slot.get());
+        if (alternation == nullptr || alternation->elements().size() < 2)
+            return;
+
+        std::string characters;
+        for (const auto &element : alternation->elements()) {
+            auto *text = dynamic_cast<const TextNode *>(element.get());
+            if (text == nullptr || text->text().size() != 1)
+                return;
+            // A charset only generates printable characters.
+            if (!std::isprint(static_cast<unsigned char>(text->text().front())))
+                return;
+            characters.push_back(text->text().front());
+        }
+
+        // Duplicated alternatives are more likely to be chosen than others, which a charset
+        // can not express.
+        std::ranges::sort(characters);
+        if (std::ranges::adjacent_find(characters) != characters.end())
+            return;
+
+        slot = std::make_unique<CharsetNode>(*Charset::get(std::move(characters)),
+                                             alternation->text_range());
+    });
+}
+
+void strex::RemoveEmptyTextPass::run(std::unique_ptr<ASTNode> &ast) {
+    rewrite_post_order(ast, [](std::unique_ptr<ASTNode> &slot) {
+        if (auto *repeat = dynamic_cast<RepeatNode *>(slot.get())) {
+            if (is_empty_text(repeat->content()))
+                slot = std::move(repeat->mutable_content());
+            return;
+        }
+
+        auto *sequence = dynamic_cast<SequenceNode *>(slot.get());
+        if (sequence == nullptr)
+            return;
+
+        auto &elements = sequence->mutable_sequence();
+        std::erase_if(elements, [](const auto &node) { return is_empty_text(node.get()); });
+        if (elements.empty())
+            slot = std::make_unique<TextNode>(std::string{}, sequence->text_range());
+        else if (elements.size() == 1)
+            slot = std::move(elements.front());
+    });
+}
+
+void strex::CollapseUnitRepeatsPass::run(std::unique_ptr<ASTNode> &ast) {
+    rewrite_post_order(ast, [](std::unique_ptr<ASTNode> &slot) {
+        auto *repeat = dynamic_cast<RepeatNode *>(slot.get());
+        if (repeat != nullptr && repeat->repeat_lower() == 1 && repeat->repeat_upper() == 1)
+            slot = std::move(repeat->mutable_content());
+    });
+}
+
+void strex::StripUnusedGroupsPass::run(std::unique_ptr<ASTNode> &ast) {
+    rewrite_post_order(ast, [](std::unique_ptr<ASTNode> &slot) {
+        auto *group = dynamic_cast<GroupNode *>(slot.get());
+        if (group != nullptr && !group->is_referenced())
+            slot = std::move(group->mutable_content());
+    });
+}
+
+void strex::PruneDeadBranchesPass::run(std::unique_ptr<ASTNode> &ast) {
+    // Nodes that can not generate a matching string.
+    std::unordered_set<const ASTNode *> dead;
+    // Removed subtrees, kept alive until backreferences to their groups are replaced.
+    std::vector<std::unique_ptr<ASTNode>> removed;
+
+    auto is_dead = [&](const std::unique_ptr<ASTNode> &node) { return dead.contains(node.get()); };
+
+    rewrite_post_order(ast, [&](std::unique_ptr<ASTNode> &slot) {
+        if (auto *charset = dynamic_cast<const CharsetNode *>(slot.get())) {
+            if (charset->charset()->size() == 0)
+                dead.insert(charset);
+        } else if (auto *sequence = dynamic_cast<const SequenceNode *>(slot.get())) {
+            if (std::ranges::any_of(sequence->sequence(), is_dead))
+                dead.insert(sequence);
+        } else if (auto *group = dynamic_cast<GroupNode *>(slot.get())) {
+            if (is_dead(group->mutable_content()))
+                dead.insert(group);
+        } else if (auto *repeat = dynamic_cast<RepeatNode *>(slot.get())) {
+            if (!is_dead(repeat->mutable_content()))
+                return;
+            if (repeat->repeat_lower() > 0) {
+                dead.insert(repeat);
+                return;
+            }
+            // Only zero repetition is possible.
+            auto empty = std::make_unique<TextNode>(std::string{}, repeat->text_range());
+            removed.push_back(std::move(slot));
+            slot = std::move(empty);
+        } else if (auto *alternation = dynamic_cast<AlternationNode *>(slot.get())) {
+            auto &elements = alternation->mutable_elements();
+            if (std::ranges::all_of(elements, is_dead)) {
+                dead.insert(alternation);
+                return;
+            }
+            for (auto &element : elements) {
+                if (is_dead(element))
+                    removed.push_back(std::move(element));
+            }
+            std::erase(elements, nullptr);
+            if (elements.size() == 1)
+                slot = std::move(elements.front());
+        }
+    });
+
+    if (removed.empty())
+        return;
+
+    std::unordered_set<const GroupNode *> removed_groups;
+    for (auto &node : removed) {
+        rewrite_post_order(node, [&](std::unique_ptr<ASTNode> &slot) {
+            if (auto *group = dynamic_cast<const GroupNode *>(slot.get()))
+                removed_groups.insert(group);
+        });
+    }
+
+    // A removed group never generates, so backreferences to it generate nothing.
+    rewrite_post_order(ast, [&](std::unique_ptr<ASTNode> &slot) {
+        auto *backref = dynamic_cast<const BackrefNode *>(slot.get());
+        if (backref != nullptr && removed_groups.contains(backref->group()))
+            slot = std::make_unique<TextNode>(std::string{}, backref->text_range());
+    });
+}
+
+auto strex::PassManager::default_pipeline() -> PassManager {
+    PassManager manager;
+    // Stripping groups and collapsing repetitions first exposes sequences and alternations to
+    // the other passes.
+    manager.add(std::make_unique<StripUnusedGroupsPass>())
+        .add(std::make_unique<CollapseUnitRepeatsPass>())
+        .add(std::make_unique<PruneDeadBranchesPass>())
+        .add(std::make_unique<RemoveEmptyTextPass>())
+        .add(std::make_unique<MergeCharAlternationsPass>())
+        .add(std::make_unique<FlattenSequencesPass>());
+    return manager;
+}
+
+auto strex::PassManager::matching_pipeline() -> PassManager {
+    PassManager manager;
+    manager.add(std::make_unique<StripUnusedGroupsPass>())
+        .add(std::make_unique<CollapseUnitRepeatsPass>())
+        .add(std::make_unique<RemoveEmptyTextPass>())
+        .add(std::make_unique<MergeCharAlternationsPass>())
+        .add(std::make_unique<FlattenSequencesPass>());
+    return manager;
+}
+
+auto strex::PassManager::add(std::unique_ptr<Pass> pass) -> PassManager & {
+    passes_.push_back(std::move(pass));
+    return *this;
+}
+
+void strex::PassManager::run(std::unique_ptr<ASTNode> &ast) const {
+    for (const auto &pass : passes_)
+        pass->run(ast);
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <strex/Exception.hpp>
+#include <strex/OutputWriter.hpp>
+#include <strex/Sink.hpp>
+
+// Returns the size of a page.
+static std::size_t page_size() {
+#if defined(__linux__)
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 4096;
+#endif
+}
+
+// Checks if `fd` is a pipe that `vmsplice(2)` can fill.
+static bool is_pipe(int fd) {
+#if defined(__linux__)
+    struct stat status;
+    return fstat(fd, &status) == 0 && S_ISFIFO(status.st_mode);
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+// Allocates `size` bytes of pages that nothing else refers to, `size` is a multiple of a page.
+static char *allocate_pages(std::size_t size) {
+#if defined(__linux__)
+    // Pages are faulted in at once, as the whole buffer is written before it is spliced.
+    void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (pages == MAP_FAILED)
+        throw std::bad_alloc();
+    return static_cast<char *>(pages);
+#else
+    return static_cast<char *>(::operator new(size, std::align_val_t{page_size()}));
+#endif
+}
+
+void strex::OutputWriter::PageDelete::operator()(char *pages) const {
+#if defined(__linux__)
+    // Pages spliced into a pipe stay alive until the pipe drops them.
+    munmap(pages, size);
+#else
+    ::operator delete(pages, std::align_val_t{page_size()});
+#endif
+}
+
+strex::OutputWriter::OutputWriter(int fd) : OutputWriter(fd, Mode::Write) {}
+
+strex::OutputWriter::OutputWriter(int fd, Mode mode)
+    : fd_(fd), mode_(mode), buffer_size_(default_buffer_size), buffer_(nullptr, {0}) {
+    if (mode == Mode::Vmsplice) {
+#if defined(__linux__)
+        if (!is_pipe(fd))
+            throw GenerateError("vmsplice output needs a pipe");
+        // The pipe may stay smaller than asked, up to `/proc/sys/fs/pipe-max-size`.
+        fcntl(fd, F_SETPIPE_SZ, static_cast<int>(default_buffer_size));
+        int pipe_size = fcntl(fd, F_GETPIPE_SZ);
+        if (pipe_size <= 0)
+            throw GenerateError("failed to get the size of the output pipe");
+        buffer_size_ = static_cast<std::size_t>(pipe_size);
+#else
+        throw GenerateError("vmsplice output is only supported on Linux");
+#endif
+    }
+    std::size_t page = page_size();
+    buffer_size_ = (buffer_size_ + page - 1) / page * page;
+    buffer_ = {allocate_pages(buffer_size_), {buffer_size_}};
+}
+
+strex::OutputWriter::~OutputWriter() {
+    try {
+        flush();
+    }
+    catch (GenerateError &) {
+        // Destructors do not throw, the error was for `flush` to report.
+    }
+}
+
+void strex::OutputWriter::write(std::string_view text) {
+    while (!text.empty()) {
+        std::size_t size = std::min(text.size(), buffer_size_ - used_);
+        std::memcpy(buffer_.get() + used_, text.data(), size);
+        used_ += size;
+        text.remove_prefix(size);
+        if (used_ == buffer_size_)
+            write_full_buffer();
+    }
+}
+
+void strex::OutputWriter::flush() {
+    // A part of a buffer is copied, so the buffer can be filled again at once. Only full buffers
+    // are spliced, as each one spliced costs new pages.
+    FdSink(fd_).write({buffer_.get(), used_});
+    used_ = 0;
+}
+
+void strex::OutputWriter::write_full_buffer() {
+    if (mode_ == Mode::Write) {
+        FdSink(fd_).write({buffer_.get(), used_});
+        used_ = 0;
+        return;
+    }
+#if defined(__linux__)
+    iovec pages{buffer_.get(), used_};
+    while (pages.iov_len > 0) {
+        ssize_t count = vmsplice(fd_, &pages, 1, SPLICE_F_GIFT);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw GenerateError("failed to splice output into the pipe");
+        }
+        pages.iov_base = static_cast<char *>(pages.iov_base) + count;
+        pages.iov_len -= static_cast<std::size_t>(count);
+    }
+    // The pipe, or wherever the reader moved the pages, may still refer to them.
+    buffer_ = {allocate_pages(buffer_size_), {buffer_size_}};
+    used_ = 0;
+#endif
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <span>
@@ -14,6 +16,7 @@
 #include <strex/Parser.hpp>
 #include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
+#include <strex/Unicode.hpp>
 
 // Pattern ::
 //     Disjunction
@@ -53,6 +56,8 @@
 //     \B
 //     (?=Disjunction)
 //     (?!Disjunction)
+//     (?<=Disjunction)
+//     (?<!Disjunction)
 //
 // Atom ::
 //     PatternCharacter
@@ -67,10 +72,53 @@
 //     CharacterEscape
 //     CharacterClassEscape
 
-strex::Parser::Parser(std::span<const Token> tokens) : tokens_(tokens) {}
+strex::Parser::Parser(std::span<const Token> tokens, int max_repeat)
+    : tokens_(tokens), max_repeat_(max_repeat) {
+    assert(max_repeat >= 0);
+}
 
 auto strex::Parser::parse() -> std::unique_ptr<ASTNode> {
-    auto ast = alternative();
+    frames_.clear();
+    open_frame(peek().range(), TokenType::Left_Paren);
+
+    while (true) {
+        if (match(TokenType::Left_Paren)) {
+            TextRange group_start = previous().range();
+            if (check(TokenType::Non_Capturing_Group) || is_lookaround(peek().type())) {
+                TokenType type = advance().type();
+                open_frame(range_union(group_start, previous().range()), type);
+                continue;
+            }
+            int index = static_cast<int>(groups_.size());
+            // Groups are numbered by the order of their left parentheses.
+            groups_.push_back(nullptr);
+            open_frame(group_start, TokenType::Left_Paren, index);
+        } else if (match(TokenType::Caret) || match(TokenType::Dollar)) {
+            // Anchors are not quantifiable, a quantifier after them is a parse error.
+            auto type = previous().is(TokenType::Caret) ? AnchorNode::Type::Begin
+                                                        : AnchorNode::Type::End;
+            Frame &frame = frames_.back();
+            frame.terms.push_back(std::make_unique<AnchorNode>(type, previous().range()));
+            frame.sequence_end = previous().range();
+        } else if (is_atom(peek().type())) {
+            append_term(atom());
+        } else if (match(TokenType::Alternation)) {
+            Frame &frame = frames_.back();
+            frame.alternatives.push_back(finish_sequence(frame));
+            frame.disjunction_range = range_union(frame.disjunction_range, previous().range());
+            frame.sequence_start = peek().range();
+            frame.sequence_end = frame.sequence_start;
+        } else if (frames_.size() > 1 && match(TokenType::Right_Paren)) {
+            append_term(close_group());
+        } else {
+            break;
+        }
+    }
+
+    if (frames_.size() > 1)
+        throw ParseError("expect ')' to complete group");
+    auto ast = finish_disjunction(frames_.back());
+    frames_.clear();
 
     if (!match(TokenType::End)) {
         if (peek().is_one_of(TokenType::Star, TokenType::Plus, TokenType::Question,
@@ -81,57 +129,80 @@ auto strex::Parser::parse() -> std::unique_ptr<ASTNode> {
     return ast;
 }
 
-auto strex::Parser::alternative() -> std::unique_ptr<ASTNode> {
-    TextRange range = peek().range();
-    auto alter = sequence();
-    if (check(TokenType::Alternation)) {
-        std::vector<std::unique_ptr<ASTNode>> elements;
-        elements.emplace_back(std::move(alter));
-        while (match(TokenType::Alternation)) {
-            range = range_union(range, previous().range());
-            elements.emplace_back(sequence());
-        }
-        return std::make_unique<AlternationNode>(std::move(elements), range);
-    }
-    return alter;
+void strex::Parser::open_frame(const TextRange &group_start, TokenType group_type,
+                               int group_index) {
+    TextRange start = peek().range();
+    frames_.push_back({{}, {}, start, start, start, group_start, group_type, group_index});
 }
 
-auto strex::Parser::sequence() -> std::unique_ptr<ASTNode> {
-    std::vector<std::unique_ptr<ASTNode>> elements;
-    TextRange start_range = peek().range();
-    TextRange end_range = start_range;
-    while (is_atom(peek().type())) {
-        elements.push_back(term());
-        end_range = previous().range();
+auto strex::Parser::close_group() -> std::unique_ptr<ASTNode> {
+    assert(previous().is(TokenType::Right_Paren));
+    Frame &frame = frames_.back();
+    auto subexpression = finish_disjunction(frame);
+    if (frame.group_type == TokenType::Non_Capturing_Group) {
+        frames_.pop_back();
+        return subexpression;
+    }
+    if (is_lookaround(frame.group_type)) {
+        bool is_lookbehind = frame.group_type == TokenType::Positive_Lookbehind ||
+                             frame.group_type == TokenType::Negative_Lookbehind;
+        bool is_negative = frame.group_type == TokenType::Negative_Lookahead ||
+                           frame.group_type == TokenType::Negative_Lookbehind;
+        auto lookaround = std::make_unique<LookaroundNode>(
+            std::move(subexpression), is_lookbehind, is_negative,
+            range_union(frame.group_start, previous().range()));
+        frames_.pop_back();
+        return lookaround;
     }
+    auto group = std::make_unique<GroupNode>(std::move(subexpression), frame.group_index,
+                                             range_union(frame.group_start, previous().range()));
+    groups_[frame.group_index] = group.get();
+    frames_.pop_back();
+    return group;
+}
+
+void strex::Parser::append_term(std::unique_ptr<ASTNode> atom) {
+    if (is_quantifier(peek().type()))
+        atom = quantifier(std::move(atom));
+    Frame &frame = frames_.back();
+    frame.terms.push_back(std::move(atom));
+    frame.sequence_end = previous().range();
+}
+
+auto strex::Parser::finish_sequence(Frame &frame) -> std::unique_ptr<ASTNode> {
+    auto elements = std::move(frame.terms);
+    frame.terms.clear();
     // No need for `SequenceNode` when there is only one element.
     if (elements.size() == 1)
         return std::move(elements[0]);
-    return std::make_unique<SequenceNode>(std::move(elements), range_union(start_range, end_range));
+    return std::make_unique<SequenceNode>(std::move(elements),
+                                          range_union(frame.sequence_start, frame.sequence_end));
 }
 
-auto strex::Parser::term() -> std::unique_ptr<ASTNode> {
-    auto content = atom();
-    if (is_quantifier(peek().type()))
-        return quantifier(std::move(content));
-    return content;
+auto strex::Parser::finish_disjunction(Frame &frame) -> std::unique_ptr<ASTNode> {
+    // An alternation covers its last alternative too, unless the alternative is empty.
+    TextRange range = frame.disjunction_range;
+    if (!frame.terms.empty())
+        range = range_union(range, frame.sequence_end);
+    auto alter = finish_sequence(frame);
+    if (frame.alternatives.empty())
+        return alter;
+    auto elements = std::move(frame.alternatives);
+    elements.push_back(std::move(alter));
+    return std::make_unique<AlternationNode>(std::move(elements), range);
 }
 
 auto strex::Parser::atom() -> std::unique_ptr<ASTNode> {
     TextRange range = peek().range();
 
-    if (match(TokenType::Character))
-        return std::make_unique<TextNode>(previous().character(), range);
-
-    if (match(TokenType::Char_Class)) {
-        if (previous().character() == '.')
-            return std::make_unique<CharsetNode>(*Charset::any(), range);
-        return std::make_unique<CharsetNode>(*Charset::from_char_class(previous().character()),
-                                             range);
+    if (match(TokenType::Character)) {
+        std::string text;
+        unicode::append_utf8(text, previous().code_point());
+        return std::make_unique<TextNode>(std::move(text), range);
     }
 
-    if (match(TokenType::Left_Paren))
-        return group();
+    if (match(TokenType::Char_Class))
+        return std::make_unique<CharsetNode>(*char_class_charset(previous()), range);
 
     if (match(TokenType::Left_Bracket))
         return charset();
@@ -145,136 +216,116 @@ auto strex::Parser::atom() -> std::unique_ptr<ASTNode> {
 
 auto strex::Parser::quantifier(std::unique_ptr<ASTNode> content) -> std::unique_ptr<ASTNode> {
     assert(is_quantifier(peek().type()));
+    // A repetition covers its content and the quantifier.
+    TextRange content_range = content->text_range();
     if (match(TokenType::Star))
-        return std::make_unique<RepeatNode>(std::move(content), 0, default_max_repeat_count,
-                                            previous().range());
+        return std::make_unique<RepeatNode>(std::move(content), 0, max_repeat_,
+                                            range_union(content_range, previous().range()), true);
     if (match(TokenType::Plus))
-        return std::make_unique<RepeatNode>(std::move(content), 1, default_max_repeat_count,
-                                            previous().range());
+        return std::make_unique<RepeatNode>(std::move(content), 1, std::max(max_repeat_, 1),
+                                            range_union(content_range, previous().range()), true);
     if (match(TokenType::Question))
-        return std::make_unique<RepeatNode>(std::move(content), 0, 1, previous().range());
+        return std::make_unique<RepeatNode>(std::move(content), 0, 1,
+                                            range_union(content_range, previous().range()));
 
     if (match(TokenType::Repeat)) {
         const Token &quantifier = previous();
         int lower = quantifier.repeat_lower();
-        // If the upper bound is open-ended (-1), we use the lower bound plus default_max_repeat_count
-        // to provide a practical limit for repetition, preventing potential infinite loops.
-        int max_repeat_count = (quantifier.repeat_upper() == -1 ? lower + default_max_repeat_count
-                                                                : quantifier.repeat_upper());
+        // If the upper bound is open-ended (-1), we use the lower bound plus `max_repeat_` to
+        // provide a practical limit for repetition, preventing potential infinite loops.
+        int max_repeat_count = quantifier.repeat_upper();
+        if (max_repeat_count == -1)
+            max_repeat_count = lower > INT_MAX - max_repeat_ ? INT_MAX : lower + max_repeat_;
         return std::make_unique<RepeatNode>(std::move(content), quantifier.repeat_lower(),
-                                            max_repeat_count, quantifier.range());
+                                            max_repeat_count,
+                                            range_union(content_range, quantifier.range()),
+                                            quantifier.repeat_upper() == -1);
     }
 
     // This code path should never be hit because all quantifier cases are handled above.
     std::unreachable();
 }
 
-auto strex::Parser::group() -> std::unique_ptr<ASTNode> {
-    // TODO record index of group
-    TextRange start_range = previous().range();
-    auto subexpression = alternative();
-    consume(TokenType::Right_Paren, "expect ')' to complete group");
-    TextRange end_range = previous().range();
-
-    auto group =
-        std::make_unique<GroupNode>(std::move(subexpression), static_cast<int>(groups_.size()),
-                                    range_union(start_range, end_range));
-    if (group->index() > max_group_number)
-        throw ParseError("group number reaches limit {}", max_group_number);
-
-    groups_.push_back(group.get());
-
-    return group;
-}
-
-/// Returns ASCII characters that are not in parameter `except`.
-static std::string exclude(std::string except);
-
 auto strex::Parser::charset() -> std::unique_ptr<ASTNode> {
     TextRange start_range = previous().range();
     bool is_inclusive = !match(TokenType::Caret);
-    std::string characters = charset_item_list();
+    auto [members, generated] = charset_item_list();
 
-    if (!is_inclusive)
-        characters = exclude(characters);
-    is_inclusive = true;
+    // A negated set has almost all code points, but generates printable ASCII characters only.
+    if (!is_inclusive) {
+        unicode::normalize(members);
+        members = unicode::complement(members);
+        generated = {unicode::ascii_printable};
+    }
 
     const Token &end_token = consume(TokenType::Right_Bracket, "expect ']' to close character set");
     TextRange range = range_union(start_range, end_token.range());
-    const Charset *cs = Charset::get(characters);
+    const Charset *cs = Charset::get(std::move(members), std::move(generated));
     return std::make_unique<CharsetNode>(*cs, range);
 }
 
 auto strex::Parser::backreference() -> std::unique_ptr<ASTNode> {
     int group_number = previous().group_number();
     assert(group_number != 0);
-    // if backreference is before the associated group, matches zero-length text
-    if (group_number >= static_cast<int>(groups_.size())) {
+    // if backreference is before the end of the associated group, matches zero-length text
+    if (group_number >= static_cast<int>(groups_.size()) || groups_[group_number] == nullptr)
         return std::make_unique<TextNode>("", previous().range());
-    } else {
-        const GroupNode *group = groups_[group_number];
-        assert(group != nullptr);
-        return std::make_unique<BackrefNode>(group, previous().range());
-    }
+    groups_[group_number]->mark_referenced();
+    return std::make_unique<BackrefNode>(groups_[group_number], previous().range());
 }
 
-std::string strex::Parser::charset_item_list() {
-    std::string characters;
+auto strex::Parser::charset_item_list() -> std::pair<Charset::Ranges, Charset::Ranges> {
+    // Items are collected as ranges, so the cost is linear in the number of items rather than
+    // in the number of code points.
+    Charset::Ranges members;
+    Charset::Ranges generated;
+    auto include = [&](CodePointRange range) {
+        members.push_back(range);
+        generated.push_back(range);
+    };
     while (!is_end() && !check(TokenType::Right_Bracket)) {
         assert(peek().is_one_of(TokenType::Character, TokenType::Char_Class, TokenType::Hyphen));
         if (is_char_range()) {
-            characters.append(char_range());
+            include(char_range());
         } else if (check(TokenType::Character)) {
-            characters.push_back(advance().character());
+            char32_t code_point = advance().code_point();
+            include({code_point, code_point});
         } else if (check(TokenType::Char_Class)) {
-            auto cs = Charset::from_char_class(advance().character());
-            if (cs->is_inclusive())
-                characters.append(cs->alphabet());
-            else
-                characters.append(exclude(std::string{cs->alphabet()}));
+            const Charset *cs = char_class_charset(advance());
+            std::ranges::copy(cs->members(), std::back_inserter(members));
+            std::ranges::copy(cs->generated(), std::back_inserter(generated));
         } else if (check(TokenType::Hyphen)) {
             advance();
-            characters.push_back('-');
+            include({'-', '-'});
         }
     }
-    return characters;
+    return {std::move(members), std::move(generated)};
 }
 
-bool strex::Parser::is_char_range() {
-    // TODO Use scope guard to simplify code.
-    auto position = current_position_;
-    if (!check(TokenType::Character)) {
-        current_position_ = position;
-        return false;
-    }
-    advance();
-    if (!check(TokenType::Hyphen)) {
-        current_position_ = position;
-        return false;
-    }
-    advance();
-    if (!check(TokenType::Character)) {
-        current_position_ = position;
-        return false;
-    }
-    current_position_ = position;
-    return true;
+bool strex::Parser::is_char_range() const {
+    return check(TokenType::Character) && peek(1).is(TokenType::Hyphen) &&
+           peek(2).is(TokenType::Character);
 }
 
-std::string strex::Parser::char_range() {
-    char start = advance().character();
+auto strex::Parser::char_range() -> CodePointRange {
+    char32_t start = advance().code_point();
     advance();
-    char end = advance().character();
+    char32_t end = advance().code_point();
     if (start > end)
-        throw ParseError("invalid character range: {}-{} ({:#02x}-{:#02x})", start, end, start,
-                         end);
-    std::string characters;
-    characters.resize_and_overwrite(end - start + 1, [=](char *s, std::size_t size) {
-        for (std::size_t i = 0; i < size; i++)
-            s[i] = static_cast<char>(start + i);
-        return size;
-    });
-    return characters;
+        throw ParseError("invalid character range: U+{:04X}-U+{:04X}",
+                         static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end));
+    return {start, end};
+}
+
+auto strex::Parser::char_class_charset(const Token &token) -> const Charset * {
+    switch (token.character()) {
+        case 'p':
+            return Charset::from_property(token.categories(), true);
+        case 'P':
+            return Charset::from_property(token.categories(), false);
+        default:
+            return Charset::from_char_class(token.character());
+    }
 }
 
 bool strex::Parser::is_atom(TokenType type) const {
@@ -283,6 +334,11 @@ bool strex::Parser::is_atom(TokenType type) const {
            type == TokenType::Backreference;
 }
 
+bool strex::Parser::is_lookaround(TokenType type) const {
+    return type == TokenType::Positive_Lookahead || type == TokenType::Negative_Lookahead ||
+           type == TokenType::Positive_Lookbehind || type == TokenType::Negative_Lookbehind;
+}
+
 bool strex::Parser::is_quantifier(TokenType type) const {
     return type == TokenType::Star || type == TokenType::Plus || type == TokenType::Question ||
            type == TokenType::Repeat;
@@ -313,6 +369,12 @@ auto strex::Parser::peek() const -> const Token & {
     return tokens_[current_position_];
 }
 
+auto strex::Parser::peek(std::size_t offset) const -> const Token & {
+    assert(!tokens_.empty() && tokens_.back().is(TokenType::End));
+    // Tokens end with `End`, looking beyond it returns `End`.
+    return tokens_[std::min(current_position_ + offset, tokens_.size() - 1)];
+}
+
 auto strex::Parser::previous() const -> const Token & {
     assert(current_position_ != 0);
     return tokens_[current_position_ - 1];
@@ -329,25 +391,4 @@ auto strex::Parser::advance() -> const Token & {
 bool strex::Parser::is_end() const {
     assert(current_position_ < tokens_.size());
     return tokens_[current_position_].is(TokenType::End);
-}
-
-std::string exclude(std::string except) {
-    static const auto ascii_characters = [] {
-        std::string s;
-        s.resize_and_overwrite(128, [](char *s, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++)
-                s[i] = static_cast<char>(i);
-            return n;
-        });
-        return s;
-    }();
-
-    // Parameters of `set_difference` must be sorted.
-    std::ranges::sort(except);
-    auto [last, end] = std::ranges::unique(except);
-    except.erase(last, end);
-
-    std::string result;
-    std::ranges::set_difference(ascii_characters, except, std::back_inserter(result));
-    return result;
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <strex/Pipeline.hpp>
+#include <strex/Sink.hpp>
+#include <strex/Stats.hpp>
+
+/// Rings between one worker and the writer.
+struct strex::Pipeline::Lane {
+    SpscRing<Block *> filled; ///< blocks to write, in the order of their indices
+    SpscRing<Block *> free;   ///< blocks written, to fill again
+    std::atomic<bool> is_done{false};
+    std::atomic<std::uint32_t> free_signal{0}; ///< bumped when a block is freed, the worker waits
+
+    explicit Lane(std::size_t blocks) : filled(blocks), free(blocks) {}
+};
+
+strex::Pipeline::Pipeline(const Options &options) : options_(options) {
+    if (options.workers == 0 || options.blocks_per_worker == 0)
+        throw std::invalid_argument("a pipeline needs at least one worker and one block");
+    blocks_.resize(options.workers * options.blocks_per_worker);
+    for (Block &block : blocks_)
+        block.data.reserve(options.block_size);
+    for (std::size_t i = 0; i < options.workers; i++)
+        lanes_.push_back(std::make_unique<Lane>(options.blocks_per_worker));
+}
+
+strex::Pipeline::~Pipeline() {}
+
+void strex::Pipeline::run(const Producer &produce, Sink &sink) {
+    stopped_ = false;
+    has_error_ = false;
+    error_ = nullptr;
+    // Rings are empty between runs, every block goes back to its worker.
+    for (std::size_t i = 0; i < options_.workers; i++) {
+        lanes_[i]->is_done = false;
+        for (std::size_t j = 0; j < options_.blocks_per_worker; j++)
+            lanes_[i]->free.push(&blocks_[i * options_.blocks_per_worker + j]);
+    }
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < options_.workers; i++)
+            threads.emplace_back([this, &produce, i] { work(produce, i); });
+        try {
+            write(sink);
+        }
+        catch (...) {
+            fail(std::current_exception());
+        }
+    }
+    // Blocks left in rings after a failure, or not filled when a worker was done, are taken
+    // back, and the next run gives them out again.
+    for (auto &lane : lanes_) {
+        Block *block = nullptr;
+        while (lane->filled.pop(block) || lane->free.pop(block)) {
+        }
+    }
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void strex::Pipeline::work(const Producer &produce, std::size_t worker) {
+    Lane &lane = *lanes_[worker];
+    try {
+        for (std::uint64_t index = worker; !stopped_; index += options_.workers) {
+            Block *block = nullptr;
+            for (;;) {
+                // The signal is read before the ring, so a block freed after the check ends the
+                // wait at once.
+                std::uint32_t signal = lane.free_signal.load(std::memory_order_acquire);
+                if (lane.free.pop(block) || stopped_)
+                    break;
+                lane.free_signal.wait(signal, std::memory_order_acquire);
+            }
+            if (block == nullptr)
+                break;
+            block->index = index;
+            block->data.clear();
+            // The writer is the only thread that pushes to `free`, so a block that is not
+            // filled stays out of the rings until `run` takes it back.
+            if (!produce(worker, *block))
+                break;
+            // The ring holds every block of the worker, so it is never full.
+            lane.filled.push(block);
+            signal_filled();
+        }
+    }
+    catch (...) {
+        fail(std::current_exception());
+    }
+    strex::stats::flush();
+    lane.is_done.store(true, std::memory_order_release);
+    signal_filled();
+}
+
+void strex::Pipeline::write(Sink &sink) {
+    // Takes the next block of `lane`, or returns false if it has none yet. A lane that is done
+    // is checked again, as its last block may have come after the check that found it empty.
+    auto take = [](Lane &lane, Block *&block, bool &is_finished) {
+        if (lane.filled.pop(block))
+            return true;
+        if (!lane.is_done.load(std::memory_order_acquire))
+            return false;
+        is_finished = !lane.filled.pop(block);
+        return !is_finished;
+    };
+    auto put = [&](Lane &lane, Block *block) {
+        sink.write(block->data);
+        lane.free.push(block);
+        lane.free_signal.fetch_add(1, std::memory_order_release);
+        lane.free_signal.notify_one();
+    };
+
+    if (options_.ordered) {
+        // Block `index` is in lane `index % workers`, so the lanes are visited in turn. When a
+        // lane is finished, no block after its last one exists.
+        for (std::size_t lane = 0; !stopped_; lane = (lane + 1) % options_.workers) {
+            Block *block = nullptr;
+            bool is_finished = false;
+            for (;;) {
+                std::uint32_t signal = filled_signal_.load(std::memory_order_acquire);
+                if (take(*lanes_[lane], block, is_finished))
+                    break;
+                if (is_finished || stopped_)
+                    return;
+                filled_signal_.wait(signal, std::memory_order_acquire);
+            }
+            put(*lanes_[lane], block);
+        }
+        return;
+    }
+
+    std::vector<bool> is_finished(options_.workers, false);
+    std::size_t finished = 0;
+    while (finished < options_.workers && !stopped_) {
+        std::uint32_t signal = filled_signal_.load(std::memory_order_acquire);
+        bool has_written = false;
+        for (std::size_t lane = 0; lane < options_.workers; lane++) {
+            if (is_finished[lane])
+                continue;
+            Block *block = nullptr;
+            bool is_lane_finished = false;
+            // Writes what the lane has ready, at most its number of blocks in a row.
+            for (std::size_t i = 0; i < options_.blocks_per_worker; i++) {
+                if (!take(*lanes_[lane], block, is_lane_finished))
+                    break;
+                put(*lanes_[lane], block);
+                has_written = true;
+            }
+            if (is_lane_finished) {
+                is_finished[lane] = true;
+                finished++;
+            }
+        }
+        if (!has_written && finished < options_.workers && !stopped_)
+            filled_signal_.wait(signal, std::memory_order_acquire);
+    }
+}
+
+void strex::Pipeline::fail(std::exception_ptr error) {
+    if (!has_error_.exchange(true))
+        error_ = std::move(error);
+    stopped_ = true;
+    for (auto &lane : lanes_) {
+        lane->free_signal.fetch_add(1, std::memory_order_release);
+        lane->free_signal.notify_one();
+    }
+    signal_filled();
+}
+
+void strex::Pipeline::signal_filled() {
+    filled_signal_.fetch_add(1, std::memory_order_release);
+    filled_signal_.notify_one();
+}
\ No newline at end of file
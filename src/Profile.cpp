@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Profile.hpp>
+#include <strex/strex.hpp>
+
+// Returns children of node in order.
+static std::vector<const strex::ASTNode *> children(const strex::ASTNode *node) {
+    std::vector<const strex::ASTNode *> result;
+    if (auto *sequence = dynamic_cast<const strex::SequenceNode *>(node)) {
+        for (const auto &element : sequence->sequence())
+            result.push_back(element.get());
+    } else if (auto *alternation = dynamic_cast<const strex::AlternationNode *>(node)) {
+        for (const auto &element : alternation->elements())
+            result.push_back(element.get());
+    } else if (auto *repeat = dynamic_cast<const strex::RepeatNode *>(node)) {
+        result.push_back(repeat->content());
+    } else if (auto *group = dynamic_cast<const strex::GroupNode *>(node)) {
+        result.push_back(group->content());
+    } else if (auto *lookaround = dynamic_cast<const strex::LookaroundNode *>(node)) {
+        result.push_back(lookaround->content());
+    }
+    return result;
+}
+
+strex::Profile::Profile(const ParsedRegex &regex) : Profile(regex.ast()) {}
+
+strex::Profile::Profile(const ASTNode *ast) {
+    std::vector<std::pair<const ASTNode *, std::size_t>> pending{{ast, 0}};
+    while (!pending.empty()) {
+        auto [node, depth] = pending.back();
+        pending.pop_back();
+        indices_.emplace(node, nodes_.size());
+        nodes_.push_back({node, node->text_range(), depth});
+        for (const ASTNode *child : children(node) | std::views::reverse)
+            pending.emplace_back(child, depth + 1);
+    }
+}
+
+std::uint64_t strex::Profile::total_ns() const {
+    std::uint64_t total = 0;
+    for (const Node &node : nodes_)
+        total += node.self_ns;
+    return total;
+}
+
+std::string strex::Profile::heat_map(std::string_view regex) const {
+    std::vector<double> heat(regex.size(), 0.0);
+    for (const Node &node : nodes_) {
+        std::size_t start = std::min(node.range.start, regex.size());
+        std::size_t end = std::min(node.range.end, regex.size());
+        if (start == end)
+            continue;
+        double share = static_cast<double>(node.self_ns) / static_cast<double>(end - start);
+        for (std::size_t i = start; i < end; i++)
+            heat[i] += share;
+    }
+
+    constexpr std::string_view levels = " .:-=+*#%@";
+    std::string map(regex.size(), ' ');
+    if (regex.empty())
+        return map;
+    double hottest = std::ranges::max(heat);
+    if (hottest <= 0.0)
+        return map;
+    for (std::size_t i = 0; i < regex.size(); i++) {
+        auto level = static_cast<std::size_t>(heat[i] / hottest * (levels.size() - 1) + 0.5);
+        map[i] = levels[level];
+    }
+    return map;
+}
@@ -0,0 +1,314 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Charset.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Program.hpp>
+#include <strex/Unicode.hpp>
+#include <strex/Visitor.hpp>
+
+/// Compiles an AST to instructions, from an explicit stack of tasks like `Generator`.
+/// Jumps to the end of a construct are not known when they are emitted, they are linked into a
+/// chain through their `operand` and patched when the construct is complete.
+class strex::Program::Compiler : public ASTVisitor {
+ public:
+    explicit Compiler(Program &program) : program_(program) {}
+
+    void compile(const ASTNode *ast);
+
+ private:
+    enum class TaskType {
+        Visit,            ///< compiles the node
+        Close_Group,      ///< records where a group ends
+        Next_Alternative, ///< ends an alternative, and compiles the next one
+        Repeat,           ///< compiles the content of a `RepeatNode` for remaining times
+        Optional_Repeat,  ///< compiles the content for remaining times, each may be skipped
+        Loop,             ///< compiles the content as a loop, for open-ended repetitions
+        Close_Loop,       ///< ends an iteration of a loop
+        Close_Lookaround, ///< ends the body of a lookaround
+        Patch             ///< points a chain of jumps to current instruction
+    };
+
+    /// A pending step of compilation.
+    struct Task {
+        TaskType type;
+        const ASTNode *node;
+        std::uint32_t count{0}; ///< remaining repetitions, index of alternative, or register
+        std::uint32_t chain{no_chain}; ///< last jump of a chain to patch
+        std::uint32_t pc{0};           ///< a `Split`, `Jump` or `Look` to patch
+    };
+
+    constexpr static std::uint32_t no_chain = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t emit(OpCode op, std::uint32_t target = 0, std::uint32_t operand = 0);
+
+    /// Returns the index of a byte set in `byte_sets_`, equal sets share an index.
+    std::uint32_t byte_set_index(const ByteSet &bytes);
+
+    /// Returns the first of the two registers that hold the capture of a group.
+    std::uint32_t group_registers(int index);
+
+    /// Points every jump in the chain to the next instruction.
+    void patch(std::uint32_t chain);
+
+    void visit(const TextNode *node) override;
+
+    void visit(const CharsetNode *node) override;
+
+    void visit(const SequenceNode *node) override;
+
+    void visit(const RepeatNode *node) override;
+
+    void visit(const GroupNode *node) override;
+
+    void visit(const AlternationNode *node) override;
+
+    void visit(const BackrefNode *node) override;
+
+    void visit(const AnchorNode *node) override;
+
+    void visit(const LookaroundNode *node) override;
+
+    Program &program_;
+    std::vector<Task> tasks_;
+    std::unordered_map<ByteSet, std::uint32_t> byte_set_indices_;
+    std::vector<std::uint32_t> group_registers_; ///< registers indexed by group number
+};
+
+void strex::Program::Compiler::compile(const ASTNode *ast) {
+    tasks_.push_back({TaskType::Visit, ast});
+    while (!tasks_.empty()) {
+        Task task = tasks_.back();
+        tasks_.pop_back();
+        switch (task.type) {
+            case TaskType::Visit:
+                task.node->accept(this);
+                break;
+            case TaskType::Close_Group:
+                emit(OpCode::Save, 0, task.count);
+                break;
+            case TaskType::Next_Alternative: {
+                const auto &elements = static_cast<const AlternationNode *>(task.node)->elements();
+                std::uint32_t jump = emit(OpCode::Jump, 0, task.chain);
+                program_.instructions_[task.pc].operand = static_cast<std::uint32_t>(
+                    program_.instructions_.size());
+                std::uint32_t index = task.count + 1;
+                if (index + 1 < elements.size()) {
+                    std::uint32_t split = emit(OpCode::Split, 0, no_chain);
+                    program_.instructions_[split].target = split + 1;
+                    tasks_.push_back({TaskType::Next_Alternative, task.node, index, jump, split});
+                } else {
+                    tasks_.push_back({TaskType::Patch, task.node, 0, jump});
+                }
+                tasks_.push_back({TaskType::Visit, elements[index].get()});
+                break;
+            }
+            case TaskType::Repeat:
+                if (task.count > 1)
+                    tasks_.push_back({TaskType::Repeat, task.node, task.count - 1});
+                tasks_.push_back({TaskType::Visit,
+                                  static_cast<const RepeatNode *>(task.node)->content()});
+                break;
+            case TaskType::Optional_Repeat: {
+                // Skipping an iteration skips all iterations after it, so the nesting
+                // `(x(x(x)?)?)?` keeps the sets of active instructions small.
+                std::uint32_t split = emit(OpCode::Split, 0, task.chain);
+                program_.instructions_[split].target = split + 1;
+                if (task.count > 1)
+                    tasks_.push_back(
+                        {TaskType::Optional_Repeat, task.node, task.count - 1, split});
+                else
+                    tasks_.push_back({TaskType::Patch, task.node, 0, split});
+                tasks_.push_back({TaskType::Visit,
+                                  static_cast<const RepeatNode *>(task.node)->content()});
+                break;
+            }
+            case TaskType::Loop: {
+                // loop: Split(body, end); Save(r); body; Loop_Check(r); Jump(loop); end:
+                // `Loop_Check` stops an iteration that consumes nothing from looping forever.
+                std::uint32_t loop = emit(OpCode::Split, 0, no_chain);
+                program_.instructions_[loop].target = loop + 1;
+                auto start = static_cast<std::uint32_t>(program_.registers_++);
+                emit(OpCode::Save, 0, start);
+                tasks_.push_back({TaskType::Close_Loop, task.node, start, no_chain, loop});
+                tasks_.push_back({TaskType::Visit,
+                                  static_cast<const RepeatNode *>(task.node)->content()});
+                break;
+            }
+            case TaskType::Close_Loop:
+                emit(OpCode::Loop_Check, 0, task.count);
+                emit(OpCode::Jump, task.pc);
+                program_.instructions_[task.pc].operand = static_cast<std::uint32_t>(
+                    program_.instructions_.size());
+                break;
+            case TaskType::Close_Lookaround:
+                emit(OpCode::Look_End, 0, task.count);
+                program_.instructions_[task.pc].target = static_cast<std::uint32_t>(
+                    program_.instructions_.size());
+                break;
+            case TaskType::Patch:
+                patch(task.chain);
+                break;
+        }
+    }
+    emit(OpCode::Match);
+}
+
+auto strex::Program::Compiler::emit(OpCode op, std::uint32_t target, std::uint32_t operand)
+    -> std::uint32_t {
+    if (program_.instructions_.size() >= max_size)
+        throw SyntaxNotSupport("regular expression is too large to match");
+    program_.instructions_.push_back({op, target, operand});
+    return static_cast<std::uint32_t>(program_.instructions_.size() - 1);
+}
+
+auto strex::Program::Compiler::byte_set_index(const ByteSet &bytes) -> std::uint32_t {
+    auto [iter, is_new] = byte_set_indices_.try_emplace(bytes, program_.byte_sets_.size());
+    if (is_new)
+        program_.byte_sets_.push_back(bytes);
+    return iter->second;
+}
+
+auto strex::Program::Compiler::group_registers(int index) -> std::uint32_t {
+    auto group = static_cast<std::size_t>(index);
+    if (group >= group_registers_.size())
+        group_registers_.resize(group + 1, no_chain);
+    if (group_registers_[group] == no_chain) {
+        group_registers_[group] = static_cast<std::uint32_t>(program_.registers_);
+        program_.registers_ += 2;
+    }
+    return group_registers_[group];
+}
+
+void strex::Program::Compiler::patch(std::uint32_t chain) {
+    auto pc = static_cast<std::uint32_t>(program_.instructions_.size());
+    while (chain != no_chain) {
+        Instruction &instruction = program_.instructions_[chain];
+        chain = instruction.operand;
+        if (instruction.op == OpCode::Jump)
+            instruction.target = pc;
+        instruction.operand = pc;
+    }
+}
+
+void strex::Program::Compiler::visit(const TextNode *node) {
+    for (char ch : node->text()) {
+        ByteSet bytes;
+        bytes.set(static_cast<unsigned char>(ch));
+        emit(OpCode::Byte, 0, byte_set_index(bytes));
+    }
+}
+
+void strex::Program::Compiler::visit(const CharsetNode *node) {
+    // A code point is matched as its UTF-8 sequence. ASCII code points share one byte set, longer
+    // sequences are alternatives after it.
+    ByteSet ascii;
+    std::vector<unicode::Utf8Sequence> alternatives;
+    for (unicode::Utf8Sequence &sequence : unicode::utf8_sequences(node->charset()->members())) {
+        if (sequence.size() > 1) {
+            alternatives.push_back(std::move(sequence));
+            continue;
+        }
+        for (unsigned byte = sequence[0].first; byte <= sequence[0].last; byte++)
+            ascii.set(byte);
+    }
+    if (ascii.any() || alternatives.empty())
+        alternatives.insert(alternatives.begin(), unicode::Utf8Sequence{});
+
+    std::uint32_t chain = no_chain;
+    for (std::size_t i = 0; i < alternatives.size(); i++) {
+        bool is_last = i + 1 == alternatives.size();
+        std::uint32_t split = 0;
+        if (!is_last) {
+            split = emit(OpCode::Split);
+            program_.instructions_[split].target = split + 1;
+        }
+        if (alternatives[i].empty())
+            emit(OpCode::Byte, 0, byte_set_index(ascii));
+        for (unicode::ByteRange range : alternatives[i]) {
+            ByteSet bytes;
+            for (unsigned byte = range.first; byte <= range.last; byte++)
+                bytes.set(byte);
+            emit(OpCode::Byte, 0, byte_set_index(bytes));
+        }
+        if (!is_last) {
+            chain = emit(OpCode::Jump, 0, chain);
+            program_.instructions_[split].operand = static_cast<std::uint32_t>(
+                program_.instructions_.size());
+        }
+    }
+    patch(chain);
+}
+
+void strex::Program::Compiler::visit(const SequenceNode *node) {
+    // The last pushed task runs first.
+    for (const auto &element : node->sequence() | std::views::reverse)
+        tasks_.push_back({TaskType::Visit, element.get()});
+}
+
+void strex::Program::Compiler::visit(const RepeatNode *node) {
+    auto lower = static_cast<std::uint32_t>(node->repeat_lower());
+    auto upper = static_cast<std::uint32_t>(node->repeat_upper());
+
+    // The last pushed task runs first, required iterations are compiled before optional ones.
+    if (node->is_open_ended())
+        tasks_.push_back({TaskType::Loop, node});
+    else if (upper > lower)
+        tasks_.push_back({TaskType::Optional_Repeat, node, upper - lower});
+    if (lower > 0)
+        tasks_.push_back({TaskType::Repeat, node, lower});
+}
+
+void strex::Program::Compiler::visit(const GroupNode *node) {
+    if (!node->is_referenced()) {
+        tasks_.push_back({TaskType::Visit, node->content()});
+        return;
+    }
+    std::uint32_t registers = group_registers(node->index());
+    emit(OpCode::Save, 0, registers);
+    tasks_.push_back({TaskType::Close_Group, node, registers + 1});
+    tasks_.push_back({TaskType::Visit, node->content()});
+}
+
+void strex::Program::Compiler::visit(const AlternationNode *node) {
+    const auto &elements = node->elements();
+    if (elements.empty())
+        return;
+    if (elements.size() > 1) {
+        std::uint32_t split = emit(OpCode::Split, 0, no_chain);
+        program_.instructions_[split].target = split + 1;
+        tasks_.push_back({TaskType::Next_Alternative, node, 0, no_chain, split});
+    }
+    tasks_.push_back({TaskType::Visit, elements[0].get()});
+}
+
+void strex::Program::Compiler::visit(const BackrefNode *node) {
+    program_.has_backref_ = true;
+    emit(OpCode::Backref, 0, group_registers(node->group()->index()));
+}
+
+void strex::Program::Compiler::visit(const AnchorNode *node) {
+    program_.has_assertion_ = true;
+    emit(node->type() == AnchorNode::Type::Begin ? OpCode::Assert_Begin : OpCode::Assert_End);
+}
+
+void strex::Program::Compiler::visit(const LookaroundNode *node) {
+    program_.has_assertion_ = true;
+    auto index = static_cast<std::uint32_t>(program_.lookarounds_.size());
+    std::uint32_t look = emit(OpCode::Look, 0, index);
+    program_.lookarounds_.push_back({look, node->is_lookbehind(), node->is_negative()});
+    tasks_.push_back({TaskType::Close_Lookaround, node, index, no_chain, look});
+    tasks_.push_back({TaskType::Visit, node->content()});
+}
+
+strex::Program::Program(const ASTNode *ast) {
+    assert(ast != nullptr);
+    Compiler compiler(*this);
+    compiler.compile(ast);
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include <cstdint>
+#include <random>
+
+#include <strex/Cpu.hpp>
+#include <strex/Random.hpp>
+
+strex::BlockEngine::BlockEngine()
+    : BlockEngine(static_cast<std::uint64_t>(std::random_device{}()) << 32 |
+                  std::random_device{}()) {}
+
+strex::BlockEngine::BlockEngine(std::uint64_t seed) {
+    SplitMix64 seeds(seed);
+    for (std::uint64_t &word : state_)
+        word = seeds();
+}
+
+void strex::BlockEngine::refill() {
+    cpu::active().xoshiro_block(state_.data(), block_.data());
+    position_ = 0;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include <strex/Exception.hpp>
+#include <strex/Sink.hpp>
+
+void strex::FdSink::write(std::string_view text) {
+    while (!text.empty()) {
+#if defined(_WIN32)
+        auto size = static_cast<unsigned int>(std::min<std::size_t>(text.size(), INT_MAX));
+        int count = ::_write(fd_, text.data(), size);
+#else
+        ssize_t count = ::write(fd_, text.data(), text.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+#endif
+        if (count < 0)
+            throw GenerateError("failed to write generated string");
+        text.remove_prefix(static_cast<std::size_t>(count));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include <strex/AST.hpp>
+#include <strex/Charset.hpp>
+#include <strex/Cpu.hpp>
+#include <strex/Random.hpp>
+#include <strex/Skeleton.hpp>
+
+auto strex::Skeleton::compile(const ASTNode *ast) -> std::unique_ptr<Skeleton> {
+    assert(ast != nullptr);
+    std::unique_ptr<Skeleton> skeleton(new Skeleton());
+    std::string &bytes = skeleton->template_;
+
+    // Text generated by a group, as a span of the template.
+    struct Capture {
+        std::uint32_t offset{0};
+        std::uint32_t length{0};
+        bool captured{false};
+    };
+    std::vector<Capture> captures;
+    std::map<const Charset *, std::uint32_t> table_indices;
+    // Checks if a span of the template holds random bytes.
+    auto is_random = [&](std::uint32_t offset, std::uint32_t length) {
+        const auto &runs = skeleton->runs_;
+        // The last run that starts at or before `offset`, and the one after it.
+        auto run = std::ranges::upper_bound(runs, offset, {}, &Run::offset);
+        if (run != runs.end() && run->offset < offset + length)
+            return true;
+        if (run != runs.begin() && offset < std::prev(run)->offset + std::prev(run)->length)
+            return true;
+        return std::ranges::any_of(skeleton->copies_, [&](const Copy &copy) {
+            return copy.offset < offset + length && offset < copy.offset + copy.length;
+        });
+    };
+
+    // Nodes are visited from an explicit stack like `Generator`, repetitions are unrolled.
+    enum class TaskType { Visit, Repeat, Close_Group };
+    struct Task {
+        TaskType type;
+        const ASTNode *node;
+        std::uint32_t value{0}; ///< remaining repetitions, or where the text of a group begins
+    };
+    std::vector<Task> tasks{{TaskType::Visit, ast}};
+    while (!tasks.empty()) {
+        if (bytes.size() > max_width)
+            return nullptr;
+        Task task = tasks.back();
+        tasks.pop_back();
+        const ASTNode *node = task.node;
+        auto offset = static_cast<std::uint32_t>(bytes.size());
+
+        if (task.type == TaskType::Repeat) {
+            if (task.value > 1)
+                tasks.push_back({TaskType::Repeat, node, task.value - 1});
+            tasks.push_back({TaskType::Visit, static_cast<const RepeatNode *>(node)->content()});
+            continue;
+        }
+        if (task.type == TaskType::Close_Group) {
+            auto index = static_cast<std::size_t>(static_cast<const GroupNode *>(node)->index());
+            if (index >= captures.size())
+                captures.resize(index + 1);
+            captures[index] = {task.value, offset - task.value, true};
+            continue;
+        }
+
+        if (auto *text = dynamic_cast<const TextNode *>(node)) {
+            bytes.append(text->text());
+        } else if (auto *charset_node = dynamic_cast<const CharsetNode *>(node)) {
+            const Charset *charset = charset_node->charset();
+            if (charset->size() == 0)
+                continue;
+            // A non-ASCII character may be longer than others.
+            if (charset->generated().back().last >= 0x80)
+                return nullptr;
+            if (charset->size() == 1) {
+                bytes.push_back(static_cast<char>(charset->at(0)));
+                continue;
+            }
+            std::string &tables = skeleton->tables_;
+            auto [iter, is_new] =
+                table_indices.try_emplace(charset, static_cast<std::uint32_t>(tables.size()));
+            if (is_new) {
+                for (std::size_t i = 0; i < charset->size(); i++)
+                    tables.push_back(static_cast<char>(charset->at(i)));
+            }
+            auto &runs = skeleton->runs_;
+            // A copy takes bytes, so a slot right after a run has no copy between them.
+            if (!runs.empty() && runs.back().offset + runs.back().length == offset &&
+                runs.back().table == iter->second &&
+                runs.back().length < BlockEngine::block_words) {
+                runs.back().length++;
+            } else {
+                runs.push_back(
+                    {offset, 1, iter->second, static_cast<std::uint32_t>(charset->size())});
+            }
+            skeleton->slot_count_++;
+            bytes.push_back(tables[iter->second]);
+        } else if (auto *sequence = dynamic_cast<const SequenceNode *>(node)) {
+            for (const auto &element : sequence->sequence() | std::views::reverse)
+                tasks.push_back({TaskType::Visit, element.get()});
+        } else if (auto *repeat = dynamic_cast<const RepeatNode *>(node)) {
+            if (repeat->repeat_lower() != repeat->repeat_upper())
+                return nullptr;
+            if (repeat->repeat_upper() > 0)
+                tasks.push_back(
+                    {TaskType::Repeat, node, static_cast<std::uint32_t>(repeat->repeat_upper())});
+        } else if (auto *group = dynamic_cast<const GroupNode *>(node)) {
+            if (group->is_referenced())
+                tasks.push_back({TaskType::Close_Group, node, offset});
+            tasks.push_back({TaskType::Visit, group->content()});
+        } else if (auto *alternation = dynamic_cast<const AlternationNode *>(node)) {
+            if (alternation->elements().size() > 1)
+                return nullptr;
+            if (!alternation->elements().empty())
+                tasks.push_back({TaskType::Visit, alternation->elements()[0].get()});
+        } else if (auto *backref = dynamic_cast<const BackrefNode *>(node)) {
+            auto index = static_cast<std::size_t>(backref->group()->index());
+            // for regex like `(abc)|\1`
+            if (index >= captures.size() || !captures[index].captured)
+                continue;
+            auto [source, length, _] = captures[index];
+            // A literal capture is copied into the template now, others when generating.
+            if (is_random(source, length)) {
+                skeleton->copies_.push_back(
+                    {offset, source, length, static_cast<std::uint32_t>(skeleton->runs_.size())});
+            }
+            bytes.append(bytes, source, length);
+        } else if (dynamic_cast<const LookaroundNode *>(node) != nullptr) {
+            return nullptr;
+        }
+        // Anchors at the edges of a pattern always hold, like in `Generator`.
+    }
+    if (bytes.size() > max_width)
+        return nullptr;
+    return skeleton;
+}
+
+void strex::Skeleton::fill(char *out, std::size_t count, std::size_t stride) {
+    assert(stride >= width());
+    // Stores through `char *` may alias members, so the loop only reads locals.
+    const char *skeleton = template_.data();
+    std::size_t width = template_.size();
+    const Run *runs = runs_.data();
+    std::size_t run_count = runs_.size();
+    const Copy *copies = copies_.data();
+    std::size_t copy_count = copies_.size();
+    const char *tables = tables_.data();
+    auto charset_run = cpu::active().charset_run;
+
+    auto fill_run = [&](char *string, const Run &run) {
+        const std::uint32_t *words = engine_.take(run.length);
+        char *bytes = string + run.offset;
+        const char *table = tables + run.table;
+        if (charset_run(bytes, words, run.length, table, run.size))
+            return;
+        // Rare, a biased byte is drawn again. Words are copied, as drawing may refill the block.
+        std::array<std::uint32_t, BlockEngine::block_words> kept;
+        std::copy_n(words, run.length, kept.begin());
+        for (std::uint32_t i = 0; i < run.length; i++) {
+            std::uint32_t index = reduce(kept[i], run.size);
+            while (index == run.size)
+                index = reduce(engine_(), run.size);
+            bytes[i] = table[index];
+        }
+    };
+
+    for (std::size_t i = 0; i < count; i++) {
+        char *string = out + i * stride;
+        std::memcpy(string, skeleton, width);
+        if (copy_count == 0) {
+            for (std::size_t run = 0; run < run_count; run++)
+                fill_run(string, runs[run]);
+            continue;
+        }
+        std::size_t copy = 0;
+        for (std::size_t run = 0; run <= run_count; run++) {
+            for (; copy < copy_count && copies[copy].runs == run; copy++)
+                std::memcpy(string + copies[copy].offset, string + copies[copy].source,
+                            copies[copy].length);
+            if (run < run_count)
+                fill_run(string, runs[run]);
+        }
+    }
+    random_draws_ += count * slot_count_;
+}
+
+std::string strex::Skeleton::generate() {
+    std::string string(width(), '\0');
+    fill(string.data(), 1, width());
+    return string;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <strex/Stats.hpp>
+
+using strex::stats::LatencyHistogram;
+
+// `sub_buckets` must be a power of two, `sub_bucket_bits` is its logarithm.
+static_assert(std::has_single_bit(LatencyHistogram::sub_buckets));
+constexpr static int sub_bucket_bits = std::countr_zero(LatencyHistogram::sub_buckets);
+
+static std::atomic<bool> enabled{false};
+
+// Counters of current thread. It is constant-initialized, so counting an allocation never
+// allocates.
+static thread_local strex::stats::Counters local_counters;
+
+static std::mutex total_mutex;
+static strex::stats::Counters total_counters;
+
+void strex::stats::LatencyHistogram::record(std::uint64_t nanoseconds) {
+    buckets_[bucket_index(nanoseconds)]++;
+    count_++;
+}
+
+void strex::stats::LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (std::size_t i = 0; i < bucket_count; i++)
+        buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+}
+
+std::uint64_t strex::stats::LatencyHistogram::percentile(double percentile) const {
+    if (count_ == 0)
+        return 0;
+    auto rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * count_));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; i++) {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return bucket_upper_bound(i);
+    }
+    return bucket_upper_bound(bucket_count - 1);
+}
+
+std::size_t strex::stats::LatencyHistogram::bucket_index(std::uint64_t nanoseconds) {
+    if (nanoseconds < sub_buckets)
+        return nanoseconds;
+    // The highest `sub_bucket_bits + 1` bits select the bucket.
+    int exponent = std::bit_width(nanoseconds) - 1;
+    std::uint64_t sub_bucket = (nanoseconds >> (exponent - sub_bucket_bits)) - sub_buckets;
+    return (exponent - sub_bucket_bits + 1) * sub_buckets + sub_bucket;
+}
+
+std::uint64_t strex::stats::LatencyHistogram::bucket_upper_bound(std::size_t index) {
+    if (index < sub_buckets)
+        return index;
+    int exponent = static_cast<int>(index / sub_buckets) + sub_bucket_bits - 1;
+    std::uint64_t sub_bucket = index % sub_buckets;
+    int shift = exponent - sub_bucket_bits;
+    return ((sub_buckets + sub_bucket) << shift) + ((std::uint64_t{1} << shift) - 1);
+}
+
+void strex::stats::Counters::merge(const Counters &other) {
+    lex_ns += other.lex_ns;
+    parse_ns += other.parse_ns;
+    generate_ns += other.generate_ns;
+    output_ns += other.output_ns;
+    strings += other.strings;
+    bytes_emitted += other.bytes_emitted;
+    random_draws += other.random_draws;
+    allocations += other.allocations;
+    latency.merge(other.latency);
+}
+
+void strex::stats::enable(bool is_enabled) {
+    enabled.store(is_enabled, std::memory_order_relaxed);
+}
+
+bool strex::stats::is_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+auto strex::stats::local() -> Counters & {
+    return local_counters;
+}
+
+void strex::stats::flush() {
+    {
+        std::lock_guard lock(total_mutex);
+        total_counters.merge(local_counters);
+    }
+    local_counters = Counters{};
+}
+
+auto strex::stats::collect() -> Counters {
+    std::lock_guard lock(total_mutex);
+    return total_counters;
+}
+
+void strex::stats::count_allocation() noexcept {
+    local_counters.allocations++;
+}
+
+strex::stats::PhaseTimer::PhaseTimer(std::uint64_t Counters::*phase)
+    : phase_(phase), is_enabled_(is_enabled()) {
+    if (is_enabled_)
+        start_ = std::chrono::steady_clock::now();
+}
+
+strex::stats::PhaseTimer::~PhaseTimer() {
+    if (is_enabled_)
+        local_counters.*phase_ += elapsed();
+}
+
+std::uint64_t strex::stats::PhaseTimer::elapsed() const {
+    if (!is_enabled_)
+        return 0;
+    auto duration = std::chrono::steady_clock::now() - start_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
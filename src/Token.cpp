@@ -1,16 +1,26 @@
 #include <cassert>
+#include <cstdint>
 
 #include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
 
-auto strex::Token::create_character(char ch, const TextRange &range) -> Token {
-    return {ch, TokenType::Character, range};
+auto strex::Token::create_character(char32_t code_point, const TextRange &range) -> Token {
+    Token token{static_cast<char>(code_point), TokenType::Character, range};
+    token.value_ = static_cast<std::int32_t>(code_point);
+    return token;
 }
 
 auto strex::Token::create_char_class(char ch, const TextRange &range) -> Token {
     return {ch, TokenType::Char_Class, range};
 }
 
+auto strex::Token::create_property(std::uint32_t categories, bool is_inclusive,
+                                   const TextRange &range) -> Token {
+    Token token{is_inclusive ? 'p' : 'P', TokenType::Char_Class, range};
+    token.value_ = static_cast<std::int32_t>(categories);
+    return token;
+}
+
 auto strex::Token::create_repeat(int repeat_lower, int repeat_upper, const TextRange &range)
     -> Token {
     return {repeat_lower, repeat_upper, range};
@@ -31,8 +41,8 @@ auto strex::Token::create(TokenType type, const TextRange &range) -> Token {
 
 int strex::Token::repeat_lower() const {
     assert(is(TokenType::Repeat));
-    assert(repeat_lower_ != -1 && "repeat lower -1 should be adjusted to 0 in Lexer");
-    return repeat_lower_;
+    assert(value_ != -1 && "repeat lower -1 should be adjusted to 0 in Lexer");
+    return value_;
 }
 
 int strex::Token::repeat_upper() const {
@@ -42,7 +52,7 @@ int strex::Token::repeat_upper() const {
 
 int strex::Token::group_number() const {
     assert(is(TokenType::Backreference));
-    return group_number_;
+    return value_;
 }
 
 char strex::Token::character() const {
@@ -50,16 +60,36 @@ char strex::Token::character() const {
     return character_;
 }
 
+char32_t strex::Token::code_point() const {
+    assert(is(TokenType::Character));
+    return static_cast<char32_t>(value_);
+}
+
+std::uint32_t strex::Token::categories() const {
+    assert(is(TokenType::Char_Class) && (character_ == 'p' || character_ == 'P'));
+    return static_cast<std::uint32_t>(value_);
+}
+
 strex::Token::Token(char ch, TokenType type, const TextRange &range)
-    : type_(type), range_(range), character_(ch) {}
+    : Token(type, range) {
+    character_ = ch;
+}
 
 strex::Token::Token(int repeat_lower, int repeat_upper, const TextRange &range)
-    : type_(TokenType::Repeat),
-      range_(range),
-      repeat_lower_(repeat_lower),
-      repeat_upper_(repeat_upper) {}
+    : Token(TokenType::Repeat, range) {
+    value_ = repeat_lower;
+    repeat_upper_ = repeat_upper;
+}
 
 strex::Token::Token(int group_number, const TextRange &range)
-    : type_(TokenType::Backreference), range_(range), group_number_(group_number) {}
+    : Token(TokenType::Backreference, range) {
+    value_ = group_number;
+}
 
-strex::Token::Token(TokenType type, const TextRange &range) : type_(type), range_(range) {}
\ No newline at end of file
+strex::Token::Token(TokenType type, const TextRange &range)
+    : start_(static_cast<std::uint32_t>(range.start)),
+      length_(static_cast<std::uint16_t>(range.end - range.start)),
+      type_(type) {
+    assert(range.start <= range.end);
+    assert(range.end - range.start <= max_length && "too long token should be rejected in Lexer");
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <strex/Unicode.hpp>
+
+namespace {
+
+#include "UnicodeTables.inc"
+
+/// Long names of general categories, in the order of `category_names`.
+constexpr std::array<std::string_view, category_names.size()> category_long_names = {
+    "Uppercase_Letter",      "Lowercase_Letter",    "Titlecase_Letter",    "Modifier_Letter",
+    "Other_Letter",          "Nonspacing_Mark",     "Spacing_Mark",        "Enclosing_Mark",
+    "Decimal_Number",        "Letter_Number",       "Other_Number",        "Connector_Punctuation",
+    "Dash_Punctuation",      "Open_Punctuation",    "Close_Punctuation",   "Initial_Punctuation",
+    "Final_Punctuation",     "Other_Punctuation",   "Math_Symbol",         "Currency_Symbol",
+    "Modifier_Symbol",       "Other_Symbol",        "Space_Separator",     "Line_Separator",
+    "Paragraph_Separator",   "Control",             "Format",              "Surrogate",
+    "Private_Use",           "Unassigned",
+};
+
+/// A property that names several general categories.
+struct CategoryGroup {
+    std::string_view name;
+    std::string_view long_name;
+    std::string_view prefix; ///< categories whose name starts with it, all of `categories` if empty
+    std::uint32_t categories{0};
+};
+
+// Returns the mask of a general category by its two-letter name.
+constexpr std::uint32_t category(std::string_view name) {
+    for (std::size_t i = 0; i < category_names.size(); i++) {
+        if (category_names[i] == name)
+            return 1U << i;
+    }
+    return 0;
+}
+
+constexpr std::array<CategoryGroup, 9> category_groups = {{
+    {"L", "Letter", "L"},
+    {"LC", "Cased_Letter", "", category("Lu") | category("Ll") | category("Lt")},
+    {"M", "Mark", "M"},
+    {"N", "Number", "N"},
+    {"P", "Punctuation", "P"},
+    {"S", "Symbol", "S"},
+    {"Z", "Separator", "Z"},
+    {"C", "Other", "C"},
+    {"Any", "Any", "", (1U << category_names.size()) - 1},
+}};
+
+} // namespace
+
+char32_t strex::unicode::decode_utf8(std::string_view text, std::size_t &position) {
+    assert(position < text.size());
+    auto lead = static_cast<unsigned char>(text[position]);
+    if (lead < 0x80) {
+        position++;
+        return lead;
+    }
+
+    std::size_t length;
+    char32_t code_point;
+    char32_t min; // smaller code points of this length are overlong
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        code_point = lead & 0x1F;
+        min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        code_point = lead & 0x0F;
+        min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        code_point = lead & 0x07;
+        min = 0x10000;
+    } else {
+        return invalid_code_point;
+    }
+
+    if (text.size() - position < length)
+        return invalid_code_point;
+    for (std::size_t i = 1; i < length; i++) {
+        auto byte = static_cast<unsigned char>(text[position + i]);
+        if ((byte & 0xC0) != 0x80)
+            return invalid_code_point;
+        code_point = code_point << 6 | (byte & 0x3F);
+    }
+    if (code_point < min || code_point > max_code_point || is_surrogate(code_point))
+        return invalid_code_point;
+    position += length;
+    return code_point;
+}
+
+std::uint32_t strex::unicode::property_categories(std::string_view name) {
+    for (std::string_view prefix : {"gc=", "General_Category="}) {
+        if (name.starts_with(prefix)) {
+            name.remove_prefix(prefix.size());
+            break;
+        }
+    }
+
+    for (std::size_t i = 0; i < category_names.size(); i++) {
+        if (name == category_names[i] || name == category_long_names[i])
+            return 1U << i;
+    }
+    for (const CategoryGroup &group : category_groups) {
+        if (name != group.name && name != group.long_name)
+            continue;
+        if (group.prefix.empty())
+            return group.categories;
+        std::uint32_t categories = 0;
+        for (std::size_t i = 0; i < category_names.size(); i++) {
+            if (category_names[i].starts_with(group.prefix))
+                categories |= 1U << i;
+        }
+        return categories;
+    }
+    return 0;
+}
+
+auto strex::unicode::category_ranges(std::uint32_t categories) -> Ranges {
+    Ranges ranges;
+    for (std::size_t i = 0; i < category_runs.size(); i++) {
+        if ((categories >> (category_runs[i] & 0x1F) & 1) == 0)
+            continue;
+        char32_t first = category_runs[i] >> 5;
+        char32_t last = i + 1 < category_runs.size() ? (category_runs[i + 1] >> 5) - 1
+                                                     : max_code_point;
+        if (!ranges.empty() && ranges.back().last + 1 == first)
+            ranges.back().last = last;
+        else
+            ranges.push_back({first, last});
+    }
+    return ranges;
+}
+
+auto strex::unicode::printable() -> const Ranges & {
+    static const Ranges ranges = category_ranges(
+        ~(category("Cc") | category("Cf") | category("Cs") | category("Co") | category("Cn") |
+          category("Zl") | category("Zp")));
+    return ranges;
+}
+
+void strex::unicode::normalize(Ranges &ranges) {
+    std::ranges::sort(ranges);
+    std::size_t size = 0;
+    for (const CodePointRange &range : ranges) {
+        if (size > 0 && range.first <= ranges[size - 1].last + 1)
+            ranges[size - 1].last = std::max(ranges[size - 1].last, range.last);
+        else
+            ranges[size++] = range;
+    }
+    ranges.resize(size);
+}
+
+auto strex::unicode::complement(const Ranges &ranges) -> Ranges {
+    Ranges result;
+    char32_t next = 0;
+    for (const CodePointRange &range : ranges) {
+        if (range.first > next)
+            result.push_back({next, range.first - 1});
+        next = range.last + 1;
+    }
+    if (next <= max_code_point)
+        result.push_back({next, max_code_point});
+    return intersect(result, {{0, 0xD7FF}, {0xE000, max_code_point}});
+}
+
+auto strex::unicode::intersect(const Ranges &lhs, const Ranges &rhs) -> Ranges {
+    Ranges result;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < lhs.size() && j < rhs.size()) {
+        char32_t first = std::max(lhs[i].first, rhs[j].first);
+        char32_t last = std::min(lhs[i].last, rhs[j].last);
+        if (first <= last)
+            result.push_back({first, last});
+        // The range that ends first can not overlap later ranges of the other side.
+        if (lhs[i].last < rhs[j].last)
+            i++;
+        else
+            j++;
+    }
+    return result;
+}
+
+auto strex::unicode::utf8_sequences(const Ranges &ranges) -> std::vector<Utf8Sequence> {
+    // Ranges are split until the encodings of their ends have the same length, and every byte
+    // but the first varies over all continuation bytes, or only the last bytes differ. Then the
+    // encodings are a product of byte ranges.
+    std::vector<Utf8Sequence> sequences;
+    std::vector<CodePointRange> pending(ranges.rbegin(), ranges.rend());
+    auto split = [&](char32_t first, char32_t middle, char32_t last) {
+        pending.push_back({middle + 1, last});
+        pending.push_back({first, middle});
+    };
+
+    while (!pending.empty()) {
+        auto [first, last] = pending.back();
+        pending.pop_back();
+
+        if (first < 0xE000 && last > 0xD7FF) {
+            if (last >= 0xE000)
+                pending.push_back({0xE000, last});
+            if (first <= 0xD7FF)
+                pending.push_back({first, 0xD7FF});
+            continue;
+        }
+
+        bool is_split = false;
+        for (char32_t max : {0x7FU, 0x7FFU, 0xFFFFU}) {
+            if (first <= max && max < last) {
+                split(first, max, last);
+                is_split = true;
+                break;
+            }
+        }
+        for (int i = 1; i < 4 && !is_split; i++) {
+            char32_t mask = (1U << (6 * i)) - 1;
+            if ((first & ~mask) == (last & ~mask))
+                continue;
+            if ((first & mask) != 0) {
+                split(first, first | mask, last);
+                is_split = true;
+            } else if ((last & mask) != mask) {
+                split(first, (last & ~mask) - 1, last);
+                is_split = true;
+            }
+        }
+        if (is_split)
+            continue;
+
+        char lower[4];
+        char upper[4];
+        std::size_t length = encode_utf8(first, lower);
+        encode_utf8(last, upper);
+        Utf8Sequence sequence;
+        for (std::size_t i = 0; i < length; i++) {
+            sequence.push_back(
+                {static_cast<std::uint8_t>(lower[i]), static_cast<std::uint8_t>(upper[i])});
+        }
+        sequences.push_back(std::move(sequence));
+    }
+    return sequences;
+}
\ No newline at end of file
@@ -1,7 +1,41 @@
+#include <cstddef>
 #include <string>
 
+#include <strex/GenerationOptions.hpp>
 #include <strex/compile_option.hpp>
 
 int strex::compile_option::generate_count = 1;
 
-std::string strex::compile_option::base_regex;
\ No newline at end of file
+std::string strex::compile_option::base_regex;
+
+bool strex::compile_option::print_stats = false;
+
+bool strex::compile_option::print_stats_json = false;
+
+bool strex::compile_option::print_profile = false;
+
+bool strex::compile_option::verify = false;
+
+bool strex::compile_option::secure = false;
+
+std::string strex::compile_option::emit_cpp_name;
+
+bool strex::compile_option::print_cpu_info = false;
+
+bool strex::compile_option::stream = false;
+
+int strex::compile_option::max_repeat = strex::GenerationOptions::default_max_repeat;
+
+std::string strex::compile_option::repeat_distribution = "uniform";
+
+double strex::compile_option::repeat_mean = 1.0;
+
+std::size_t strex::compile_option::max_bytes = 0;
+
+std::string strex::compile_option::budget_policy = "truncate";
+
+std::string strex::compile_option::output_path;
+
+int strex::compile_option::jobs = 1;
+
+bool strex::compile_option::ordered = false;
\ No newline at end of file
@@ -1,14 +1,156 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <print>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include <strex/Cpu.hpp>
 #include <strex/Exception.hpp>
+#include <strex/FileOutput.hpp>
+#include <strex/GenerationOptions.hpp>
+#include <strex/OutputWriter.hpp>
+#include <strex/Pipeline.hpp>
+#include <strex/Profile.hpp>
+#include <strex/Sink.hpp>
+#include <strex/Stats.hpp>
 #include <strex/compile_option.hpp>
 #include <strex/strex.hpp>
 
 #include <argparse/argparse.hpp>
 
+// Allocations are counted only if the allocation hook is linked.
+#ifdef STREX_COUNT_ALLOCATIONS
+constexpr bool counts_allocations = true;
+#else
+constexpr bool counts_allocations = false;
+#endif
+
+static double milliseconds(std::uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+static void print_stats(const strex::stats::Counters &stats) {
+    std::println(stderr, "lex:           {:.3f} ms", milliseconds(stats.lex_ns));
+    std::println(stderr, "parse:         {:.3f} ms", milliseconds(stats.parse_ns));
+    std::println(stderr, "generate:      {:.3f} ms", milliseconds(stats.generate_ns));
+    std::println(stderr, "output:        {:.3f} ms", milliseconds(stats.output_ns));
+    std::println(stderr, "strings:       {}", stats.strings);
+    std::println(stderr, "bytes emitted: {}", stats.bytes_emitted);
+    std::println(stderr, "random draws:  {}", stats.random_draws);
+    if (counts_allocations)
+        std::println(stderr, "allocations:   {}", stats.allocations);
+    else
+        std::println(stderr, "allocations:   not counted, build with ENABLE_ALLOCATION_STATS");
+    std::println(stderr, "latency:       p50 {} ns, p99 {} ns, p999 {} ns",
+                 stats.latency.percentile(50), stats.latency.percentile(99),
+                 stats.latency.percentile(99.9));
+}
+
+static void print_stats_json(const strex::stats::Counters &stats) {
+    std::println(stderr,
+                 "{{\"lex_ns\": {}, \"parse_ns\": {}, \"generate_ns\": {}, \"output_ns\": {}, "
+                 "\"strings\": {}, \"bytes_emitted\": {}, \"random_draws\": {}, "
+                 "\"allocations\": {}, "
+                 "\"latency_ns\": {{\"p50\": {}, \"p99\": {}, \"p999\": {}}}}}",
+                 stats.lex_ns, stats.parse_ns, stats.generate_ns, stats.output_ns, stats.strings,
+                 stats.bytes_emitted, stats.random_draws,
+                 counts_allocations ? std::to_string(stats.allocations) : "null",
+                 stats.latency.percentile(50), stats.latency.percentile(99),
+                 stats.latency.percentile(99.9));
+}
+
+// Prints the statistics collected so far, as `--stats` and `--stats-json` ask.
+static void report_stats() {
+    strex::stats::flush();
+    auto stats = strex::stats::collect();
+    if (strex::compile_option::print_stats)
+        print_stats(stats);
+    if (strex::compile_option::print_stats_json)
+        print_stats_json(stats);
+}
+
+// Prints the heat map under the pattern, then the nodes that take the most time.
+static void print_profile(const strex::Profile &profile, std::string_view regex) {
+    constexpr std::size_t max_printed_nodes = 10;
+    constexpr std::size_t max_text_width = 40;
+
+    std::println(stderr, "{}", regex);
+    std::println(stderr, "{}", profile.heat_map(regex));
+
+    std::vector<const strex::Profile::Node *> nodes;
+    for (const auto &node : profile.nodes())
+        nodes.push_back(&node);
+    std::ranges::stable_sort(nodes, std::ranges::greater{},
+                             [](const strex::Profile::Node *node) { return node->self_ns; });
+    nodes.resize(std::min(nodes.size(), max_printed_nodes));
+
+    double total = static_cast<double>(std::max<std::uint64_t>(profile.total_ns(), 1));
+    std::println(stderr, "{:>7} {:>12} {:>12} {:>6}  {}", "range", "visits", "bytes", "time",
+                 "node");
+    for (const auto *node : nodes) {
+        auto text = regex.substr(node->range.start, node->range.end - node->range.start);
+        if (text.size() > max_text_width)
+            text = text.substr(0, max_text_width);
+        std::println(stderr, "{:>3}-{:<3} {:>12} {:>12} {:>5.1f}%  {}", node->range.start,
+                     node->range.end, node->visits, node->bytes,
+                     static_cast<double>(node->self_ns) / total * 100.0, text);
+    }
+}
+
+// Prints the levels compiled in, the level of the CPU, and the variant of the kernels in use.
+static void print_cpu_info() {
+    using strex::cpu::Level;
+    std::string compiled;
+    for (Level level : {Level::Scalar, Level::SSE2, Level::AVX2, Level::AVX512}) {
+        if (strex::cpu::kernels(level).level == level)
+            compiled.append(compiled.empty() ? "" : " ").append(strex::cpu::name(level));
+    }
+    Level active = strex::cpu::active().level;
+    std::println("compiled:        {}", compiled);
+    std::println("detected:        {}", strex::cpu::name(strex::cpu::detect()));
+    // A level asked for in `STREX_CPU` that is not compiled falls back to the nearest one.
+    if (const char *value = std::getenv("STREX_CPU")) {
+        auto requested = strex::cpu::parse_level(value);
+        if (requested && *requested < active)
+            std::println("requested:       {}, not compiled", strex::cpu::name(*requested));
+    }
+    // Every kernel has a variant for every compiled level.
+    std::println("xoshiro blocks:  {}", strex::cpu::name(active));
+    std::println("chacha20 blocks: {}", strex::cpu::name(active));
+    std::println("charset runs:    {}", strex::cpu::name(active));
+}
+
+// Generates the strings on `--jobs` threads, which pass blocks of `batch_size` strings to the
+// calling thread to write to `sink`.
+static void generate_parallel(const strex::GenerationOptions &options, strex::Sink &sink) {
+    constexpr std::size_t batch_size = 1024;
+    auto jobs = static_cast<std::size_t>(strex::compile_option::jobs);
+    auto count = static_cast<std::size_t>(strex::compile_option::generate_count);
+    // Generators are kept in a `ParsedRegex`, so every thread gets its own.
+    std::vector<std::unique_ptr<strex::ParsedRegex>> regexes;
+    for (std::size_t i = 0; i < jobs; i++)
+        regexes.push_back(
+            std::make_unique<strex::ParsedRegex>(strex::compile_option::base_regex, options));
+
+    strex::Pipeline pipeline({.workers = jobs, .ordered = strex::compile_option::ordered});
+    pipeline.run(
+        [&](std::size_t worker, strex::Pipeline::Block &block) {
+            std::size_t first = block.index * batch_size;
+            if (first >= count)
+                return false;
+            strex::from_regex(*regexes[worker], std::min(batch_size, count - first), block.data);
+            return true;
+        },
+        sink);
+}
+
 int main(int argc, char *argv[]) {
     if (argc == 1) {
         std::string regex_string;
@@ -32,8 +174,7 @@ int main(int argc, char *argv[]) {
     program.add_argument("-r", "--regex")
         .help("regular expression that used to generate string")
         .metavar("<str>")
-        .store_into(strex::compile_option::base_regex)
-        .required();
+        .store_into(strex::compile_option::base_regex);
 
     program.add_argument("-n", "--number")
         .help("number of string to be generated")
@@ -43,13 +184,216 @@ int main(int argc, char *argv[]) {
         .store_into(strex::compile_option::generate_count)
         .metavar("<integer>");
 
+    program.add_argument("--stats")
+        .help("print time of each phase, counters and latency percentiles to stderr")
+        .flag()
+        .store_into(strex::compile_option::print_stats);
+
+    program.add_argument("--stats-json")
+        .help("print statistics to stderr as JSON")
+        .flag()
+        .store_into(strex::compile_option::print_stats_json);
+
+    program.add_argument("--profile")
+        .help("print where generation spends time in the regex to stderr")
+        .flag()
+        .store_into(strex::compile_option::print_profile);
+
+    program.add_argument("--verify")
+        .help("check that every generated string matches the regex, exit with 2 if not")
+        .flag()
+        .store_into(strex::compile_option::verify);
+
+    program.add_argument("--secure")
+        .help("draw choices from ChaCha20 seeded by the OS, for keys and passwords")
+        .flag()
+        .store_into(strex::compile_option::secure);
+
+    program.add_argument("--emit-cpp")
+        .help("print a C++ header with a generator function of the given name instead of strings")
+        .metavar("<name>")
+        .store_into(strex::compile_option::emit_cpp_name);
+
+    program.add_argument("--stream")
+        .help("write each string in chunks as it is generated, for strings too large for memory")
+        .flag()
+        .store_into(strex::compile_option::stream);
+
+    program.add_argument("--max-repeat")
+        .help("most repetitions of * and +, and above the lower bound of {n,}")
+        .default_value(strex::GenerationOptions::default_max_repeat)
+        .nargs(1)
+        .scan<'i', int>()
+        .store_into(strex::compile_option::max_repeat)
+        .metavar("<integer>");
+
+    program.add_argument("--repeat-distribution")
+        .help("distribution of repetition counts, uniform or geometric")
+        .default_value(std::string{"uniform"})
+        .choices("uniform", "geometric")
+        .store_into(strex::compile_option::repeat_distribution)
+        .metavar("<name>");
+
+    program.add_argument("--repeat-mean")
+        .help("mean repetitions above the lower bound with the geometric distribution")
+        .default_value(1.0)
+        .nargs(1)
+        .scan<'g', double>()
+        .store_into(strex::compile_option::repeat_mean)
+        .metavar("<number>");
+
+    program.add_argument("--max-bytes")
+        .help("most bytes of a string, 0 for no limit")
+        .default_value(std::size_t{0})
+        .nargs(1)
+        .scan<'u', std::size_t>()
+        .store_into(strex::compile_option::max_bytes)
+        .metavar("<integer>");
+
+    program.add_argument("--on-budget")
+        .help("what to do with a string over --max-bytes: truncate, shortest or error")
+        .default_value(std::string{"truncate"})
+        .choices("truncate", "shortest", "error")
+        .store_into(strex::compile_option::budget_policy)
+        .metavar("<policy>");
+
+    program.add_argument("-o", "--output")
+        .help("write strings to a file instead of stdout, generated by --jobs threads")
+        .metavar("<file>")
+        .store_into(strex::compile_option::output_path);
+
+    program.add_argument("-j", "--jobs")
+        .help("number of threads that generate strings, into --output or through one writer")
+        .default_value(1)
+        .nargs(1)
+        .scan<'i', int>()
+        .store_into(strex::compile_option::jobs)
+        .metavar("<integer>");
+
+    program.add_argument("--ordered")
+        .help("with --jobs, write strings in the order of their blocks instead of when ready")
+        .flag()
+        .store_into(strex::compile_option::ordered);
+
+    program.add_argument("--cpu-info")
+        .help("print the instruction sets of the CPU and the kernels in use, then exit")
+        .flag()
+        .store_into(strex::compile_option::print_cpu_info);
+
     try {
         program.parse_args(argc, argv);
 
-        strex::ParsedRegex regex(strex::compile_option::base_regex);
-        while (strex::compile_option::generate_count--) {
-            std::println("{}", strex::from_regex(regex));
+        if (strex::compile_option::print_cpu_info) {
+            print_cpu_info();
+            return 0;
+        }
+        // `--regex` is required unless `--cpu-info` is given.
+        if (!program.is_used("--regex")) {
+            std::println("--regex is required");
+            return 1;
+        }
+
+        bool collects_stats =
+            strex::compile_option::print_stats || strex::compile_option::print_stats_json;
+        strex::stats::enable(collects_stats);
+
+        if (strex::compile_option::secure && strex::compile_option::print_profile) {
+            std::println("--secure cannot be used with --profile");
+            return 1;
         }
+        if (strex::compile_option::stream &&
+            (strex::compile_option::secure || strex::compile_option::print_profile ||
+             strex::compile_option::verify)) {
+            std::println("--stream cannot be used with --secure, --profile or --verify");
+            return 1;
+        }
+        bool writes_file = !strex::compile_option::output_path.empty();
+        if (writes_file &&
+            (strex::compile_option::stream || strex::compile_option::secure ||
+             strex::compile_option::print_profile || strex::compile_option::verify)) {
+            std::println("--output cannot be used with --stream, --secure, --profile or --verify");
+            return 1;
+        }
+        if (strex::compile_option::jobs < 1) {
+            std::println("--jobs must be at least 1");
+            return 1;
+        }
+        if (strex::compile_option::jobs > 1 &&
+            (strex::compile_option::stream || strex::compile_option::secure ||
+             strex::compile_option::print_profile || strex::compile_option::verify)) {
+            std::println("--jobs cannot be used with --stream, --secure, --profile or --verify");
+            return 1;
+        }
+
+        strex::GenerationOptions options;
+        options.max_repeat = strex::compile_option::max_repeat;
+        options.repeat_distribution =
+            strex::parse_repeat_distribution(strex::compile_option::repeat_distribution);
+        options.repeat_mean = strex::compile_option::repeat_mean;
+        options.max_bytes = strex::compile_option::max_bytes;
+        options.budget_policy = strex::parse_budget_policy(strex::compile_option::budget_policy);
+
+        strex::ParsedRegex regex(strex::compile_option::base_regex, options);
+        if (!strex::compile_option::emit_cpp_name.empty()) {
+            std::print("{}", strex::emit_cpp(regex, strex::compile_option::emit_cpp_name,
+                                             strex::compile_option::base_regex));
+            return 0;
+        }
+        if (writes_file) {
+            strex::generate_to_file(
+                strex::compile_option::base_regex, options, strex::compile_option::output_path,
+                static_cast<std::size_t>(strex::compile_option::generate_count),
+                static_cast<unsigned>(strex::compile_option::jobs));
+            if (collects_stats)
+                report_stats();
+            return 0;
+        }
+        // Strings go to the descriptor of stdout past the buffer of `stdout`.
+        std::fflush(stdout);
+        strex::OutputWriter output(1);
+        if (strex::compile_option::stream) {
+            for (; strex::compile_option::generate_count > 0;
+                 strex::compile_option::generate_count--) {
+                strex::from_regex(regex, output);
+                output.write("\n");
+            }
+        }
+        if (strex::compile_option::jobs > 1) {
+            generate_parallel(options, output);
+            strex::compile_option::generate_count = 0;
+        }
+        strex::Profile profile(regex);
+        // Strings are generated in batches unless they are profiled one by one.
+        constexpr std::size_t batch_size = 1024;
+        std::vector<std::string> batch;
+        while (strex::compile_option::generate_count > 0) {
+            auto count = static_cast<std::size_t>(strex::compile_option::generate_count);
+            if (strex::compile_option::print_profile)
+                batch.assign(1, strex::from_regex(regex, profile));
+            else if (strex::compile_option::secure)
+                batch = strex::from_regex_secure(regex, std::min(count, batch_size));
+            else
+                batch = strex::from_regex(regex, std::min(count, batch_size));
+            strex::compile_option::generate_count -= static_cast<int>(batch.size());
+
+            for (const std::string &generated : batch) {
+                if (strex::compile_option::verify && !strex::matches(regex, generated)) {
+                    std::println(stderr, "generated string does not match the regex: \"{}\"",
+                                 generated);
+                    return 2;
+                }
+                strex::stats::PhaseTimer timer(&strex::stats::Counters::output_ns);
+                output.write(generated);
+                output.write("\n");
+            }
+        }
+        output.flush();
+
+        if (strex::compile_option::print_profile)
+            print_profile(profile, strex::compile_option::base_regex);
+
+        if (collects_stats)
+            report_stats();
     }
     catch (strex::LexicalError &e) {
         std::println("{}", e.what());
@@ -1,19 +1,172 @@
-#include <print>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <strex/AST.hpp>
+#include <strex/Automaton.hpp>
+#include <strex/BatchGenerator.hpp>
+#include <strex/CppEmitter.hpp>
 #include <strex/Exception.hpp>
+#include <strex/GenerationOptions.hpp>
 #include <strex/Generator.hpp>
 #include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Optimizer.hpp>
 #include <strex/Parser.hpp>
+#include <strex/Profile.hpp>
+#include <strex/Sink.hpp>
+#include <strex/Skeleton.hpp>
+#include <strex/Stats.hpp>
+#include <strex/Token.hpp>
 #include <strex/strex.hpp>
 
-strex::ParsedRegex::ParsedRegex(std::string_view regex) {
-    Lexer lexer(std::string{regex});
-    auto tokens = lexer.tokenize();
-    Parser parser(tokens);
-    ast_ = parser.parse();
+// Lexes, parses and optimizes a regex with `passes`, and records time of each phase.
+static std::unique_ptr<strex::ASTNode>
+compile(std::string_view regex, int max_repeat,
+        const strex::PassManager &passes = strex::PassManager::default_pipeline()) {
+    using strex::stats::Counters;
+    std::vector<strex::Token> tokens;
+    {
+        strex::stats::PhaseTimer timer(&Counters::lex_ns);
+        strex::Lexer lexer(std::string{regex});
+        tokens = lexer.tokenize();
+    }
+    strex::stats::PhaseTimer timer(&Counters::parse_ns);
+    strex::Parser parser(tokens, max_repeat);
+    auto ast = parser.parse();
+    passes.run(ast);
+    return ast;
+}
+
+// Checks if the AST has lookarounds or anchors inside, which only `Automaton` generates.
+// `Generator` skips anchors, which is right for `^` that leads and `$` that ends the regex.
+static bool needs_automaton(const strex::ASTNode *ast) {
+    auto is_anchor = [](const strex::ASTNode *node, strex::AnchorNode::Type type) {
+        auto *anchor = dynamic_cast<const strex::AnchorNode *>(node);
+        return anchor != nullptr && anchor->type() == type;
+    };
+    std::vector<const strex::ASTNode *> pending;
+    if (auto *sequence = dynamic_cast<const strex::SequenceNode *>(ast)) {
+        const auto &elements = sequence->sequence();
+        std::size_t begin = 0;
+        std::size_t end = elements.size();
+        while (begin < end && is_anchor(elements[begin].get(), strex::AnchorNode::Type::Begin))
+            begin++;
+        while (end > begin && is_anchor(elements[end - 1].get(), strex::AnchorNode::Type::End))
+            end--;
+        for (std::size_t i = begin; i < end; i++)
+            pending.push_back(elements[i].get());
+    } else if (dynamic_cast<const strex::AnchorNode *>(ast) == nullptr) {
+        pending.push_back(ast);
+    }
+
+    while (!pending.empty()) {
+        const strex::ASTNode *node = pending.back();
+        pending.pop_back();
+        if (dynamic_cast<const strex::LookaroundNode *>(node) != nullptr ||
+            dynamic_cast<const strex::AnchorNode *>(node) != nullptr)
+            return true;
+        if (auto *sequence = dynamic_cast<const strex::SequenceNode *>(node)) {
+            for (const auto &element : sequence->sequence())
+                pending.push_back(element.get());
+        } else if (auto *alternation = dynamic_cast<const strex::AlternationNode *>(node)) {
+            for (const auto &element : alternation->elements())
+                pending.push_back(element.get());
+        } else if (auto *repeat = dynamic_cast<const strex::RepeatNode *>(node)) {
+            pending.push_back(repeat->content());
+        } else if (auto *group = dynamic_cast<const strex::GroupNode *>(node)) {
+            pending.push_back(group->content());
+        }
+    }
+    return false;
+}
+
+// Returns `options` if they are valid, so they are checked before the regex is compiled.
+static const strex::GenerationOptions &validated(const strex::GenerationOptions &options) {
+    options.validate();
+    return options;
+}
+
+// Returns the byte budget of `options` for `Automaton::generate`.
+static std::size_t max_bytes(const strex::GenerationOptions &options) {
+    return options.max_bytes > 0 ? options.max_bytes : std::numeric_limits<std::size_t>::max();
+}
+
+// Generates a string with the automaton, and records its time, size and random draws.
+static std::string generate(const strex::Automaton *automaton,
+                            const strex::GenerationOptions &options) {
+    using strex::stats::Counters;
+    strex::stats::PhaseTimer timer(&Counters::generate_ns);
+    std::uint64_t random_draws = 0;
+    thread_local strex::BlockEngine engine;
+    std::string generated = automaton->generate(engine, random_draws, max_bytes(options));
+    if (strex::stats::is_enabled()) {
+        Counters &counters = strex::stats::local();
+        counters.strings++;
+        counters.bytes_emitted += generated.size();
+        counters.random_draws += random_draws;
+        counters.latency.record(timer.elapsed());
+    }
+    return generated;
+}
+
+// Returns the generator kept in `regex` for strings with its options, built on first use.
+static strex::Generator &kept_generator(std::unique_ptr<strex::Generator> &generator,
+                                        const strex::ASTNode *ast,
+                                        const strex::GenerationOptions &options) {
+    if (generator == nullptr)
+        generator = std::make_unique<strex::Generator>(ast, options);
+    return *generator;
+}
+
+// Generates a string with `generator`, and records its time, size and random draws.
+static std::string generate(strex::Generator &generator) {
+    using strex::stats::Counters;
+    strex::stats::PhaseTimer timer(&Counters::generate_ns);
+    std::uint64_t random_draws = generator.random_draws();
+    std::string generated = generator.generate();
+    if (strex::stats::is_enabled()) {
+        Counters &counters = strex::stats::local();
+        counters.strings++;
+        counters.bytes_emitted += generated.size();
+        counters.random_draws += generator.random_draws() - random_draws;
+        counters.latency.record(timer.elapsed());
+    }
+    return generated;
+}
+
+// Generates `count` strings one by one, and records their time, size and random draws.
+static std::vector<std::string> generate_each(strex::Generator &generator, std::size_t count) {
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    while (strings.size() < count)
+        strings.push_back(generate(generator));
+    return strings;
+}
+
+strex::ParsedRegex::ParsedRegex(std::string_view regex)
+    : ParsedRegex(regex, GenerationOptions{}) {}
+
+strex::ParsedRegex::ParsedRegex(std::string_view regex, const GenerationOptions &options)
+    : source_(regex), options_(validated(options)), ast_(compile(regex, options.max_repeat)) {
+    if (needs_automaton(ast_.get())) {
+        if (options.repeat_distribution != RepeatDistribution::Uniform)
+            throw SyntaxNotSupport(
+                "lookarounds and inner anchors only support uniform repetitions");
+        automaton_ = std::make_unique<Automaton>(ast_.get());
+        return;
+    }
+    skeleton_ = Skeleton::compile(ast_.get());
+    // Strings of a skeleton that does not fit are left to the budget policy of `Generator`.
+    if (skeleton_ != nullptr && options.max_bytes > 0 && skeleton_->width() > options.max_bytes)
+        skeleton_.reset();
 }
 
 auto strex::ParsedRegex::ast() const -> const ASTNode * {
@@ -21,18 +174,212 @@ auto strex::ParsedRegex::ast() const -> const ASTNode * {
     return ast_.get();
 }
 
+auto strex::ParsedRegex::matching_ast() const -> std::unique_ptr<ASTNode> {
+    return compile(source_, options_.max_repeat, PassManager::matching_pipeline());
+}
+
 strex::ParsedRegex::~ParsedRegex() {}
 
+auto strex::ParsedRegex::backend() const -> Backend {
+    if (automaton_ != nullptr)
+        return Backend::Automaton;
+    if (skeleton_ != nullptr)
+        return Backend::Skeleton;
+    return options_.is_default_distribution() ? Backend::Batch : Backend::Generator;
+}
+
 std::string strex::from_regex(std::string_view regex) {
-    Lexer lexer(std::string{regex});
-    auto tokens = lexer.tokenize();
-    Parser parser(tokens);
-    auto ast = parser.parse();
-    Generator generator(ast.get());
-    return generator.generate();
+    return from_regex(ParsedRegex(regex));
 }
 
 std::string strex::from_regex(const ParsedRegex &regex) {
-    Generator generator(regex.ast());
+    if (regex.automaton_ != nullptr)
+        return generate(regex.automaton_.get(), regex.options_);
+    return generate(kept_generator(regex.generator_, regex.ast(), regex.options_));
+}
+
+std::string strex::from_regex(const ParsedRegex &regex, Profile &profile) {
+    if (regex.automaton_ != nullptr)
+        throw SyntaxNotSupport("lookarounds and inner anchors cannot be profiled");
+    Generator generator(regex.ast(), regex.options_);
+    generator.set_profile(&profile);
     return generator.generate();
+}
+
+void strex::from_regex(const ParsedRegex &regex, Sink &sink) {
+    if (regex.automaton_ != nullptr) {
+        sink.write(generate(regex.automaton_.get(), regex.options_));
+        return;
+    }
+    using strex::stats::Counters;
+    strex::stats::PhaseTimer timer(&Counters::generate_ns);
+    Generator &generator = kept_generator(regex.generator_, regex.ast(), regex.options_);
+    std::uint64_t random_draws = generator.random_draws();
+    generator.generate(sink);
+    if (strex::stats::is_enabled()) {
+        Counters &counters = strex::stats::local();
+        counters.strings++;
+        counters.bytes_emitted += generator.streamed_bytes();
+        counters.random_draws += generator.random_draws() - random_draws;
+        counters.latency.record(timer.elapsed());
+    }
+}
+
+std::vector<std::string> strex::from_regex(const ParsedRegex &regex, std::size_t count) {
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    if (regex.automaton_ != nullptr) {
+        while (strings.size() < count)
+            strings.push_back(generate(regex.automaton_.get(), regex.options_));
+        return strings;
+    }
+
+    if (regex.skeleton_ != nullptr) {
+        using strex::stats::Counters;
+        strex::stats::PhaseTimer timer(&Counters::generate_ns);
+        // Strings are filled at a fixed stride in one buffer, then split.
+        Skeleton &skeleton = *regex.skeleton_;
+        std::uint64_t random_draws = skeleton.random_draws();
+        std::string buffer(skeleton.width() * count, '\0');
+        skeleton.fill(buffer.data(), count, skeleton.width());
+        for (std::size_t i = 0; i < count; i++)
+            strings.push_back(buffer.substr(i * skeleton.width(), skeleton.width()));
+        if (strex::stats::is_enabled()) {
+            Counters &counters = strex::stats::local();
+            counters.strings += count;
+            counters.bytes_emitted += buffer.size();
+            counters.random_draws += skeleton.random_draws() - random_draws;
+            std::uint64_t latency = timer.elapsed() / std::max<std::size_t>(count, 1);
+            for (std::size_t i = 0; i < count; i++)
+                counters.latency.record(latency);
+        }
+        return strings;
+    }
+
+    if (!regex.options_.is_default_distribution()) {
+        return generate_each(kept_generator(regex.generator_, regex.ast(), regex.options_), count);
+    }
+
+    if (regex.batch_generator_ == nullptr)
+        regex.batch_generator_ = std::make_unique<BatchGenerator>(regex.ast());
+    BatchGenerator &generator = *regex.batch_generator_;
+    while (strings.size() < count) {
+        using strex::stats::Counters;
+        strex::stats::PhaseTimer timer(&Counters::generate_ns);
+        std::uint64_t random_draws = generator.random_draws();
+        const auto &batch = generator.generate();
+        std::size_t taken = std::min(batch.size(), count - strings.size());
+        strings.insert(strings.end(), batch.begin(), batch.begin() + taken);
+        if (!strex::stats::is_enabled())
+            continue;
+        // Strings of a batch are generated together, each takes an equal share of the time.
+        Counters &counters = strex::stats::local();
+        counters.strings += taken;
+        counters.random_draws += generator.random_draws() - random_draws;
+        std::uint64_t latency = timer.elapsed() / batch.size();
+        for (std::size_t i = strings.size() - taken; i < strings.size(); i++) {
+            counters.bytes_emitted += strings[i].size();
+            counters.latency.record(latency);
+        }
+    }
+    return strings;
+}
+
+void strex::from_regex(const ParsedRegex &regex, std::size_t count, std::string &lines) {
+    if (regex.automaton_ != nullptr) {
+        for (std::size_t i = 0; i < count; i++)
+            lines.append(generate(regex.automaton_.get(), regex.options_))
+                .push_back('\n');
+        return;
+    }
+
+    using strex::stats::Counters;
+    if (regex.skeleton_ != nullptr) {
+        strex::stats::PhaseTimer timer(&Counters::generate_ns);
+        // Strings are filled in place one line apart, then the newlines are put between them.
+        Skeleton &skeleton = *regex.skeleton_;
+        std::uint64_t random_draws = skeleton.random_draws();
+        std::size_t stride = skeleton.width() + 1;
+        std::size_t first = lines.size();
+        lines.resize(first + stride * count);
+        skeleton.fill(lines.data() + first, count, stride);
+        for (std::size_t i = 1; i <= count; i++)
+            lines[first + i * stride - 1] = '\n';
+        if (strex::stats::is_enabled()) {
+            Counters &counters = strex::stats::local();
+            counters.strings += count;
+            counters.bytes_emitted += skeleton.width() * count;
+            counters.random_draws += skeleton.random_draws() - random_draws;
+            std::uint64_t latency = timer.elapsed() / std::max<std::size_t>(count, 1);
+            for (std::size_t i = 0; i < count; i++)
+                counters.latency.record(latency);
+        }
+        return;
+    }
+
+    if (!regex.options_.is_default_distribution()) {
+        Generator &generator = kept_generator(regex.generator_, regex.ast(), regex.options_);
+        for (std::size_t i = 0; i < count; i++) {
+            strex::stats::PhaseTimer timer(&Counters::generate_ns);
+            std::uint64_t random_draws = generator.random_draws();
+            std::size_t first = lines.size();
+            generator.generate_into(lines);
+            if (strex::stats::is_enabled()) {
+                Counters &counters = strex::stats::local();
+                counters.strings++;
+                counters.bytes_emitted += lines.size() - first;
+                counters.random_draws += generator.random_draws() - random_draws;
+                counters.latency.record(timer.elapsed());
+            }
+            lines.push_back('\n');
+        }
+        return;
+    }
+
+    if (regex.batch_generator_ == nullptr)
+        regex.batch_generator_ = std::make_unique<BatchGenerator>(regex.ast());
+    BatchGenerator &generator = *regex.batch_generator_;
+    for (std::size_t done = 0; done < count;) {
+        strex::stats::PhaseTimer timer(&Counters::generate_ns);
+        std::uint64_t random_draws = generator.random_draws();
+        const auto &batch = generator.generate();
+        std::size_t taken = std::min(batch.size(), count - done);
+        for (std::size_t i = 0; i < taken; i++)
+            lines.append(batch[i]).push_back('\n');
+        done += taken;
+        if (!strex::stats::is_enabled())
+            continue;
+        Counters &counters = strex::stats::local();
+        counters.strings += taken;
+        counters.random_draws += generator.random_draws() - random_draws;
+        std::uint64_t latency = timer.elapsed() / batch.size();
+        for (std::size_t i = 0; i < taken; i++) {
+            counters.bytes_emitted += batch[i].size();
+            counters.latency.record(latency);
+        }
+    }
+}
+
+std::vector<std::string> strex::from_regex_secure(const ParsedRegex &regex, std::size_t count) {
+    if (regex.automaton_ != nullptr)
+        throw SyntaxNotSupport("lookarounds and inner anchors cannot be generated securely");
+    if (regex.secure_generator_ == nullptr)
+        regex.secure_generator_ = std::make_unique<Generator>(regex.ast(), regex.options_, true);
+    return generate_each(*regex.secure_generator_, count);
+}
+
+bool strex::matches(const ParsedRegex &regex, std::string_view text) {
+    if (regex.matcher_ == nullptr)
+        regex.matcher_ = std::make_unique<Matcher>(regex);
+    return regex.matcher_->matches(text);
+}
+
+std::string strex::emit_cpp(const ParsedRegex &regex, std::string_view name,
+                            std::string_view source) {
+    if (regex.automaton_ != nullptr)
+        throw SyntaxNotSupport("lookarounds and inner anchors cannot be emitted as C++");
+    if (!regex.options_.is_default_distribution())
+        throw SyntaxNotSupport("emitted C++ has uniform repetitions and no byte budget");
+    CppEmitter emitter(regex.ast(), name);
+    return emitter.emit(source);
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/Automaton.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Parser.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+std::unique_ptr<ASTNode> parse(std::string_view regex) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    return parser.parse();
+}
+
+// Checks generated strings with `Matcher`, and the DFA against `Matcher` on all strings over
+// `alphabet` up to `max_length`.
+void check(std::string_view regex, std::string_view alphabet, std::size_t max_length) {
+    auto ast = parse(regex);
+    Automaton automaton(ast.get());
+    Matcher matcher(ast.get());
+    INFO("regex: ", regex);
+
+    BlockEngine engine;
+    std::uint64_t random_draws = 0;
+    for (int i = 0; i < 2000; i++) {
+        auto str = automaton.generate(engine, random_draws);
+        INFO("generated string: \"", str, "\"");
+        REQUIRE(std::ranges::all_of(str, ::isprint));
+        REQUIRE(matcher.matches(str));
+    }
+
+    std::vector<std::string> texts{""};
+    for (std::size_t i = 0; i < texts.size(); i++) {
+        std::string text = texts[i];
+        INFO("text: \"", text, "\"");
+        REQUIRE_EQ(automaton.matches(text), matcher.matches(text));
+        if (text.size() < max_length) {
+            for (char ch : alphabet)
+                texts.push_back(text + ch);
+        }
+    }
+}
+
+TEST_CASE("lookahead") {
+    check(R"((?=.*\d)(?=.*[A-Z])\w{3,5})", "a1B", 5);
+    check("(?!ab)[abc]{1,4}", "abc", 5);
+    check("((?=a)[ab]|(?!a)[bc])+", "abc", 5);
+    check("(?=(?!b)[ab](?=c))[a-c]{2}c?", "abc", 4);
+    check("(?=a*$)[ab]+", "ab", 5);
+}
+
+TEST_CASE("lookbehind") {
+    check("[ab]{2,4}(?<=ab)", "ab", 5);
+    check("([ab](?<!aa))+", "ab", 6);
+    check("((?<=^a*)b|a)+", "ab", 6);
+    check("(?<=^)a(?<=a)b?", "ab", 4);
+}
+
+TEST_CASE("anchor") {
+    check("^a(b|$)", "ab", 3);
+    check("(a|^b)+", "ab", 4);
+}
+
+TEST_CASE("password policy") {
+    ParsedRegex regex(R"(^(?=.*\d)(?=.*[A-Z]).{12}$)");
+    for (int i = 0; i < 1000; i++) {
+        auto password = from_regex(regex);
+        INFO("generated string: \"", password, "\"");
+        CHECK_EQ(password.size(), 12);
+        CHECK(std::ranges::any_of(password, ::isdigit));
+        CHECK(std::ranges::any_of(password, ::isupper));
+        CHECK(strex::matches(regex, password));
+    }
+}
+
+TEST_CASE("all strings are generated") {
+    auto ast = parse("(?=.*a)[ab]{3}");
+    Automaton automaton(ast.get());
+    BlockEngine engine;
+    std::uint64_t random_draws = 0;
+    std::set<std::string> generated;
+    for (int i = 0; i < 1000; i++)
+        generated.insert(automaton.generate(engine, random_draws));
+    CHECK_EQ(generated.size(), 7);
+    CHECK_FALSE(generated.contains("bbb"));
+}
+
+TEST_CASE("impossible lookaround") {
+    auto ast = parse("(?=a)b");
+    Automaton automaton(ast.get());
+    BlockEngine engine;
+    std::uint64_t random_draws = 0;
+    CHECK_THROWS_AS(automaton.generate(engine, random_draws), GenerateError);
+    CHECK_THROWS_AS(from_regex("a$b"), GenerateError);
+}
+
+TEST_CASE("lookaround beyond the repeat ceiling") {
+    constexpr auto regex = R"(^(?=.{8,10}$)(?=.*\d).*$)";
+    // The `.*` outside the lookarounds is capped, so the error tells to raise the ceiling.
+    std::string message;
+    try {
+        from_regex(regex);
+    }
+    catch (GenerateError &e) {
+        message = e.what();
+    }
+    CHECK(message.find("raise max_repeat") != std::string::npos);
+
+    GenerationOptions options;
+    options.max_repeat = 10;
+    ParsedRegex parsed(regex, options);
+    for (int i = 0; i < 20; i++) {
+        auto generated = from_regex(parsed);
+        CHECK(generated.size() >= 8);
+        CHECK(generated.size() <= 10);
+        CHECK(std::ranges::any_of(generated, [](char ch) { return std::isdigit(ch) != 0; }));
+    }
+}
+
+TEST_CASE("unsupported lookaround") {
+    CHECK_THROWS_AS(ParsedRegex(R"((a)\1(?=a))"), SyntaxNotSupport);
+    CHECK_THROWS_AS(ParsedRegex("(?<=a(?=b))b"), SyntaxNotSupport);
+    CHECK_THROWS_AS(ParsedRegex("(?<=a$)"), SyntaxNotSupport);
+}
\ No newline at end of file
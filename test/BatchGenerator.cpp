@@ -0,0 +1,107 @@
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/BatchGenerator.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Parser.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+std::unique_ptr<ASTNode> parse(std::string_view regex) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    return parser.parse();
+}
+
+// Checks all lanes generate strings that match the regex, and returns the distinct strings.
+std::set<std::string> check(std::string_view regex, bool is_fixed_shape) {
+    auto ast = parse(regex);
+    BatchGenerator generator(ast.get());
+    Matcher matcher(ast.get());
+    INFO("regex: ", regex);
+    CHECK_EQ(generator.is_fixed_shape(), is_fixed_shape);
+
+    std::set<std::string> generated;
+    for (int i = 0; i < 20; i++) {
+        for (const std::string &str : generator.generate()) {
+            INFO("generated string: \"", str, "\"");
+            REQUIRE(matcher.matches(str));
+            generated.insert(str);
+        }
+    }
+    return generated;
+}
+
+TEST_CASE("fixed shape") {
+    CHECK_EQ(check("[0-9a-f]{8}-[0-9a-f]{4}", true).size(), 20 * BatchGenerator::lanes);
+    CHECK_EQ(check("abc", true).size(), 1);
+    CHECK_EQ(check("(x[ab]{2})-\\1", true).size(), 4);
+    CHECK_EQ(check("a{0}b(c)?", false).size(), 2);
+}
+
+TEST_CASE("divergent lanes") {
+    // Every alternative and every number of repetitions is taken by some lane.
+    CHECK(check("a|b|cd", false) == std::set<std::string>{"a", "b", "cd"});
+    CHECK(check("(x|yz){0,2}", false) ==
+          std::set<std::string>{"", "x", "yz", "xx", "xyz", "yzx", "yzyz"});
+    check("(([ab]+)|c)\\2\\1", false);
+    check("((a|b)c(d|e){1,3})+\\1", false);
+}
+
+TEST_CASE("unicode lanes") {
+    CHECK_FALSE(check("[α-ω]{3}", false).empty());
+    check("\\p{Lu}é|[😀-😃]", false);
+}
+
+TEST_CASE("bulk from_regex") {
+    ParsedRegex regex("(ab|cd){2,4}[0-9]");
+    CHECK(regex.backend() == ParsedRegex::Backend::Batch);
+    auto strings = from_regex(regex, 1000);
+    CHECK_EQ(strings.size(), 1000);
+    for (const std::string &str : strings)
+        CHECK(matches(regex, str));
+
+    // Lookarounds fall back to the automaton.
+    ParsedRegex lookahead("(?=.*1)[01]{4}");
+    CHECK(lookahead.backend() == ParsedRegex::Backend::Automaton);
+    CHECK(ParsedRegex("[a-f]{4}").backend() == ParsedRegex::Backend::Skeleton);
+    GenerationOptions geometric;
+    geometric.repeat_distribution = RepeatDistribution::Geometric;
+    CHECK(ParsedRegex("a{1,5}", geometric).backend() == ParsedRegex::Backend::Generator);
+    for (const std::string &str : from_regex(lookahead, 100))
+        CHECK(matches(lookahead, str));
+}
+
+TEST_CASE("bulk from_regex into lines") {
+    GenerationOptions geometric;
+    geometric.repeat_distribution = RepeatDistribution::Geometric;
+    ParsedRegex batch("(ab|cd){2,4}[0-9]");
+    ParsedRegex skeleton("[A-Z]{2}-\\d{4}");
+    ParsedRegex one_by_one("(ab|cd){2,4}[0-9]", geometric);
+    ParsedRegex lookahead("(?=.*1)[01]{4}");
+    for (const ParsedRegex *regex : {&batch, &skeleton, &one_by_one, &lookahead}) {
+        // Lines are appended after what the buffer has.
+        std::string lines = "kept\n";
+        from_regex(*regex, 100, lines);
+        from_regex(*regex, 0, lines);
+        REQUIRE(lines.ends_with('\n'));
+        std::string_view rest(lines);
+        CHECK(rest.starts_with("kept\n"));
+        rest.remove_prefix(5);
+        std::size_t count = 0;
+        for (std::size_t end; (end = rest.find('\n')) != std::string_view::npos; count++) {
+            CHECK(matches(*regex, rest.substr(0, end)));
+            rest.remove_prefix(end + 1);
+        }
+        CHECK_EQ(count, 100);
+    }
+}
\ No newline at end of file
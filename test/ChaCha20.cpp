@@ -0,0 +1,83 @@
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <strex/ChaCha20.hpp>
+#include <strex/Exception.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+// Key 00 01 02 ... 1f of RFC 8439, as little-endian words.
+ChaCha20::Key rfc_key() {
+    ChaCha20::Key key;
+    for (std::uint32_t i = 0; i < key.size(); i++)
+        key[i] = (4 * i) | (4 * i + 1) << 8 | (4 * i + 2) << 16 | (4 * i + 3) << 24;
+    return key;
+}
+
+TEST_CASE("block function") {
+    // RFC 8439 2.3.2: block 1 of nonce 00 00 00 09 00 00 00 4a 00 00 00 00. Its 32-bit counter
+    // and the first nonce word are the 64-bit counter here.
+    ChaCha20 engine(rfc_key(), 0x4A000000, 0x09000000'00000001);
+    std::array<std::uint32_t, 16> expected{
+        0xE4E7F110, 0x15593BD1, 0x1FDD0F50, 0xC47120A3, 0xC7F4D1C7, 0x0368C033,
+        0x9AAA2204, 0x4E6CD4C3, 0x466482D2, 0x09AA9F07, 0x05D7C214, 0xA2028BD9,
+        0xD19C12B5, 0xB94E16DE, 0xE883D0CB, 0x4E3C50A2,
+    };
+    for (std::uint32_t word : expected)
+        CHECK_EQ(engine(), word);
+}
+
+TEST_CASE("keystream") {
+    // RFC 8439 2.4.2: the keystream of block 1 and 2 starts with these words.
+    ChaCha20 engine(rfc_key(), 0x4A000000, 1);
+    CHECK_EQ(engine(), 0xF3514F22);
+    CHECK_EQ(engine(), 0xE1D91B40);
+    for (int i = 2; i < 16; i++)
+        engine();
+    CHECK_EQ(engine(), 0x9F74A669);
+}
+
+TEST_CASE("lanes") {
+    // Blocks generated in one refill are the blocks of consecutive counters.
+    ChaCha20 batched(rfc_key(), 7);
+    std::vector<std::uint32_t> words;
+    for (std::size_t i = 0; i < 16 * ChaCha20::lanes * 2; i++)
+        words.push_back(batched());
+    for (std::uint64_t block = 0; block < ChaCha20::lanes * 2; block++) {
+        ChaCha20 single(rfc_key(), 7, block);
+        for (std::size_t i = 0; i < 16; i++)
+            REQUIRE_EQ(single(), words[block * 16 + i]);
+    }
+}
+
+TEST_CASE("seeded by the OS") {
+    ChaCha20 first;
+    ChaCha20 second;
+    std::vector<std::uint32_t> first_words;
+    std::vector<std::uint32_t> second_words;
+    for (int i = 0; i < 8; i++) {
+        first_words.push_back(first());
+        second_words.push_back(second());
+    }
+    CHECK(first_words != second_words);
+
+    // Output continues over rekeying.
+    for (std::uint64_t i = 0; i < ChaCha20::rekey_interval * 3 / sizeof(std::uint32_t); i++)
+        first();
+}
+
+TEST_CASE("secure from_regex") {
+    ParsedRegex regex("sk_(live|test)_[A-Za-z0-9]{32}");
+    auto strings = from_regex_secure(regex, 1000);
+    CHECK_EQ(strings.size(), 1000);
+    for (const std::string &str : strings)
+        CHECK(matches(regex, str));
+
+    ParsedRegex lookahead("(?=.*1)[01]{4}");
+    CHECK_THROWS_AS(from_regex_secure(lookahead, 1), SyntaxNotSupport);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/CppEmitter.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Parser.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+std::unique_ptr<ASTNode> parse(std::string_view regex) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    return parser.parse();
+}
+
+std::string emit(std::string_view regex) {
+    ParsedRegex parsed(regex);
+    return emit_cpp(parsed, "generate", regex);
+}
+
+bool contains(std::string_view text, std::string_view part) {
+    return text.find(part) != std::string_view::npos;
+}
+
+TEST_CASE("quote") {
+    CHECK_EQ(CppEmitter::quote("abc"), "\"abc\"");
+    CHECK_EQ(CppEmitter::quote("a\"b\\c"), "\"a\\\"b\\\\c\"");
+    CHECK_EQ(CppEmitter::quote("\n1"), "\"\\0121\"");
+    CHECK_EQ(CppEmitter::quote("'", '\''), "'\\''");
+}
+
+TEST_CASE("function name") {
+    auto ast = parse("a");
+    CHECK_NOTHROW(CppEmitter(ast.get(), "uuid_v4"));
+    CHECK_THROWS_AS(CppEmitter(ast.get(), ""), std::invalid_argument);
+    CHECK_THROWS_AS(CppEmitter(ast.get(), "4uuid"), std::invalid_argument);
+    CHECK_THROWS_AS(CppEmitter(ast.get(), "uuid-v4"), std::invalid_argument);
+    // Keywords and names used by the header would not compile.
+    for (const char *name : {"class", "and", "out", "engine", "Engine", "detail", "table_0",
+                             "capture_1_offset", "begin_1", "i0", "__uuid", "_Uuid"})
+        CHECK_THROWS_AS(CppEmitter(ast.get(), name), std::invalid_argument);
+    CHECK_NOTHROW(CppEmitter(ast.get(), "append_code_point"));
+    CHECK_NOTHROW(CppEmitter(ast.get(), "index"));
+}
+
+TEST_CASE("header") {
+    std::string header = emit("abc");
+    CHECK(contains(header, "#pragma once"));
+    CHECK(contains(header, "#ifndef STREX_GENERATED_RUNTIME"));
+    CHECK(contains(header, "inline void generate(std::string &out, Engine &engine) {"));
+    CHECK(contains(header, "inline std::string generate(Engine &engine) {"));
+    CHECK(contains(header, "    out.append(\"abc\", 3);\n"));
+}
+
+TEST_CASE("straight-line code") {
+    // Short fixed repetitions of charsets are unrolled, tables are shared.
+    std::string header = emit("[0-9a-f]{4}-[0-9a-f]");
+    CHECK(contains(header, "static constexpr char table_0[] = \"0123456789abcdef\";"));
+    CHECK_FALSE(contains(header, "table_1"));
+    CHECK_FALSE(contains(header, "for ("));
+    std::string draw = "    out.push_back(table_0[engine.below(16)]);\n";
+    CHECK(contains(header, draw + draw + draw + draw + "    out.push_back('-');\n" + draw));
+
+    CHECK(contains(emit("x{3}"), "out.append(\"xxx\", 3);"));
+    CHECK(contains(emit("[ab]{17}"), "for (int i0 = 0; i0 < 17; i0++) {"));
+    CHECK(contains(emit("[ab]{2,5}"), "for (auto i0 = 2 + engine.below(4); i0 > 0; i0--) {"));
+}
+
+TEST_CASE("alternation") {
+    std::string header = emit("(foo|ba[rz]|q)");
+    CHECK(contains(header, "switch (engine.below(3)) {"));
+    CHECK(contains(header, "case 0: {\n            out.append(\"foo\", 3);\n            break;"));
+    CHECK(contains(header, "default: {\n            out.push_back('q');"));
+}
+
+TEST_CASE("backreference") {
+    std::string header = emit("(x[ab])-\\1");
+    CHECK(contains(header, "std::size_t capture_1_offset = 0, capture_1_length = 0;"));
+    CHECK(contains(header, "capture_1_offset = begin_1, capture_1_length = out.size() - begin_1;"));
+    CHECK(contains(header, "out.append(out, capture_1_offset, capture_1_length);"));
+}
+
+TEST_CASE("unicode") {
+    std::string header = emit("[α-γ]é");
+    CHECK(contains(header, "static constexpr std::uint32_t table_0[][2] = {\n        {0x3b1, 0},"));
+    CHECK(contains(header, "detail::append_code_point(out, table_0, 1, engine.below(3));"));
+    CHECK(contains(header, "out.append(\"\\303\\251\", 2);"));
+}
+
+TEST_CASE("lookaround") {
+    CHECK_THROWS_AS(emit("(?=a)[ab]"), SyntaxNotSupport);
+    CHECK_THROWS_AS(emit("a^b"), SyntaxNotSupport);
+}
\ No newline at end of file
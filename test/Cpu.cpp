@@ -0,0 +1,94 @@
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <strex/ChaCha20.hpp>
+#include <strex/Cpu.hpp>
+#include <strex/Random.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+// Levels the running CPU can execute, which are compared with the lowest one.
+std::vector<cpu::Level> supported_levels() {
+    std::vector<cpu::Level> levels;
+    for (cpu::Level level : {cpu::Level::Scalar, cpu::Level::SSE2, cpu::Level::AVX2,
+                             cpu::Level::AVX512}) {
+        if (level <= cpu::detect())
+            levels.push_back(level);
+    }
+    return levels;
+}
+
+TEST_CASE("levels") {
+    for (cpu::Level level : supported_levels())
+        CHECK(cpu::parse_level(cpu::name(level)) == level);
+    CHECK(cpu::parse_level("sse4") == std::nullopt);
+    CHECK(cpu::kernels(cpu::detect()).level == cpu::detect());
+    CHECK(cpu::active().level <= cpu::detect());
+    // x86-64 has no kernels below SSE2, and the fallback tells its level.
+    cpu::Level lowest = cpu::detect() == cpu::Level::Scalar ? cpu::Level::Scalar : cpu::Level::SSE2;
+    CHECK(cpu::kernels(cpu::Level::Scalar).level == lowest);
+}
+
+TEST_CASE("kernel variants give the same output") {
+    const cpu::Kernels &base = cpu::kernels(cpu::Level::Scalar);
+    SplitMix64 seeds(11);
+
+    std::array<std::uint64_t, 4 * BlockEngine::lanes> state;
+    for (std::uint64_t &word : state)
+        word = seeds();
+    std::array<std::uint32_t, 16 * ChaCha20::lanes> input;
+    for (std::uint32_t &word : input)
+        word = static_cast<std::uint32_t>(seeds());
+    std::array<std::uint32_t, 1000> words;
+    for (std::uint32_t &word : words)
+        word = static_cast<std::uint32_t>(seeds());
+    const std::string table = "0123456789abcdef";
+
+    for (cpu::Level level : supported_levels()) {
+        const cpu::Kernels &kernels = cpu::kernels(level);
+        INFO("level: ", cpu::name(kernels.level));
+
+        auto base_state = state;
+        auto kernel_state = state;
+        std::vector<std::uint32_t> base_block(BlockEngine::block_words);
+        std::vector<std::uint32_t> kernel_block(BlockEngine::block_words);
+        base.xoshiro_block(base_state.data(), base_block.data());
+        kernels.xoshiro_block(kernel_state.data(), kernel_block.data());
+        CHECK(kernel_state == base_state);
+        CHECK(kernel_block == base_block);
+
+        std::array<std::uint32_t, 16 * ChaCha20::lanes> base_output, kernel_output;
+        base.chacha20_blocks(input.data(), base_output.data());
+        kernels.chacha20_blocks(input.data(), kernel_output.data());
+        CHECK(kernel_output == base_output);
+
+        for (std::uint32_t size : {2u, 10u, 16u}) {
+            std::string base_run(words.size(), '\0');
+            std::string kernel_run(words.size(), '\0');
+            base.charset_run(base_run.data(), words.data(), words.size(), table.data(), size);
+            kernels.charset_run(kernel_run.data(), words.data(), words.size(), table.data(),
+                                size);
+            CHECK(kernel_run == base_run);
+        }
+    }
+}
+
+TEST_CASE("charset runs") {
+    for (cpu::Level level : supported_levels()) {
+        const cpu::Kernels &kernels = cpu::kernels(level);
+        INFO("level: ", cpu::name(kernels.level));
+        std::string out(3, '\0');
+
+        std::array<std::uint32_t, 3> words{0x10, 0x55555556, 0xFFFFFFFF};
+        CHECK(kernels.charset_run(out.data(), words.data(), words.size(), "xyz", 3));
+        CHECK(out == "xyz");
+
+        // 2^32 % 3 is 1, so the product of 0 is one of the extra ones of value 0.
+        words[1] = 0;
+        CHECK_FALSE(kernels.charset_run(out.data(), words.data(), words.size(), "xyz", 3));
+    }
+}
\ No newline at end of file
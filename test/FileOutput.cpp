@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <strex/FileOutput.hpp>
+#include <strex/GenerationOptions.hpp>
+#include <strex/Stats.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+// Returns the lines of the file at `path`.
+std::vector<std::string> read_lines(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+// Checks that the file at `path` has `count` lines that match `regex`, and no chunk files.
+void check_file(const std::string &path, std::string_view regex, std::size_t count,
+                unsigned jobs) {
+    generate_to_file(regex, {}, path, count, jobs);
+    auto lines = read_lines(path);
+    CHECK(lines.size() == count);
+    ParsedRegex parsed(regex);
+    for (const auto &line : lines)
+        CHECK(matches(parsed, line));
+    for (unsigned i = 0; i < jobs; i++)
+        CHECK(!std::filesystem::exists(path + ".part" + std::to_string(i)));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("fixed length") {
+    auto path = (std::filesystem::temp_directory_path() / "strex_fixed.txt").string();
+    check_file(path, "[0-9a-f]{8}-[0-9a-f]{4}", 10000, 4);
+    check_file(path, "[0-9a-f]{8}", 3, 8);
+    check_file(path, "[0-9a-f]{8}", 0, 2);
+
+    generate_to_file("[a-c]{2}", {}, path, 100, 3);
+    CHECK(std::filesystem::file_size(path) == 300);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("statistics of mapped output") {
+    auto path = (std::filesystem::temp_directory_path() / "strex_stats.txt").string();
+    auto before = stats::collect();
+    stats::enable();
+    generate_to_file("[0-9a-f]{32}", {}, path, 10000, 2);
+    stats::enable(false);
+    auto after = stats::collect();
+    CHECK(after.strings - before.strings == 10000);
+    CHECK(after.latency.count() - before.latency.count() == 10000);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("variable length") {
+    auto path = (std::filesystem::temp_directory_path() / "strex_variable.txt").string();
+    check_file(path, "[a-z]{1,9}(foo|barbaz)?", 10000, 4);
+    check_file(path, "x(?=y)y+", 100, 2);
+    check_file(path, "[a-z]*", 5, 1);
+
+    // A file with the name of a chunk is left as it is.
+    std::ofstream(path + ".part0") << "kept";
+    generate_to_file("[a-z]{1,3}", {}, path, 100, 2);
+    CHECK(read_lines(path).size() == 100);
+    CHECK(read_lines(path + ".part0") == std::vector<std::string>{"kept"});
+    CHECK(!std::filesystem::exists(path + ".part0.1"));
+    std::remove((path + ".part0").c_str());
+    std::remove(path.c_str());
+}
\ No newline at end of file
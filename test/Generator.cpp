@@ -1,13 +1,25 @@
 #include <algorithm>
+#include <array>
 #include <cctype>
-#include <regex>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
+#include <strex/Cpu.hpp>
 #include <strex/Exception.hpp>
+#include <strex/GenerationOptions.hpp>
 #include <strex/Generator.hpp>
 #include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
 #include <strex/Parser.hpp>
+#include <strex/Random.hpp>
+#include <strex/Sink.hpp>
 
 #include "helper/ASTFormatter.hpp"
 
@@ -15,7 +27,9 @@
 
 using namespace strex;
 
-constexpr static int default_test_count = 50;
+// `Matcher` verifies a string in about the time it takes to generate it, so every pattern is
+// checked on many samples.
+constexpr static int default_test_count = 20000;
 
 void check(std::string_view regex, int test_count = default_test_count) {
     Lexer lexer(std::string{regex});
@@ -28,16 +42,15 @@ void check(std::string_view regex, int test_count = default_test_count) {
     std::string formatted_ast = formatter.format();
 
     Generator generator(ast.get());
+    Matcher matcher(ast.get());
 
     for (int i = 0; i < test_count; i++) {
         auto str = generator.generate();
 
-        std::regex r(std::string{regex});
-
         INFO("generated string: \"", str, "\"");
         INFO("AST: ", formatted_ast);
         REQUIRE(std::ranges::all_of(str, ::isprint));
-        CHECK(std::regex_match(str, r));
+        REQUIRE(matcher.matches(str));
     }
 }
 
@@ -116,6 +129,13 @@ TEST_CASE("backreference") {
     check("(a)\\1");
     check("(ab[cd]*)ef\\1");
     check(R"((a?)\1(b+)\2(ccd)\3)");
+    check(R"(((a)b)\2)");
+    check(R"(((a|b)(c|d))\3\2\1)");
+}
+
+TEST_CASE("non-capturing group") {
+    check("(?:ab|c)+d");
+    check(R"((?:a|b)(c+)(?:d(e))\2\1)");
 }
 
 TEST_CASE("generate sequence") {
@@ -157,6 +177,19 @@ TEST_CASE("group and backreference in the same alternation") {
     }
 }
 
+TEST_CASE("deeply nested groups") {
+    constexpr int depth = 100000;
+    std::string regex = std::string(depth, '(') + "a" + std::string(depth, ')');
+    Lexer lexer(regex);
+    auto tokens = lexer.tokenize();
+
+    Parser parser(tokens);
+    auto ast = parser.parse();
+
+    Generator generator(ast.get());
+    CHECK_EQ(generator.generate(), "a");
+}
+
 TEST_CASE("phone number") {
     check(R"(1(3[0-9]|4[57]|5[0-35-9]|7[0678]|8[0-9])\d{8})");
     check(R"((13[0-9]|14[01456879]|15[0-35-9]|16[2567]|17[0-8]|18[0-9]|19[0-35-9])\d{8})");
@@ -172,4 +205,197 @@ TEST_CASE("ipv4 address") {
 TEST_CASE("email") {
     check(
         R"(([\w\!\#$\%\&\'\*\+\-\/\=\?\^\`{\|\}\~]+\.)*[\w\!\#$\%\&\'\*\+\-\/\=\?\^\`{\|\}\~]+@((((([a-z0-9]{1}[a-z0-9\-]{0,62}[a-z0-9]{1})|[a-z])\.)+[a-z]{2,6})|(\d{1,3}\.){3}\d{1,3}(\:\d{1,5})?))");
+}
+
+TEST_CASE("bit reservoir") {
+    BitReservoir<std::mt19937> random(std::mt19937{42});
+    for (std::uint32_t bound : {2U, 3U, 10U, 95U}) {
+        INFO("bound: ", bound);
+        std::array<int, 95> counts{};
+        int draws = 20000 * static_cast<int>(bound);
+        for (int i = 0; i < draws; i++) {
+            auto value = random(bound);
+            REQUIRE(value < bound);
+            counts[value]++;
+        }
+        // Each count is 20000 with a standard deviation below 150.
+        for (std::uint32_t value = 0; value < bound; value++)
+            CHECK(std::abs(counts[value] - 20000) < 1000);
+    }
+    CHECK_EQ(random(1), 0);
+}
+
+TEST_CASE("choices share engine outputs") {
+    Lexer lexer(R"(\d{1000})");
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+
+    Generator generator(ast.get());
+    generator.generate();
+    // The digits and the count of repetitions.
+    CHECK_EQ(generator.random_draws(), 1001);
+    // A digit takes log2(10) bits, about 104 outputs of 32 bits for 1000 digits.
+    CHECK_LT(generator.engine_calls(), 120);
+}
+
+TEST_CASE("block engine") {
+    // Lane `j` is xoshiro256** seeded with outputs `j`, `j + lanes`, ... of `SplitMix64`.
+    constexpr std::size_t lanes = BlockEngine::lanes;
+    SplitMix64 seeds(7);
+    std::uint64_t state[4][lanes];
+    for (auto &word : state) {
+        for (std::uint64_t &lane : word)
+            lane = seeds();
+    }
+    auto rotate = [](std::uint64_t value, int shift) {
+        return value << shift | value >> (64 - shift);
+    };
+    auto next = [&](std::size_t lane) {
+        std::uint64_t *s[4] = {&state[0][lane], &state[1][lane], &state[2][lane], &state[3][lane]};
+        std::uint64_t result = rotate(*s[1] * 5, 7) * 9;
+        std::uint64_t t = *s[1] << 17;
+        *s[2] ^= *s[0];
+        *s[3] ^= *s[1];
+        *s[1] ^= *s[2];
+        *s[0] ^= *s[3];
+        *s[2] ^= t;
+        *s[3] = rotate(*s[3], 45);
+        return result;
+    };
+
+    INFO("kernel: ", cpu::name(cpu::active().level));
+    BlockEngine engine(7);
+    // Two blocks, to check that the state is carried to the next block.
+    for (std::size_t step = 0; step < BlockEngine::block_words / lanes; step++) {
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            std::uint64_t expected = next(lane);
+            std::uint64_t low = engine();
+            std::uint64_t high = engine();
+            REQUIRE_EQ(low | high << 32, expected);
+        }
+    }
+    const std::uint32_t *words = engine.take(BlockEngine::block_words);
+    CHECK_EQ(words[0] | std::uint64_t{words[1]} << 32, next(0));
+}
+
+// Returns the AST of `regex` with open-ended repetitions bounded by `max_repeat`.
+std::unique_ptr<ASTNode> parse(std::string_view regex, int max_repeat) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens, max_repeat);
+    return parser.parse();
+}
+
+TEST_CASE("byte budget") {
+    auto ast = parse("((a{0,1000}){0,1000}){0,1000}", 3);
+    GenerationOptions options;
+    options.max_bytes = 16;
+    Generator truncated(ast.get(), options);
+    for (int i = 0; i < 100; i++)
+        CHECK_LE(truncated.generate().size(), 16);
+
+    // A character is not cut in the middle.
+    auto two_bytes = parse("é{10}", 3);
+    options.max_bytes = 5;
+    CHECK_EQ(Generator(two_bytes.get(), options).generate(), "éé");
+
+    options.budget_policy = BudgetPolicy::Error;
+    CHECK_THROWS_AS(Generator(two_bytes.get(), options).generate(), GenerateError);
+
+    // The shortest string has the fewest repetitions, and the shortest alternative.
+    auto alternatives = parse(R"((\d{8}|[a-f]{2})+-\1)", 3);
+    Matcher matcher(alternatives.get());
+    options.budget_policy = BudgetPolicy::Shortest;
+    Generator shortest(alternatives.get(), options);
+    for (int i = 0; i < 100; i++) {
+        auto generated = shortest.generate();
+        INFO("generated string: \"", generated, "\"");
+        CHECK_LE(generated.size(), 5);
+        CHECK(matcher.matches(generated));
+    }
+    options.max_bytes = 4;
+    CHECK_THROWS_AS(Generator(alternatives.get(), options).generate(), GenerateError);
+}
+
+TEST_CASE("geometric repetitions") {
+    auto ast = parse("a{2,}", 1000);
+    GenerationOptions options;
+    options.repeat_distribution = RepeatDistribution::Geometric;
+    options.repeat_mean = 4.0;
+    Generator generator(ast.get(), options);
+    constexpr int count = 20000;
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        auto length = generator.generate().size();
+        REQUIRE(length >= 2);
+        total += static_cast<double>(length - 2);
+    }
+    CHECK(std::abs(total / count - 4.0) < 0.2);
+
+    // Counts are capped at the upper bound.
+    auto capped = parse("a{0,3}", 3);
+    options.repeat_mean = 100.0;
+    Generator capped_generator(capped.get(), options);
+    for (int i = 0; i < 100; i++)
+        CHECK_LE(capped_generator.generate().size(), 3);
+
+    options.repeat_mean = 0.0;
+    CHECK_THROWS_AS(Generator(ast.get(), options), std::invalid_argument);
+}
+
+TEST_CASE("streaming") {
+    auto ast = parse(R"(([a-z]{100000})-\d{100000}-\1)", 3);
+    Generator generator(ast.get());
+    std::string streamed;
+    std::size_t chunk_count = 0;
+    CallbackSink sink([&](std::string_view chunk) {
+        CHECK_LE(chunk.size(), 2 * Generator::chunk_size);
+        streamed.append(chunk);
+        chunk_count++;
+    });
+    generator.generate(sink);
+    CHECK_GT(chunk_count, 1);
+    REQUIRE_EQ(streamed.size(), 300002);
+    CHECK_EQ(generator.streamed_bytes(), streamed.size());
+    // The backreference copies a group that was streamed long before.
+    CHECK_EQ(streamed.substr(0, 100000), streamed.substr(200002));
+    CHECK(std::ranges::all_of(streamed.substr(100001, 100000), ::isdigit));
+
+    // A budget over `chunk_size` truncates the stream, between characters.
+    auto two_bytes = parse("é{100000}", 3);
+    GenerationOptions options;
+    options.max_bytes = 100001;
+    Generator truncated(two_bytes.get(), options);
+    streamed.clear();
+    truncated.generate(sink);
+    CHECK_EQ(streamed.size(), 100000);
+}
+
+TEST_CASE("fd sink") {
+    // Chunks go to a temporary file, which is read back.
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+#if defined(_WIN32)
+    FdSink sink(_fileno(file));
+#else
+    FdSink sink(fileno(file));
+#endif
+    auto ast = parse("[a-z]{200000}", 3);
+    Generator generator(ast.get());
+    std::string streamed;
+    CallbackSink copy([&](std::string_view chunk) {
+        streamed.append(chunk);
+        sink.write(chunk);
+    });
+    generator.generate(copy);
+    sink.write("\n");
+    std::rewind(file);
+    std::string text(streamed.size() + 1, '\0');
+    REQUIRE_EQ(std::fread(text.data(), 1, text.size(), file), text.size());
+    CHECK_EQ(std::fgetc(file), EOF);
+    CHECK_EQ(text, streamed + "\n");
+    std::fclose(file);
+
+    CHECK_THROWS_AS(FdSink(-1).write("lost"), GenerateError);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <strex/Lexer.hpp>
 #include <strex/TextRange.hpp>
 #include <strex/Token.hpp>
+#include <strex/Unicode.hpp>
 
 #include <doctest/doctest.h>
 
@@ -383,33 +384,53 @@ TEST_CASE("lazy") {
     }
 }
 
-// TODO
-// TEST_CASE("extension") {
-//     Lexer lexer(R"((?=)(?!)(?<=)(?<!)(?:))");
-//     std::vector<strex::TokenType> expect_types = {
-//         TokenType::Left_Paren,          // (
-//         TokenType::Positive_Lookahead,  // ?=
-//         TokenType::Right_Paren,         // )
-//         TokenType::Left_Paren,          // (
-//         TokenType::Negative_Lookahead,  // ?!
-//         TokenType::Right_Paren,         // )
-//         TokenType::Left_Paren,          // (
-//         TokenType::Positive_Lookbehind, // ?<=
-//         TokenType::Right_Paren,         // )
-//         TokenType::Left_Paren,          // (
-//         TokenType::Negative_Lookbehind, // ?<!
-//         TokenType::Right_Paren,         // )
-//         TokenType::Left_Paren,          // (
-//         TokenType::Non_Capturing_Group, // ?:
-//         TokenType::Right_Paren,         // )
-//         TokenType::End,                 // EOF
-//     };
-//     auto tokens = lexer.tokenize();
-//     REQUIRE(tokens.size() == expect_types.size());
-//     for (std::size_t i = 0; i < tokens.size(); i++) {
-//         CHECK(tokens[i].type() == expect_types[i]);
-//     }
-// }
+TEST_CASE("extension") {
+    Lexer lexer(R"((?=)(?!)(?<=)(?<!)(?:))");
+    std::vector<strex::TokenType> expect_types = {
+        TokenType::Left_Paren,          // (
+        TokenType::Positive_Lookahead,  // ?=
+        TokenType::Right_Paren,         // )
+        TokenType::Left_Paren,          // (
+        TokenType::Negative_Lookahead,  // ?!
+        TokenType::Right_Paren,         // )
+        TokenType::Left_Paren,          // (
+        TokenType::Positive_Lookbehind, // ?<=
+        TokenType::Right_Paren,         // )
+        TokenType::Left_Paren,          // (
+        TokenType::Negative_Lookbehind, // ?<!
+        TokenType::Right_Paren,         // )
+        TokenType::Left_Paren,          // (
+        TokenType::Non_Capturing_Group, // ?:
+        TokenType::Right_Paren,         // )
+        TokenType::End,                 // EOF
+    };
+    auto tokens = lexer.tokenize();
+    REQUIRE(tokens.size() == expect_types.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        CHECK(tokens[i].type() == expect_types[i]);
+    }
+}
+
+TEST_CASE("non-capturing group") {
+    Lexer lexer(R"((?:a)(b)\1)");
+    std::vector<strex::TokenType> expect_types = {
+        TokenType::Left_Paren,          // (
+        TokenType::Non_Capturing_Group, // ?:
+        TokenType::Character,           // a
+        TokenType::Right_Paren,         // )
+        TokenType::Left_Paren,          // (
+        TokenType::Character,           // b
+        TokenType::Right_Paren,         // )
+        TokenType::Backreference,       // \1
+        TokenType::End,                 // EOF
+    };
+    auto tokens = lexer.tokenize();
+    REQUIRE(tokens.size() == expect_types.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        CHECK(tokens[i].type() == expect_types[i]);
+    }
+    CHECK_EQ(tokens[7].group_number(), 1);
+}
 
 TEST_CASE("invalid extension") {
     Lexer lexer(R"((?a))");
@@ -455,9 +476,58 @@ TEST_CASE("hex number4") {
     }
 }
 
-TEST_CASE("unsupported hex value") {
-    Lexer lexer(R"(\uffff)");
-    CHECK_THROWS_AS_MESSAGE(lexer.tokenize(), LexicalError, "unsupported hex value 0xffff");
+TEST_CASE("code point") {
+    Lexer lexer(R"(\uffff\u{1F600}\uD83D\uDE00\u{})");
+    std::vector<std::pair<strex::TokenType, char32_t>> expect_types = {
+        {TokenType::Character, 0xffff},  // \uffff
+        {TokenType::Character, 0x1f600}, // \u{1F600}
+        {TokenType::Character, 0x1f600}, // \uD83D\uDE00, a surrogate pair
+        {TokenType::Character, 'u'},     // \u, no digits in braces
+        {TokenType::Character, '{'},     // {
+        {TokenType::Character, '}'},     // }
+        {TokenType::End, 0},             // EOF
+    };
+    auto tokens = lexer.tokenize();
+    REQUIRE(tokens.size() == expect_types.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        CHECK(tokens[i].type() == expect_types[i].first);
+        if (tokens[i].is(TokenType::Character))
+            CHECK(tokens[i].code_point() == expect_types[i].second);
+    }
+}
+
+TEST_CASE("invalid code point") {
+    Lexer out_of_range(R"(\u{110000})");
+    CHECK_THROWS_AS_MESSAGE(out_of_range.tokenize(), LexicalError,
+                            "code point \\u{110000} is out of range");
+    Lexer lone_surrogate(R"(\uD83Dx)");
+    CHECK_THROWS_AS_MESSAGE(lone_surrogate.tokenize(), LexicalError,
+                            "lone surrogate \\ud83d is not a character");
+}
+
+TEST_CASE("unicode property") {
+    Lexer lexer(R"(\p{Lu}\P{Letter}\p)");
+    std::vector<std::pair<strex::TokenType, char>> expect_types = {
+        {TokenType::Char_Class, 'p'}, // \p{Lu}
+        {TokenType::Char_Class, 'P'}, // \P{Letter}
+        {TokenType::Character, 'p'},  // \p
+        {TokenType::End, '\0'},       // EOF
+    };
+    auto tokens = lexer.tokenize();
+    REQUIRE(tokens.size() == expect_types.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        CHECK(tokens[i].type() == expect_types[i].first);
+        if (tokens[i].is(TokenType::Character) || tokens[i].is(TokenType::Char_Class))
+            CHECK(tokens[i].character() == expect_types[i].second);
+    }
+    CHECK(tokens[0].categories() == strex::unicode::property_categories("Lu"));
+    CHECK(tokens[1].categories() == strex::unicode::property_categories("L"));
+
+    Lexer unknown(R"(\p{Klingon})");
+    CHECK_THROWS_AS_MESSAGE(unknown.tokenize(), LexicalError, "unknown unicode property 'Klingon'");
+    Lexer unclosed(R"(\p{Lu)");
+    CHECK_THROWS_AS_MESSAGE(unclosed.tokenize(), LexicalError,
+                            "expect '}' to close unicode property at offset 2");
 }
 
 TEST_CASE("dot") {
@@ -482,19 +552,37 @@ TEST_CASE("dot") {
 
 TEST_CASE("non-ascii") {
     Lexer lexer(R"(你好)");
-    std::vector<strex::TokenType> expect_types = {
-        TokenType::Character, TokenType::Character, TokenType::Character, TokenType::Character,
-        TokenType::Character, TokenType::Character, TokenType::End,
+    std::vector<std::pair<strex::TokenType, char32_t>> expect_types = {
+        {TokenType::Character, U'你'},
+        {TokenType::Character, U'好'},
+        {TokenType::End, 0},
     };
     auto tokens = lexer.tokenize();
     REQUIRE(tokens.size() == expect_types.size());
     for (std::size_t i = 0; i < tokens.size(); i++) {
-        CHECK(tokens[i].type() == expect_types[i]);
+        CHECK(tokens[i].type() == expect_types[i].first);
+        if (tokens[i].is(TokenType::Character))
+            CHECK(tokens[i].code_point() == expect_types[i].second);
     }
 }
 
 TEST_CASE("non-ascii in charset") {
     Lexer lexer("[你好]");
-    CHECK_THROWS_AS_MESSAGE(lexer.tokenize(), LexicalError,
-                            "non-ascii character in charset is not supported");
+    std::vector<std::pair<strex::TokenType, char32_t>> expect_types = {
+        {TokenType::Left_Bracket, '['}, {TokenType::Character, U'你'},
+        {TokenType::Character, U'好'},  {TokenType::Right_Bracket, ']'},
+        {TokenType::End, 0},
+    };
+    auto tokens = lexer.tokenize();
+    REQUIRE(tokens.size() == expect_types.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        CHECK(tokens[i].type() == expect_types[i].first);
+        if (tokens[i].is(TokenType::Character))
+            CHECK(tokens[i].code_point() == expect_types[i].second);
+    }
+}
+
+TEST_CASE("invalid UTF-8") {
+    Lexer lexer("a\xff");
+    CHECK_THROWS_AS_MESSAGE(lexer.tokenize(), LexicalError, "invalid UTF-8 sequence at offset 1");
 }
\ No newline at end of file
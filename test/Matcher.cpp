@@ -0,0 +1,135 @@
+#include <string>
+#include <string_view>
+
+#include <strex/Exception.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Parser.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+bool matches(std::string_view regex, std::string_view text) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    Matcher matcher(ast.get());
+    return matcher.matches(text);
+}
+
+TEST_CASE("match text and charset") {
+    CHECK(matches("abc", "abc"));
+    CHECK_FALSE(matches("abc", "ab"));
+    CHECK_FALSE(matches("abc", "abcd"));
+    CHECK(matches("a[b-d]e", "ace"));
+    CHECK_FALSE(matches("a[b-d]e", "aee"));
+    CHECK(matches("[^b-d]", "a"));
+    CHECK_FALSE(matches("[^b-d]", "c"));
+    CHECK(matches(R"(\d\w\s)", "1_ "));
+    CHECK_FALSE(matches(R"(\D)", "1"));
+    CHECK(matches(".", "x"));
+    CHECK_FALSE(matches(".", "\n"));
+}
+
+TEST_CASE("match alternation") {
+    CHECK(matches("ab|cd|ef", "cd"));
+    CHECK(matches("ab|cd|ef", "ef"));
+    CHECK_FALSE(matches("ab|cd|ef", "ad"));
+    CHECK(matches("a(|b)c", "ac"));
+    CHECK(matches("a(|b)c", "abc"));
+    CHECK(matches("(a|b)(c|(d|e))", "be"));
+}
+
+TEST_CASE("match repeat") {
+    CHECK(matches("a{2,4}", "aa"));
+    CHECK(matches("a{2,4}", "aaaa"));
+    CHECK_FALSE(matches("a{2,4}", "a"));
+    CHECK_FALSE(matches("a{2,4}", "aaaaa"));
+    CHECK(matches("a?b", "b"));
+
+    // Open-ended repetitions match more than `Generator` generates.
+    CHECK(matches("a*", ""));
+    CHECK(matches("a+", std::string(1000, 'a')));
+    CHECK_FALSE(matches("a+", ""));
+    CHECK(matches("a{3,}", std::string(50, 'a')));
+    CHECK_FALSE(matches("a{3,}", "aa"));
+    CHECK(matches("(a*)*b", "aaab"));
+    CHECK(matches("(ab|c){2,3}d", "cabd"));
+}
+
+TEST_CASE("match backreference") {
+    CHECK(matches(R"((a|b)\1)", "bb"));
+    CHECK_FALSE(matches(R"((a|b)\1)", "ab"));
+    CHECK(matches(R"((\d+)-\1)", "123-123"));
+    CHECK_FALSE(matches(R"((\d+)-\1)", "123-12"));
+    CHECK(matches(R"(((a)b)\2\1)", "abaab"));
+    CHECK(matches(R"((?:(\w)=)+\1)", "a=b=b"));
+    CHECK(matches(R"((a*)*\1b)", "aab"));
+}
+
+TEST_CASE("match anchor") {
+    CHECK(matches("^ab$", "ab"));
+    CHECK(matches("(^a|b)c", "ac"));
+    CHECK_FALSE(matches("b(^a|b)c", "bac"));
+    CHECK_FALSE(matches("a$b", "ab"));
+    CHECK(matches("a(b$|c)", "ab"));
+}
+
+TEST_CASE("match lookaround") {
+    CHECK(matches(R"((?=.*\d)(?=.*[A-Z])\w{4})", "a1Bc"));
+    CHECK_FALSE(matches(R"((?=.*\d)(?=.*[A-Z])\w{4})", "a1bc"));
+    CHECK(matches("(?!ab)[a-c]{2}", "ac"));
+    CHECK_FALSE(matches("(?!ab)[a-c]{2}", "ab"));
+    CHECK(matches("[ab]{3}(?<=ba)", "aba"));
+    CHECK_FALSE(matches("[ab]{3}(?<=ba)", "abb"));
+    CHECK(matches("a(?<!ba)a", "aa"));
+    CHECK(matches("(?=(a+))a*b", "aab"));
+    // Lookaheads see past the end of their group, lookbehinds see before its start.
+    CHECK(matches("(a(?=b))b", "ab"));
+    CHECK(matches("a((?<=a)b)", "ab"));
+    CHECK_FALSE(matches("(?=a$)a.", "ab"));
+}
+
+TEST_CASE("match deeply nested groups") {
+    constexpr int depth = 100000;
+    std::string regex = std::string(depth, '(') + "a" + std::string(depth, ')');
+    CHECK(matches(regex, "a"));
+    CHECK_FALSE(matches(regex, "b"));
+}
+
+TEST_CASE("match large repeat") {
+    CHECK(matches("(ab){1000,2000}", [] {
+        std::string text;
+        for (int i = 0; i < 1500; i++)
+            text += "ab";
+        return text;
+    }()));
+    CHECK_FALSE(matches("[a-z]{500,1000}", std::string(1001, 'a')));
+}
+
+TEST_CASE("match parsed regex") {
+    ParsedRegex regex("[0-9a-f]{8}-[0-9a-f]{4}");
+    CHECK(strex::matches(regex, "0123abcd-ef01"));
+    CHECK_FALSE(strex::matches(regex, "0123abcd-ef0"));
+    for (int i = 0; i < 100; i++)
+        CHECK(strex::matches(regex, from_regex(regex)));
+}
+
+
+TEST_CASE("match unprintable alternatives") {
+    // Generation prunes branches without printable characters, matching keeps them.
+    ParsedRegex alternation(R"([\x00-\x1f]|a)");
+    CHECK(strex::matches(alternation, "\x01"));
+    CHECK(strex::matches(alternation, "a"));
+    ParsedRegex optional(R"(x[\x01]?y)");
+    CHECK(strex::matches(optional, "x\x01y"));
+    CHECK(strex::matches(optional, "xy"));
+    CHECK_FALSE(strex::matches(optional, "x\x02y"));
+    for (int i = 0; i < 20; i++) {
+        CHECK(strex::matches(alternation, from_regex(alternation)));
+        CHECK(strex::matches(optional, from_regex(optional)));
+    }
+}
\ No newline at end of file
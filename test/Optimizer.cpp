@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/Generator.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Optimizer.hpp>
+#include <strex/Parser.hpp>
+
+#include "helper/ASTFormatter.hpp"
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+std::unique_ptr<ASTNode> parse(std::string_view regex) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    return parser.parse();
+}
+
+void check(std::string_view regex, Pass &&pass, std::string_view expect_ast) {
+    auto ast = parse(regex);
+    pass.run(ast);
+
+    test::ASTFormatter formatter(ast.get());
+    INFO("regex: ", regex);
+    CHECK_EQ(formatter.format(), expect_ast);
+}
+
+void check_pipeline(std::string_view regex, std::string_view expect_ast) {
+    auto ast = parse(regex);
+    PassManager::default_pipeline().run(ast);
+
+    test::ASTFormatter formatter(ast.get());
+    std::string formatted_ast = formatter.format();
+    INFO("regex: ", regex);
+    CHECK_EQ(formatted_ast, expect_ast);
+
+    Generator generator(ast.get());
+    std::regex r(std::string{regex});
+    for (int i = 0; i < 50; i++) {
+        auto str = generator.generate();
+
+        INFO("generated string: \"", str, "\"");
+        INFO("AST: ", formatted_ast);
+        REQUIRE(std::ranges::all_of(str, ::isprint));
+        CHECK(std::regex_match(str, r));
+    }
+}
+
+TEST_CASE("flatten sequences") {
+    check("ab", FlattenSequencesPass{}, "(sequence (text \"a\"), (text \"b\"))");
+    check("(ab)c(de)", StripUnusedGroupsPass{},
+          "(sequence (sequence (text \"a\"), (text \"b\")), (text \"c\"), "
+          "(sequence (text \"d\"), (text \"e\")))");
+
+    auto ast = parse("(ab)c(de)");
+    PassManager manager;
+    manager.add(std::make_unique<StripUnusedGroupsPass>())
+        .add(std::make_unique<FlattenSequencesPass>());
+    manager.run(ast);
+    test::ASTFormatter formatter(ast.get());
+    CHECK_EQ(formatter.format(),
+             "(sequence (text \"a\"), (text \"b\"), (text \"c\"), (text \"d\"), (text \"e\"))");
+}
+
+TEST_CASE("merge char alternations") {
+    check("a|b|c", MergeCharAlternationsPass{}, "(charset include abc)");
+    check("x(c|a|b)", MergeCharAlternationsPass{},
+          "(sequence (text \"x\"), (group (charset include abc)))");
+
+    // duplicated or longer alternatives are not merged
+    check("a|a|b", MergeCharAlternationsPass{},
+          "(alter (text \"a\") | (text \"a\") | (text \"b\"))");
+    check("a|bc", MergeCharAlternationsPass{},
+          "(alter (text \"a\") | (sequence (text \"b\"), (text \"c\")))");
+    check("a|\\n", MergeCharAlternationsPass{}, "(alter (text \"a\") | (text \"\n\"))");
+}
+
+TEST_CASE("remove empty text") {
+    // a backreference to the group it is in is empty text
+    check("(a\\1b)", RemoveEmptyTextPass{}, "(group (sequence (text \"a\"), (text \"b\")))");
+    check("(a\\1)", RemoveEmptyTextPass{}, "(group (text \"a\"))");
+    check("(\\1*)", RemoveEmptyTextPass{}, "(group (text \"\"))");
+}
+
+TEST_CASE("collapse unit repeats") {
+    check("a{1}", CollapseUnitRepeatsPass{}, "(text \"a\")");
+    check("a{1,1}b{1,2}", CollapseUnitRepeatsPass{},
+          "(sequence (text \"a\"), (repeat (text \"b\") [1, 2]))");
+}
+
+TEST_CASE("strip unused groups") {
+    check("(a)(b)\\2", StripUnusedGroupsPass{},
+          "(sequence (text \"a\"), (group (text \"b\")), (backref 2))");
+    check("((a)b)", StripUnusedGroupsPass{}, "(sequence (text \"a\"), (text \"b\"))");
+}
+
+TEST_CASE("prune dead branches") {
+    check("a|[^\\x20-\\x7e]|b", PruneDeadBranchesPass{}, "(alter (text \"a\") | (text \"b\"))");
+    check("a|x[^\\x20-\\x7e]", PruneDeadBranchesPass{}, "(text \"a\")");
+    check("a[^\\x20-\\x7e]?", PruneDeadBranchesPass{}, "(sequence (text \"a\"), (text \"\"))");
+    check("(x[^\\x20-\\x7e])|(a)\\1\\2", PruneDeadBranchesPass{},
+          "(sequence (group (text \"a\")), (text \"\"), (backref 2))");
+
+    // nothing can be generated, keep the AST as it is
+    auto ast = parse("[^\\x20-\\x7e]");
+    std::string expect_ast = test::ASTFormatter(ast.get()).format();
+    check("[^\\x20-\\x7e]", PruneDeadBranchesPass{}, expect_ast);
+}
+
+TEST_CASE("default pipeline") {
+    check_pipeline("(a|b|c){1}(de)",
+                   "(sequence (charset include abc), (text \"d\"), (text \"e\"))");
+    check_pipeline("(a|b)\\1", "(sequence (group (charset include ab)), (backref 1))");
+    check_pipeline("x(y|[^\\x20-\\x7e])z", "(sequence (text \"x\"), (text \"y\"), (text \"z\"))");
+    check_pipeline("(a|b)(c)\\2",
+                   "(sequence (charset include ab), (group (text \"c\")), (backref 2))");
+}
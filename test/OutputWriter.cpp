@@ -0,0 +1,114 @@
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#include <strex/OutputWriter.hpp>
+
+#include <doctest/doctest.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace strex;
+
+#if defined(__linux__)
+// Reads `size` bytes from `fd`.
+std::string read_bytes(int fd, std::size_t size) {
+    std::string text(size, '\0');
+    std::size_t done = 0;
+    while (done < size) {
+        auto count = read(fd, text.data() + done, size - done);
+        REQUIRE(count > 0);
+        done += static_cast<std::size_t>(count);
+    }
+    return text;
+}
+
+// Returns `size` bytes that differ from one position to the next.
+std::string pattern(std::size_t size, char first) {
+    std::string text(size, '\0');
+    for (std::size_t i = 0; i < size; i++)
+        text[i] = static_cast<char>(first + i % 23);
+    return text;
+}
+
+TEST_CASE("mode") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    CHECK(OutputWriter(fds[1]).mode() == OutputWriter::Mode::Write);
+    CHECK(OutputWriter(fds[1], OutputWriter::Mode::Vmsplice).mode() ==
+          OutputWriter::Mode::Vmsplice);
+    close(fds[0]);
+    close(fds[1]);
+
+    char name[] = "/tmp/strex_output_XXXXXX";
+    int fd = mkstemp(name);
+    REQUIRE(fd >= 0);
+    CHECK(OutputWriter(fd).mode() == OutputWriter::Mode::Write);
+    CHECK_THROWS(OutputWriter(fd, OutputWriter::Mode::Vmsplice));
+    close(fd);
+    unlink(name);
+}
+
+TEST_CASE("output through a pipe") {
+    for (auto mode : {OutputWriter::Mode::Write, OutputWriter::Mode::Vmsplice}) {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        // A buffer of `write(2)` is written whole only if the pipe can hold it.
+        auto pipe_size = static_cast<int>(OutputWriter::default_buffer_size);
+        REQUIRE(fcntl(fds[1], F_SETPIPE_SZ, pipe_size) > 0);
+        {
+            OutputWriter output(fds[1], mode);
+            std::size_t size = output.buffer_size();
+            // Every buffer fills the pipe, and is read before the next one is written.
+            for (char first : {'a', 'b', 'c'}) {
+                auto text = pattern(size, first);
+                output.write(text.substr(0, 100));
+                output.write(text.substr(100));
+                CHECK(read_bytes(fds[0], size) == text);
+            }
+            output.write("tail");
+            output.flush();
+            CHECK(read_bytes(fds[0], 4) == "tail");
+            output.write("end");
+        }
+        CHECK(read_bytes(fds[0], 3) == "end");
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
+
+TEST_CASE("spliced output is not overwritten") {
+    // The reader moves the first buffer on to another pipe with `splice(2)`, which keeps the
+    // pages instead of copying them, while more buffers are written.
+    int fds[2];
+    int moved[2];
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(pipe(moved) == 0);
+    auto pipe_size = static_cast<int>(OutputWriter::default_buffer_size);
+    REQUIRE(fcntl(moved[1], F_SETPIPE_SZ, pipe_size) > 0);
+    {
+        OutputWriter output(fds[1], OutputWriter::Mode::Vmsplice);
+        std::size_t size = output.buffer_size();
+        REQUIRE(fcntl(moved[1], F_GETPIPE_SZ) >= static_cast<int>(size));
+        auto first = pattern(size, 'a');
+        output.write(first);
+        std::size_t done = 0;
+        while (done < size) {
+            auto count = splice(fds[0], nullptr, moved[1], nullptr, size - done, 0);
+            REQUIRE(count > 0);
+            done += static_cast<std::size_t>(count);
+        }
+        for (char next : {'b', 'c'}) {
+            auto text = pattern(size, next);
+            output.write(text);
+            CHECK(read_bytes(fds[0], size) == text);
+        }
+        CHECK(read_bytes(moved[0], size) == first);
+    }
+    for (int fd : {fds[0], fds[1], moved[0], moved[1]})
+        close(fd);
+}
+#endif
\ No newline at end of file
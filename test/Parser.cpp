@@ -56,6 +56,9 @@ std::string_view ascii_characters() {
     return characters;
 }
 
+// Code points beyond ASCII, which are in every negated set, surrogates excluded.
+constexpr std::string_view non_ascii = R"(\u{80}-\u{d7ff}\u{e000}-\u{10ffff})";
+
 std::string exclude(std::string except) {
     static const std::string all_characters{ascii_characters()};
 
@@ -67,6 +70,7 @@ std::string exclude(std::string except) {
     except.erase(last, end);
 
     std::ranges::set_difference(all_characters, except, std::back_inserter(characters));
+    characters.append(non_ascii);
     return characters;
 }
 
@@ -158,7 +162,7 @@ TEST_CASE("char class \\W") {
 }
 
 TEST_CASE("char class .") {
-    check(".", "(charset include {})", exclude("\n"));
+    check(".", "(charset exclude \n)");
 }
 
 TEST_CASE("charset include plain character") {
@@ -219,7 +223,7 @@ TEST_CASE("charset exclude \\W") {
 }
 
 TEST_CASE("all characters") {
-    check("[\\d\\D]", "(charset include {})", ascii_characters());
+    check("[\\d\\D]", "(charset include {}{})", ascii_characters(), non_ascii);
 }
 
 TEST_CASE("backreference") {
@@ -229,4 +233,83 @@ TEST_CASE("backreference") {
 TEST_CASE("backreference2") {
     // Backreference before associated group matches zero-length character.
     check("\\1\\2(a)", R"((sequence (text ""), (text "{}"), (group (text "a"))))", '\2');
-}
\ No newline at end of file
+}
+
+TEST_CASE("nested group number") {
+    // Groups are numbered by their left parentheses, `\2` refers to `(a)`.
+    check(R"(((a)b)\2)",
+          R"((sequence (group (sequence (group (text "a")), (text "b"))), (backref 2)))");
+}
+
+TEST_CASE("non-capturing group") {
+    // `(?:...)` is not numbered, `\1` refers to `(c)`.
+    check(R"((?:ab)(c)\1)",
+          R"((sequence (sequence (text "a"), (text "b")), (group (text "c")), (backref 1)))");
+    check(R"((?:a|b)*)", R"((repeat (alter (text "a") | (text "b")) [0, 3]))");
+}
+
+TEST_CASE("backreference in its own group") {
+    check(R"((a\1))", R"((group (sequence (text "a"), (text ""))))");
+}
+
+TEST_CASE("anchor") {
+    check("^a$", R"((sequence (anchor begin), (text "a"), (anchor end)))");
+}
+
+TEST_CASE("lookaround") {
+    check("(?=a)b", R"((sequence (lookahead positive (text "a")), (text "b")))");
+    check("(?!a)b", R"((sequence (lookahead negative (text "a")), (text "b")))");
+    check("b(?<=b)", R"((sequence (text "b"), (lookbehind positive (text "b"))))");
+    check("b(?<!a)", R"((sequence (text "b"), (lookbehind negative (text "a"))))");
+    // Lookarounds are not numbered, `\1` refers to `(c)`.
+    check(R"((?=(a))(c)\1)",
+          R"((sequence (lookahead positive (group (text "a"))), (group (text "c")), (backref 1)))");
+}
+
+TEST_CASE("quantified anchor") {
+    CHECK_THROWS_AS(check("^*", ""), ParseError);
+    CHECK_THROWS_AS(check("a$+", ""), ParseError);
+}
+
+TEST_CASE("deeply nested groups") {
+    constexpr int depth = 100000;
+    std::string regex = std::string(depth, '(') + "a" + std::string(depth, ')');
+    Lexer lexer(regex);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+
+    const ASTNode *node = ast.get();
+    int group_count = 0;
+    while (auto group = dynamic_cast<const GroupNode *>(node)) {
+        node = group->content();
+        group_count++;
+    }
+    CHECK_EQ(group_count, depth);
+    CHECK(dynamic_cast<const TextNode *>(node) != nullptr);
+}
+
+TEST_CASE("wide alternation") {
+    constexpr int width = 100000;
+    std::string regex = "a";
+    for (int i = 1; i < width; i++)
+        regex.append("|a");
+    Lexer lexer(regex);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+
+    auto alternation = dynamic_cast<const AlternationNode *>(ast.get());
+    REQUIRE(alternation != nullptr);
+    CHECK_EQ(alternation->elements().size(), width);
+}
+
+TEST_CASE("repeat ceiling") {
+    Lexer lexer("a*b+c{2,}");
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens, 10);
+    auto ast = parser.parse();
+    test::ASTFormatter formatter(ast.get());
+    CHECK_EQ(formatter.format(), R"((sequence (repeat (text "a") [0, 10]), )"
+                                 R"((repeat (text "b") [1, 10]), (repeat (text "c") [2, 12])))");
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <strex/Pipeline.hpp>
+#include <strex/Sink.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+TEST_CASE("spsc ring") {
+    SpscRing<int> ring(3);
+    CHECK(ring.capacity() == 4);
+    int item = 0;
+    CHECK(!ring.pop(item));
+    for (int i = 0; i < 4; i++)
+        CHECK(ring.push(i));
+    CHECK(!ring.push(4));
+    CHECK(ring.pop(item));
+    CHECK(item == 0);
+    CHECK(ring.push(4));
+
+    // Items cross between threads in order.
+    constexpr int count = 100000;
+    std::vector<int> popped;
+    std::jthread consumer([&] {
+        int value = 0;
+        while (popped.size() < count) {
+            if (ring.pop(value))
+                popped.push_back(value);
+            else
+                std::this_thread::yield();
+        }
+    });
+    for (int i = 5; i < count + 1; i++) {
+        while (!ring.push(i))
+            std::this_thread::yield();
+    }
+    consumer.join();
+    for (int i = 0; i < count; i++)
+        REQUIRE(popped[i] == i + 1);
+}
+
+// Returns the output of block `index`, which tells its index.
+std::string block_text(std::uint64_t index) {
+    return std::to_string(index) + ",";
+}
+
+TEST_CASE("pipeline") {
+    constexpr std::uint64_t block_count = 1000;
+    for (bool ordered : {false, true}) {
+        Pipeline pipeline({.workers = 3, .blocks_per_worker = 2, .block_size = 64,
+                           .ordered = ordered});
+        std::set<const char *> buffers;
+        std::vector<std::uint64_t> indices;
+        CallbackSink sink([&](std::string_view text) {
+            indices.push_back(std::stoull(std::string{text}));
+            buffers.insert(text.data());
+        });
+        for (int run = 0; run < 2; run++) {
+            indices.clear();
+            pipeline.run(
+                [](std::size_t worker, Pipeline::Block &block) {
+                    CHECK(block.index % 3 == worker);
+                    CHECK(block.data.empty());
+                    if (block.index >= block_count)
+                        return false;
+                    block.data = block_text(block.index);
+                    return true;
+                },
+                sink);
+            REQUIRE(indices.size() == block_count);
+            if (!ordered)
+                std::ranges::sort(indices);
+            for (std::uint64_t i = 0; i < block_count; i++)
+                CHECK(indices[i] == i);
+        }
+        // Blocks are reused instead of allocated.
+        CHECK(buffers.size() <= 6);
+    }
+}
+
+TEST_CASE("pipeline with a partial last block") {
+    // Strings are split in blocks like `--jobs` does, and the last block is not full. Workers
+    // stop on blocks they do not fill, some before filling any. Run it under ThreadSanitizer
+    // with `ENABLE_THREAD_SANITIZER` to check the rings.
+    constexpr std::size_t batch_size = 64;
+    ParsedRegex regexes[] = {ParsedRegex("[a-z]{3,8}"), ParsedRegex("[a-z]{3,8}"),
+                             ParsedRegex("[a-z]{3,8}"), ParsedRegex("[a-z]{3,8}")};
+    Pipeline pipeline({.workers = 4, .blocks_per_worker = 2, .ordered = true});
+    for (std::size_t count : {std::size_t{0}, std::size_t{100}, 10 * batch_size + 37}) {
+        std::string output;
+        CallbackSink sink([&](std::string_view text) { output.append(text); });
+        pipeline.run(
+            [&](std::size_t worker, Pipeline::Block &block) {
+                std::size_t first = block.index * batch_size;
+                if (first >= count)
+                    return false;
+                from_regex(regexes[worker], std::min(batch_size, count - first), block.data);
+                return true;
+            },
+            sink);
+        CHECK(static_cast<std::size_t>(std::ranges::count(output, '\n')) == count);
+    }
+}
+
+TEST_CASE("pipeline errors") {
+    Pipeline pipeline({.workers = 2});
+    CallbackSink sink([](std::string_view) {});
+    CHECK_THROWS_AS(pipeline.run(
+                        [](std::size_t, Pipeline::Block &block) {
+                            if (block.index == 7)
+                                throw std::runtime_error("producer failed");
+                            return true;
+                        },
+                        sink),
+                    std::runtime_error);
+
+    CallbackSink failing([](std::string_view) { throw std::runtime_error("sink failed"); });
+    CHECK_THROWS_AS(pipeline.run([](std::size_t, Pipeline::Block &) { return true; }, failing),
+                    std::runtime_error);
+
+    CHECK_THROWS_AS(Pipeline({.workers = 0}), std::invalid_argument);
+}
\ No newline at end of file
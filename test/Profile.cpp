@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/Profile.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+// Returns the profiled node whose range is exactly `text` in `regex`.
+const Profile::Node &find(const Profile &profile, std::string_view regex, std::string_view text) {
+    auto start = regex.find(text);
+    REQUIRE(start != std::string_view::npos);
+    auto node = std::ranges::find_if(profile.nodes(), [&](const Profile::Node &node) {
+        return node.range.start == start && node.range.end == start + text.size();
+    });
+    REQUIRE(node != profile.nodes().end());
+    return *node;
+}
+
+TEST_CASE("profile visits and bytes") {
+    std::string_view regex = "(ab){3}c(d|e)";
+    ParsedRegex parsed(regex);
+    Profile profile(parsed);
+    for (int i = 0; i < 10; i++)
+        from_regex(parsed, profile);
+
+    CHECK_EQ(profile.nodes().front().visits, 10);
+    CHECK_EQ(profile.nodes().front().bytes, 80);
+
+    // A repetition covers its content and the quantifier.
+    const auto &repeat = find(profile, regex, "(ab){3}");
+    CHECK_EQ(repeat.visits, 10);
+    CHECK_EQ(repeat.bytes, 60);
+
+    const auto &alternation = find(profile, regex, "d|e");
+    CHECK_EQ(alternation.visits, 10);
+    CHECK_EQ(alternation.bytes, 10);
+}
+
+TEST_CASE("heat map") {
+    std::string_view regex = "a{50}b";
+    ParsedRegex parsed(regex);
+    Profile profile(parsed);
+    for (int i = 0; i < 1000; i++)
+        from_regex(parsed, profile);
+
+    std::string map = profile.heat_map(regex);
+    CHECK_EQ(map.size(), regex.size());
+    CHECK(profile.total_ns() > 0);
+}
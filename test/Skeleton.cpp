@@ -0,0 +1,94 @@
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include <strex/AST.hpp>
+#include <strex/Lexer.hpp>
+#include <strex/Matcher.hpp>
+#include <strex/Parser.hpp>
+#include <strex/Skeleton.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+std::unique_ptr<ASTNode> parse(std::string_view regex) {
+    Lexer lexer(std::string{regex});
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    return parser.parse();
+}
+
+// Checks the skeleton generates strings that match the regex, and returns the distinct strings.
+std::set<std::string> check(std::string_view regex) {
+    auto ast = parse(regex);
+    auto skeleton = Skeleton::compile(ast.get());
+    INFO("regex: ", regex);
+    REQUIRE(skeleton != nullptr);
+    Matcher matcher(ast.get());
+
+    std::set<std::string> generated;
+    for (int i = 0; i < 1000; i++) {
+        std::string str = skeleton->generate();
+        INFO("generated string: \"", str, "\"");
+        REQUIRE_EQ(str.size(), skeleton->width());
+        REQUIRE(matcher.matches(str));
+        generated.insert(str);
+    }
+    return generated;
+}
+
+TEST_CASE("not fixed") {
+    for (std::string_view regex : {"a|b", "a{1,3}", "[α-ω]", "(?=a)a", "x*", "a{70000}"}) {
+        INFO("regex: ", regex);
+        CHECK_EQ(Skeleton::compile(parse(regex).get()), nullptr);
+    }
+}
+
+TEST_CASE("template") {
+    auto ast = parse("[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}");
+    auto skeleton = Skeleton::compile(ast.get());
+    REQUIRE(skeleton != nullptr);
+    CHECK_EQ(skeleton->width(), 18);
+    CHECK_EQ(skeleton->slot_count(), 15);
+    CHECK_EQ(skeleton->skeleton().substr(8, 7), "-0000-4");
+
+    std::string str = skeleton->generate();
+    CHECK_EQ(skeleton->random_draws(), 15);
+    CHECK_EQ(str[8], '-');
+    CHECK_EQ(str[14], '4');
+}
+
+TEST_CASE("generate") {
+    CHECK_EQ(check("abc(def)").size(), 1);
+    CHECK_EQ(check("[ab]{3}").size(), 8);
+    CHECK_EQ(check("\\d:[0-5]").size(), 60);
+    CHECK_EQ(check("(x[ab]{2})-\\1").size(), 4);
+    CHECK_EQ(check("((a)[bc])\\2\\1").size(), 2);
+    check("[^a-z]{4}\\.x()");
+}
+
+TEST_CASE("fill") {
+    auto ast = parse("[0-9]{3}");
+    auto skeleton = Skeleton::compile(ast.get());
+    REQUIRE(skeleton != nullptr);
+    Matcher matcher(ast.get());
+
+    // Bytes between strings are left as they are.
+    std::string buffer(4 * 100, '\n');
+    skeleton->fill(buffer.data(), 100, 4);
+    for (std::size_t i = 0; i < 100; i++) {
+        CHECK_EQ(buffer[i * 4 + 3], '\n');
+        CHECK(matcher.matches(buffer.substr(i * 4, 3)));
+    }
+}
+
+TEST_CASE("bulk from_regex") {
+    ParsedRegex regex("[A-Z]{2}-\\d{4}");
+    auto strings = from_regex(regex, 1000);
+    CHECK_EQ(strings.size(), 1000);
+    for (const std::string &str : strings)
+        CHECK(matches(regex, str));
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <regex>
+#include <string>
+
+#include <strex/StaticRegex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+constexpr static int default_test_count = 50;
+
+template <FixedString Pattern>
+void check(int test_count = default_test_count) {
+    std::regex r(std::string{Pattern.view()});
+
+    for (int i = 0; i < test_count; i++) {
+        auto str = static_regex<Pattern>.generate();
+
+        INFO("regex: ", Pattern.view());
+        INFO("generated string: \"", str, "\"");
+        REQUIRE(std::ranges::all_of(str, ::isprint));
+        CHECK(std::regex_match(str, r));
+    }
+}
+
+TEST_CASE("static text") {
+    check<"a">();
+    check<"hello world!">();
+    check<"\\\\">();
+    check<"\\x41\\x7e">();
+}
+
+TEST_CASE("static charset") {
+    check<"[abcde]">();
+    check<"[a-z]">();
+    check<"[A-Za-z0-9_]">();
+    check<"[-a-z-]">();
+    check<"[|.'?+*]">();
+    check<"[\\d]">();
+    check<"[\\W]">();
+    check<"[^abcd]">();
+    check<"[^\\s]">();
+}
+
+TEST_CASE("static char class") {
+    check<"\\d">();
+    check<"\\D">();
+    check<"\\s">();
+    check<"\\S">();
+    check<"\\w">();
+    check<"\\W">();
+    check<".">();
+}
+
+TEST_CASE("static repeat") {
+    check<"a?">();
+    check<"a+">();
+    check<"a*">();
+    check<"a{4,8}">();
+    check<"a{4,}">();
+    check<"[abcde]{4}">();
+}
+
+TEST_CASE("static alternation and backreference") {
+    check<"a|b|c|d">();
+    check<"(a|)">();
+    check<"(ab[cd]*)ef\\1">();
+    check<R"((a?)\1(b+)\2(ccd)\3)">();
+    check<R"(((a|b)(c|d))\3\2\1)">();
+    check<R"((?:a|b)(c+)(?:d(e))\2\1)">();
+    check<"[^ab]cd(ef)\\1g+h?i*jk(\\1)">();
+}
+
+TEST_CASE("static phone number and ipv4 address") {
+    check<R"(1(3[0-9]|4[57]|5[0-35-9]|7[0678]|8[0-9])\d{8})">();
+    check<R"(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.){3}((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)))">();
+}
+
+TEST_CASE("static regex with given engine") {
+    std::mt19937 first(42);
+    std::mt19937 second(42);
+    constexpr auto &regex = static_regex<"[0-9a-f]{8}-[0-9a-f]{4}">;
+    for (int i = 0; i < default_test_count; i++)
+        CHECK_EQ(regex.generate(first), regex.generate(second));
+}
@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <string>
+
+#include <strex/Stats.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+TEST_CASE("latency histogram") {
+    stats::LatencyHistogram histogram;
+    CHECK_EQ(histogram.percentile(50), 0);
+
+    for (std::uint64_t i = 1; i <= 1000; i++)
+        histogram.record(i * 1000);
+    CHECK_EQ(histogram.count(), 1000);
+
+    // The upper bound of a bucket is at most 1 / sub_buckets larger than the value.
+    auto check_percentile = [&](double percentile, std::uint64_t expect) {
+        std::uint64_t actual = histogram.percentile(percentile);
+        INFO("percentile: ", percentile, ", actual: ", actual);
+        CHECK(actual >= expect);
+        CHECK(actual <= expect + expect / stats::LatencyHistogram::sub_buckets);
+    };
+    check_percentile(50, 500'000);
+    check_percentile(99, 990'000);
+    check_percentile(100, 1'000'000);
+
+    stats::LatencyHistogram other;
+    other.record(0);
+    other.record(3);
+    histogram.merge(other);
+    CHECK_EQ(histogram.count(), 1002);
+    CHECK_EQ(histogram.percentile(0), 0);
+}
+
+TEST_CASE("counters") {
+    stats::enable();
+    ParsedRegex regex("[a-z]{4}");
+    for (int i = 0; i < 10; i++)
+        from_regex(regex);
+    stats::flush();
+    stats::enable(false);
+
+    auto counters = stats::collect();
+    CHECK_EQ(counters.strings, 10);
+    CHECK_EQ(counters.bytes_emitted, 40);
+    CHECK_EQ(counters.latency.count(), 10);
+    CHECK(counters.random_draws >= 40);
+
+    // counters of current thread are reset after flush
+    CHECK_EQ(stats::local().strings, 0);
+}
@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include <strex/Charset.hpp>
+#include <strex/Exception.hpp>
+#include <strex/Unicode.hpp>
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+using namespace strex;
+
+// Decodes all code points of UTF-8 `text`.
+std::u32string decode(std::string_view text) {
+    std::u32string code_points;
+    std::size_t position = 0;
+    while (position < text.size())
+        code_points.push_back(unicode::decode_utf8(text, position));
+    return code_points;
+}
+
+// Checks generated strings are valid UTF-8, and match the regex.
+void check(std::string_view regex, std::u32string_view expect_code_points) {
+    ParsedRegex parsed(regex);
+    INFO("regex: ", regex);
+    std::set<char32_t> seen;
+    for (int i = 0; i < 1000; i++) {
+        std::string str = from_regex(parsed);
+        INFO("generated string: \"", str, "\"");
+        REQUIRE(matches(parsed, str));
+        for (char32_t code_point : decode(str)) {
+            REQUIRE(code_point != unicode::invalid_code_point);
+            seen.insert(code_point);
+        }
+    }
+    for (char32_t code_point : expect_code_points)
+        CHECK(seen.contains(code_point));
+}
+
+TEST_CASE("UTF-8 round trip") {
+    for (std::uint32_t code_point : {0x0U, 0x7FU, 0x80U, 0x7FFU, 0x800U, 0xD7FFU, 0xE000U, 0xFFFFU,
+                                     0x10000U, 0x10FFFFU}) {
+        std::string text;
+        unicode::append_utf8(text, code_point);
+        std::size_t position = 0;
+        CHECK_EQ(static_cast<std::uint32_t>(unicode::decode_utf8(text, position)), code_point);
+        CHECK_EQ(position, text.size());
+    }
+
+    // overlong, surrogate, truncated and stray continuation
+    for (std::string_view text : {"\xC0\x80", "\xED\xA0\x80", "\xE4\xBD", "\x80"}) {
+        std::size_t position = 0;
+        CHECK_EQ(static_cast<std::uint32_t>(unicode::decode_utf8(text, position)), 0xFFFFFFFF);
+        CHECK_EQ(position, 0);
+    }
+}
+
+TEST_CASE("charset intervals") {
+    // [a-cé-ü]
+    const Charset *charset =
+        Charset::get({{0xE9, 0xFC}, {'a', 'c'}}, {{0, unicode::max_code_point}});
+    CHECK_EQ(charset->size(), 3 + (0xFC - 0xE9 + 1));
+    CHECK_EQ(static_cast<std::uint32_t>(charset->at(0)), 'a');
+    CHECK_EQ(static_cast<std::uint32_t>(charset->at(2)), 'c');
+    CHECK_EQ(static_cast<std::uint32_t>(charset->at(3)), 0xE9);
+    CHECK_EQ(static_cast<std::uint32_t>(charset->at(charset->size() - 1)), 0xFC);
+
+    // Unassigned code points and controls are never generated.
+    const Charset *others = Charset::get({{0x80, 0xA0}, {0x378, 0x379}}, {{0x80, 0x379}});
+    CHECK_EQ(others->size(), 1);
+    CHECK_EQ(static_cast<std::uint32_t>(others->at(0)), 0xA0);
+}
+
+TEST_CASE("generate non-ascii") {
+    check("你好", U"你好");
+    check(R"(\u{1F600}\xe9)", U"😀é");
+    check("[é-ü]{3}", U"éü");
+    check("[a-cα-γ😀]", U"aβ😀");
+}
+
+TEST_CASE("generate unicode property") {
+    check(R"(\p{Lu}{5})", U"");
+    check(R"([\p{Nd}\p{Sc}]{5}\p{gc=Zs})", U"");
+
+    // Negated sets match any code point, but generate printable ASCII characters.
+    check(R"(\P{L}[^a]\W.)", U" ~");
+    CHECK(matches(ParsedRegex(R"(\P{L}[^a])"), "€😀"));
+    CHECK_FALSE(matches(ParsedRegex(R"(\P{L})"), "é"));
+
+    CHECK_THROWS_AS(ParsedRegex(R"(\p{Greek})"), LexicalError);
+}
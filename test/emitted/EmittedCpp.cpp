@@ -0,0 +1,31 @@
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include <strex/strex.hpp>
+
+#include <doctest/doctest.h>
+
+// Both are written by the build: the header that `strex --emit-cpp emitted` prints for
+// `emitted_regex`, and `emitted_regex` itself.
+#include "emitted.hpp"
+#include "emitted_regex.hpp"
+
+TEST_CASE("emitted header") {
+    strex::ParsedRegex regex(emitted_regex);
+    std::set<std::string> strings;
+    for (std::uint64_t seed = 0; seed < 1000; seed++) {
+        strex_generated::Engine engine(seed);
+        std::string generated = strex_generated::emitted(engine);
+        CHECK(strex::matches(regex, generated));
+        strings.insert(generated);
+    }
+    CHECK(strings.size() > 900);
+
+    // Strings are appended after what is there.
+    strex_generated::Engine engine(1);
+    std::string out = "kept";
+    strex_generated::emitted(out, engine);
+    CHECK(out.starts_with("kept"));
+    CHECK(strex::matches(regex, out.substr(4)));
+}
\ No newline at end of file
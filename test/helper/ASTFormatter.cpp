@@ -1,9 +1,11 @@
+#include <cstdint>
 #include <format>
 #include <ranges>
 #include <string>
 
 #include "ASTFormatter.hpp"
 #include <strex/AST.hpp>
+#include <strex/Charset.hpp>
 
 strex::test::ASTFormatter::ASTFormatter(const ASTNode *ast) : ast_(ast) {}
 
@@ -23,8 +25,19 @@ void strex::test::ASTFormatter::visit(const TextNode *node) {
 
 void strex::test::ASTFormatter::visit(const CharsetNode *node) {
     auto charset = node->charset();
-    formatted_.append(std::format(
-        "(charset {} {})", charset->is_inclusive() ? "include" : "exclude", charset->alphabet()));
+    // ASCII characters are listed one by one, others as `\u{...}` or ranges of them.
+    std::string characters;
+    for (auto [first, last] : charset->ranges()) {
+        for (; first <= last && first < 0x80; first++)
+            characters.push_back(static_cast<char>(first));
+        if (first > last)
+            continue;
+        characters.append(std::format("\\u{{{:x}}}", static_cast<std::uint32_t>(first)));
+        if (first != last)
+            characters.append(std::format("-\\u{{{:x}}}", static_cast<std::uint32_t>(last)));
+    }
+    formatted_.append(std::format("(charset {} {})",
+                                  charset->is_inclusive() ? "include" : "exclude", characters));
 }
 
 void strex::test::ASTFormatter::visit(const SequenceNode *node) {
@@ -62,4 +75,15 @@ void strex::test::ASTFormatter::visit(const AlternationNode *node) {
 
 void strex::test::ASTFormatter::visit(const BackrefNode *node) {
     formatted_.append(std::format("(backref {})", node->group()->index()));
+}
+
+void strex::test::ASTFormatter::visit(const AnchorNode *node) {
+    formatted_.append(node->type() == AnchorNode::Type::Begin ? "(anchor begin)" : "(anchor end)");
+}
+
+void strex::test::ASTFormatter::visit(const LookaroundNode *node) {
+    formatted_.append(std::format("({} {} ", node->is_lookbehind() ? "lookbehind" : "lookahead",
+                                  node->is_negative() ? "negative" : "positive"));
+    format(node->content());
+    formatted_.push_back(')');
 }
\ No newline at end of file
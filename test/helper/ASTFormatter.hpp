@@ -30,6 +30,10 @@ class ASTFormatter : public ASTVisitor {
 
     void visit(const BackrefNode *node) override;
 
+    void visit(const AnchorNode *node) override;
+
+    void visit(const LookaroundNode *node) override;
+
     const ASTNode *ast_;
     std::string formatted_;
 };
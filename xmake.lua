@@ -10,6 +10,9 @@ add_rules("mode.debug", "mode.release")
 
 option("dev", { default = false })
 option("enable_tests", { default = true })
+option("enable_benchmarks", { default = false })
+option("allocation_stats", { default = false })
+option("thread_sanitizer", { default = false })
 
 if has_config("dev") then
     if is_mode("debug") and is_plat("linux") then
@@ -19,6 +22,11 @@ if has_config("dev") then
     end
 end
 
+-- check the threads of `Pipeline` and file output for data races
+if has_config("thread_sanitizer") and is_plat("linux") then
+    set_policy("build.sanitizer.thread", true)
+end
+
 set_languages("c++23")
 set_warnings("allextra", "error")
 
@@ -35,22 +43,31 @@ if is_plat("windows") then
     add_options("link-stdc++exp")
 end
 
+-- generation into files runs on threads
+if is_plat("linux") then
+    add_syslinks("pthread")
+end
+
 target("strex")
     set_kind("binary")
-    add_files("src/*.cpp")
+    add_files("src/*.cpp|AllocationHook.cpp")
     add_includedirs("include")
     add_packages("argparse")
+    if has_config("allocation_stats") then
+        add_files("src/AllocationHook.cpp")
+        add_defines("STREX_COUNT_ALLOCATIONS")
+    end
 
 target("static")
     set_kind("static")
-    add_files("src/*.cpp|main.cpp|compile_option.cpp")
+    add_files("src/*.cpp|main.cpp|compile_option.cpp|AllocationHook.cpp")
     add_includedirs("include")
     add_headerfiles("include/(strex/*.hpp)")
     set_basename("strex")
 
 target("shared")
     set_kind("shared")
-    add_files("src/*.cpp|main.cpp|compile_option.cpp")
+    add_files("src/*.cpp|main.cpp|compile_option.cpp|AllocationHook.cpp")
     add_includedirs("include")
     add_headerfiles("include/(strex/*.hpp)")
     set_basename("strex")
@@ -59,7 +76,7 @@ if has_config("enable_tests") then
     target("test")
         set_kind("binary")
         set_default(false)
-        add_files("src/*.cpp|main.cpp|compile_option.cpp")
+        add_files("src/*.cpp|main.cpp|compile_option.cpp|AllocationHook.cpp")
         add_includedirs("include")
         for _, file in ipairs(os.files("test/*.cpp")) do
             add_tests(path.basename(file), {
@@ -68,4 +85,37 @@ if has_config("enable_tests") then
                 defines = "DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN"
             })
         end
+end
+
+if has_config("enable_benchmarks") then
+    target("bench_scaling")
+        set_kind("binary")
+        set_default(false)
+        add_files("bench/scaling.cpp")
+        add_includedirs("include")
+        add_deps("static")
+
+    target("bench")
+        set_kind("binary")
+        set_default(false)
+        set_basename("strex_bench")
+        add_files("bench/strex_bench.cpp")
+        add_includedirs("include")
+        add_deps("static")
+
+    target("bench_secure")
+        set_kind("binary")
+        set_default(false)
+        set_basename("strex_bench_secure")
+        add_files("bench/secure.cpp")
+        add_includedirs("include")
+        add_deps("static")
+
+    target("bench_pipe")
+        set_kind("binary")
+        set_default(false)
+        set_basename("strex_bench_pipe")
+        add_files("bench/pipe.cpp")
+        add_includedirs("include")
+        add_deps("static")
 end
\ No newline at end of file